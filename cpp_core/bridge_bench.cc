@@ -0,0 +1,436 @@
+// bridge_bench.cc
+// Throughput and latency benchmarks for the MediaPipe bridge
+//
+// Replays recorded frames through MP_ProcessInto for every combination of
+// resolution, model complexity, output configuration and model precision,
+// and reports fps, latency percentiles, peak RSS and heap allocations per
+// frame. Below float precision it also reports the mean landmark distance
+// from the float models over one pass of the frames (face_error,
+// pose_error, in normalized image units) and how many models had a
+// variant to load (variant_models; 0 means the run used float models).
+//
+// Usage:
+//   bazel run -c opt :bridge_bench -- [--frames_dir=DIR | --video=FILE]
+//       [--max_frames=N] --benchmark_format=json --benchmark_out=bench.json
+//
+// Without --frames_dir or --video, a synthetic gradient is used, which
+// exercises the graph but rarely finds a face. All Google Benchmark flags
+// (--benchmark_filter, --benchmark_repetitions, ...) are supported.
+
+#include "mediapipe_bridge.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "benchmark/benchmark.h"
+
+// ============================================================================
+// Allocation counting
+// ============================================================================
+
+// Every operator new in the process, including MediaPipe's graph threads.
+// Allocations made with malloc directly (e.g. inside TFLite) are not seen.
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+namespace {
+
+// ============================================================================
+// Input frames
+// ============================================================================
+
+struct Options {
+    std::string frames_dir;
+    std::string video;
+    int max_frames = 300;
+};
+
+struct Resolution {
+    int width;
+    int height;
+};
+
+const Resolution kResolutions[] = {
+    {640, 480},
+    {1280, 720},
+    {1920, 1080},
+};
+
+struct OutputConfig {
+    const char* name;
+    uint32_t outputs;
+};
+
+const OutputConfig kOutputConfigs[] = {
+    {"face", MP_OUTPUT_FACE},
+    {"holistic", MP_OUTPUT_ALL},
+};
+
+struct PrecisionConfig {
+    const char* name;
+    MPModelPrecision precision;
+};
+
+const PrecisionConfig kPrecisionConfigs[] = {
+    {"float", MP_PRECISION_FLOAT},
+    {"fp16", MP_PRECISION_FP16},
+    {"int8", MP_PRECISION_INT8},
+};
+
+// Source frames in RGB at their recorded size
+std::vector<cv::Mat> g_source_frames;
+
+// Strip our flags from argv so Google Benchmark only sees its own
+Options ParseOptions(int* argc, char** argv) {
+    Options options;
+    int kept = 1;
+    for (int i = 1; i < *argc; ++i) {
+        const std::string arg = argv[i];
+        auto value_of = [&arg](const char* flag) -> const char* {
+            const size_t length = strlen(flag);
+            return arg.compare(0, length, flag) == 0 ? arg.c_str() + length : nullptr;
+        };
+        if (const char* value = value_of("--frames_dir=")) {
+            options.frames_dir = value;
+        } else if (const char* value = value_of("--video=")) {
+            options.video = value;
+        } else if (const char* value = value_of("--max_frames=")) {
+            options.max_frames = std::max(1, atoi(value));
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+    return options;
+}
+
+void AddFrame(const cv::Mat& bgr) {
+    cv::Mat rgb;
+    cv::cvtColor(bgr, rgb, cv::COLOR_BGR2RGB);
+    g_source_frames.push_back(rgb);
+}
+
+// Decode every input frame up front so decoding stays out of the timing
+bool LoadFrames(const Options& options) {
+    if (!options.frames_dir.empty()) {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(options.frames_dir)) {
+            if (entry.is_regular_file()) {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        for (const auto& path : paths) {
+            if (static_cast<int>(g_source_frames.size()) >= options.max_frames) {
+                break;
+            }
+            cv::Mat frame = cv::imread(path.string(), cv::IMREAD_COLOR);
+            if (!frame.empty()) {
+                AddFrame(frame);
+            }
+        }
+    } else if (!options.video.empty()) {
+        cv::VideoCapture capture(options.video);
+        cv::Mat frame;
+        while (static_cast<int>(g_source_frames.size()) < options.max_frames &&
+               capture.read(frame)) {
+            AddFrame(frame);
+        }
+    } else {
+        cv::Mat frame(480, 640, CV_8UC3);
+        for (int y = 0; y < frame.rows; ++y) {
+            for (int x = 0; x < frame.cols; ++x) {
+                frame.at<cv::Vec3b>(y, x) = cv::Vec3b(
+                    static_cast<uint8_t>((x * 255) / frame.cols),
+                    static_cast<uint8_t>((y * 255) / frame.rows),
+                    128);
+            }
+        }
+        g_source_frames.push_back(frame);
+    }
+    return !g_source_frames.empty();
+}
+
+// Source frames scaled to one benchmark resolution
+std::vector<cv::Mat> ScaledFrames(const Resolution& resolution) {
+    std::vector<cv::Mat> frames;
+    frames.reserve(g_source_frames.size());
+    for (const auto& source : g_source_frames) {
+        cv::Mat scaled;
+        cv::resize(source, scaled, cv::Size(resolution.width, resolution.height));
+        frames.push_back(scaled);
+    }
+    return frames;
+}
+
+double PeakRssMb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;  // ru_maxrss is in KiB on Linux
+}
+
+double Percentile(std::vector<double>* sorted, double quantile) {
+    if (sorted->empty()) {
+        return 0.0;
+    }
+    return (*sorted)[static_cast<size_t>(quantile * (sorted->size() - 1))];
+}
+
+// ============================================================================
+// Accuracy
+// ============================================================================
+
+// Landmarks of one pass over the frames; empty where nothing was detected
+struct PassLandmarks {
+    std::vector<std::vector<MPLandmark>> face;
+    std::vector<std::vector<MPLandmark>> pose;
+};
+
+bool RunPass(MPHandle handle, const std::vector<cv::Mat>& frames,
+             MPResultsBuffer* buffer, PassLandmarks* pass) {
+    for (const cv::Mat& frame : frames) {
+        if (!MP_ProcessInto(handle, frame.data, frame.cols, frame.rows, buffer, nullptr)) {
+            return false;
+        }
+        const MPResults& results = buffer->results;
+        pass->face.emplace_back(results.face_landmarks,
+                                results.face_landmarks + results.face_count);
+        pass->pose.emplace_back(results.pose_landmarks,
+                                results.pose_landmarks + results.pose_count);
+    }
+    return true;
+}
+
+// Mean 2D distance between matching landmarks, over the frames where both
+// passes found the part; -1 if there are none
+double MeanError(const std::vector<std::vector<MPLandmark>>& reference,
+                 const std::vector<std::vector<MPLandmark>>& test) {
+    double total = 0.0;
+    size_t count = 0;
+    for (size_t frame = 0; frame < reference.size() && frame < test.size(); ++frame) {
+        if (reference[frame].empty() || reference[frame].size() != test[frame].size()) {
+            continue;
+        }
+        for (size_t i = 0; i < reference[frame].size(); ++i) {
+            total += std::hypot(test[frame][i].x - reference[frame][i].x,
+                                test[frame][i].y - reference[frame][i].y);
+        }
+        count += reference[frame].size();
+    }
+    return count > 0 ? total / count : -1.0;
+}
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+constexpr int kWarmupFrames = 10;
+
+MPConfig BenchConfig(int complexity, const OutputConfig& output, MPModelPrecision precision) {
+    MPConfig config = {};
+    config.model_complexity = complexity;
+    config.min_detection_confidence = 0.5f;
+    config.min_tracking_confidence = 0.5f;
+    config.smooth_landmarks = true;
+    config.refine_face_landmarks = true;
+    config.enabled_outputs = output.outputs;
+    config.precision = precision;
+    return config;
+}
+
+// Float-model landmarks for one resolution / complexity / output set,
+// computed on first use. Null if the pass fails.
+const PassLandmarks* FloatReference(const Resolution& resolution, int complexity,
+                                    const OutputConfig& output,
+                                    const std::vector<cv::Mat>& frames) {
+    static std::map<std::string, PassLandmarks> references;
+    const std::string key = std::string(output.name) + "/" + std::to_string(complexity) + "/" +
+        std::to_string(resolution.width) + "x" + std::to_string(resolution.height);
+    auto it = references.find(key);
+    if (it != references.end()) {
+        return &it->second;
+    }
+
+    const MPConfig config = BenchConfig(complexity, output, MP_PRECISION_FLOAT);
+    MPHandle handle = MP_Create(&config);
+    if (!handle) {
+        return nullptr;
+    }
+    MPResultsBuffer* buffer = MP_CreateResultsBuffer();
+    PassLandmarks pass;
+    const bool ok = RunPass(handle, frames, buffer, &pass);
+    MP_DestroyResultsBuffer(buffer);
+    MP_Destroy(handle);
+    return ok ? &references.emplace(key, std::move(pass)).first->second : nullptr;
+}
+
+void BM_Process(benchmark::State& state, Resolution resolution, int complexity,
+                OutputConfig output, PrecisionConfig precision) {
+    const MPConfig config = BenchConfig(complexity, output, precision.precision);
+
+    MPHandle handle = MP_Create(&config);
+    if (!handle) {
+        state.SkipWithError(MP_GetLastError(nullptr).message);
+        return;
+    }
+    MPResultsBuffer* buffer = MP_CreateResultsBuffer();
+    const std::vector<cv::Mat> frames = ScaledFrames(resolution);
+
+    // Accuracy against the float models, from a fresh handle so both
+    // passes track the same sequence
+    double face_error = -1.0;
+    double pose_error = -1.0;
+    if (precision.precision != MP_PRECISION_FLOAT) {
+        const PassLandmarks* reference = FloatReference(resolution, complexity, output, frames);
+        PassLandmarks pass;
+        if (reference && RunPass(handle, frames, buffer, &pass)) {
+            face_error = MeanError(reference->face, pass.face);
+            pose_error = MeanError(reference->pose, pass.pose);
+        }
+    }
+
+    size_t next = 0;
+    MPError error;
+    auto process_next = [&]() {
+        const cv::Mat& frame = frames[next++ % frames.size()];
+        return MP_ProcessInto(handle, frame.data, frame.cols, frame.rows, buffer, &error);
+    };
+
+    for (int i = 0; i < kWarmupFrames; ++i) {
+        process_next();
+    }
+
+    std::vector<double> latencies_ms;
+    latencies_ms.reserve(4096);
+    int64_t faces = 0;
+    const uint64_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        if (!process_next()) {
+            state.SkipWithError(error.message);
+            break;
+        }
+        latencies_ms.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count());
+        faces += buffer->results.face_detected ? 1 : 0;
+    }
+
+    const uint64_t allocations =
+        g_allocations.load(std::memory_order_relaxed) - allocations_before;
+    const double iterations = std::max<double>(1.0, static_cast<double>(latencies_ms.size()));
+    std::sort(latencies_ms.begin(), latencies_ms.end());
+
+    // Frames are processed one at a time, so wall time is the latency sum.
+    // Rate counters would divide by the benchmark thread's CPU time, which
+    // excludes the graph threads doing the work.
+    double total_ms = 0.0;
+    for (double latency : latencies_ms) {
+        total_ms += latency;
+    }
+    state.counters["fps"] = total_ms > 0.0 ? latencies_ms.size() * 1000.0 / total_ms : 0.0;
+    state.counters["p50_ms"] = Percentile(&latencies_ms, 0.50);
+    state.counters["p95_ms"] = Percentile(&latencies_ms, 0.95);
+    state.counters["p99_ms"] = Percentile(&latencies_ms, 0.99);
+    state.counters["peak_rss_mb"] = PeakRssMb();
+    state.counters["allocs_per_frame"] = allocations / iterations;
+    state.counters["face_rate"] = faces / iterations;
+    if (face_error >= 0.0) {
+        state.counters["face_error"] = face_error;
+    }
+    if (pose_error >= 0.0) {
+        state.counters["pose_error"] = pose_error;
+    }
+    MPStats stats;
+    if (MP_GetStats(handle, &stats)) {
+        state.counters["variant_models"] = stats.variant_models;
+    }
+
+    MP_DestroyResultsBuffer(buffer);
+    MP_Destroy(handle);
+}
+
+void RegisterBenchmarks() {
+    for (const auto& output : kOutputConfigs) {
+        for (int complexity = 0; complexity <= 2; ++complexity) {
+            for (const auto& resolution : kResolutions) {
+                for (const auto& precision : kPrecisionConfigs) {
+                    const std::string name = std::string("MP_Process/") + output.name +
+                        "/complexity:" + std::to_string(complexity) + "/" +
+                        std::to_string(resolution.width) + "x" +
+                        std::to_string(resolution.height) + "/precision:" + precision.name;
+                    benchmark::RegisterBenchmark(name.c_str(), BM_Process,
+                                                 resolution, complexity, output, precision)
+                        ->Unit(benchmark::kMillisecond)
+                        ->UseRealTime();
+                }
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    const Options options = ParseOptions(&argc, argv);
+    if (!LoadFrames(options)) {
+        fprintf(stderr, "No frames could be loaded\n");
+        return 1;
+    }
+    fprintf(stderr, "Loaded %zu frame(s); bridge %s\n",
+            g_source_frames.size(), MP_GetVersion());
+
+    RegisterBenchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -28,7 +28,7 @@ int main() {
     std::cout << "Initializing processor...\n";
     MPHandle handle = MP_Create(&config);
     if (!handle) {
-        MPError error = MP_GetLastError(handle);
+        MPError error = MP_GetLastError(nullptr);
         std::cerr << "Failed to create processor: " << error.message << "\n";
         return 1;
     }
@@ -52,10 +52,10 @@ int main() {
     // Process the frame
     std::cout << "Processing test frame (" << width << "x" << height << ")...\n";
     MPResults results;
-    bool success = MP_Process(handle, dummy_frame.data(), width, height, &results);
+    MPError error;
+    bool success = MP_Process(handle, dummy_frame.data(), width, height, &results, &error);
 
     if (!success) {
-        MPError error = MP_GetLastError(handle);
         std::cerr << "Processing failed: " << error.message << "\n";
         MP_Destroy(handle);
         return 1;
@@ -0,0 +1,99 @@
+// complexity_governor.cc
+// Latency-driven choice of model complexity and face refinement
+
+#include "complexity_governor.h"
+
+#include <algorithm>
+
+namespace {
+
+// Frames per decision
+constexpr size_t kWindow = 30;
+
+// A tier has headroom when its p90 stays under this fraction of the target;
+// one step up roughly doubles the cost of the pose model
+constexpr float kHeadroom = 0.6f;
+
+// Windows with headroom before stepping up, doubled per undone step up
+constexpr int kUpWindows = 4;
+constexpr int kMaxUpBackoff = 5;
+
+} // anonymous namespace
+
+std::vector<ComplexityTier> BuildComplexityTiers(const MPConfig& config) {
+    const int max_complexity = std::clamp(config.model_complexity, 0, 2);
+    const MPAdaptiveComplexity& adaptive = config.adaptive_complexity;
+    if (adaptive.target_latency_ms <= 0.0f) {
+        return {{max_complexity, config.refine_face_landmarks}};
+    }
+
+    const int min_complexity = std::clamp(adaptive.min_model_complexity, 0, max_complexity);
+    const bool toggle_refinement = config.refine_face_landmarks && !adaptive.keep_refinement;
+    std::vector<ComplexityTier> tiers;
+    for (int complexity = min_complexity; complexity <= max_complexity; ++complexity) {
+        if (toggle_refinement) {
+            tiers.push_back({complexity, false});
+        }
+        tiers.push_back({complexity, config.refine_face_landmarks});
+    }
+    return tiers;
+}
+
+ComplexityGovernor::ComplexityGovernor(const MPAdaptiveComplexity& config, int tier_count)
+    : target_ms_(config.target_latency_ms),
+      tier_count_(tier_count),
+      tier_(tier_count - 1),
+      up_failures_(tier_count, 0) {
+    window_.reserve(kWindow);
+}
+
+int ComplexityGovernor::Record(int tier, float latency_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Frames still in flight from before the last switch say nothing about
+    // the current tier. If they keep coming the switch never happened (its
+    // graph failed to start), which counts as an undone step up.
+    if (tier != tier_) {
+        if (++stale_frames_ < static_cast<int>(kWindow)) {
+            return tier_;
+        }
+        if (tier < tier_) {
+            up_failures_[tier_] = std::min(up_failures_[tier_] + 1, kMaxUpBackoff);
+        }
+        tier_ = tier;
+        window_.clear();
+        headroom_windows_ = 0;
+        probing_ = false;
+    }
+    stale_frames_ = 0;
+    window_.push_back(latency_ms);
+    if (window_.size() < kWindow) {
+        return tier_;
+    }
+
+    auto p90 = window_.begin() + (kWindow * 9) / 10;
+    std::nth_element(window_.begin(), p90, window_.end());
+    const float latency_p90 = *p90;
+    window_.clear();
+
+    if (latency_p90 > target_ms_ && tier_ > 0) {
+        if (probing_) {
+            up_failures_[tier_] = std::min(up_failures_[tier_] + 1, kMaxUpBackoff);
+        }
+        --tier_;
+        headroom_windows_ = 0;
+        probing_ = false;
+        return tier_;
+    }
+    probing_ = false;
+
+    if (latency_p90 < kHeadroom * target_ms_ && tier_ + 1 < tier_count_) {
+        if (++headroom_windows_ >= (kUpWindows << up_failures_[tier_ + 1])) {
+            ++tier_;
+            headroom_windows_ = 0;
+            probing_ = true;
+        }
+    } else {
+        headroom_windows_ = 0;
+    }
+    return tier_;
+}
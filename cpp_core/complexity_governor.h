@@ -0,0 +1,48 @@
+// complexity_governor.h
+// Latency-driven choice of model complexity and face refinement
+
+#ifndef COMPLEXITY_GOVERNOR_H
+#define COMPLEXITY_GOVERNOR_H
+
+#include <mutex>
+#include <vector>
+
+#include "mediapipe_bridge.h"
+
+// One pipeline the governor can run
+struct ComplexityTier {
+    int model_complexity;
+    bool refine_face_landmarks;
+};
+
+// Tiers for `config`, cheapest first; the last one is MPConfig's own
+// model_complexity / refine_face_landmarks. Without a latency target that
+// is the only tier.
+std::vector<ComplexityTier> BuildComplexityTiers(const MPConfig& config);
+
+// Picks the tier from the latency of the frames it produced. A rolling
+// p90 over the deadline steps down at once; stepping up needs a run of
+// windows with headroom, and after a step up that had to be undone the
+// run to retry it doubles. Thread-safe.
+class ComplexityGovernor {
+public:
+    ComplexityGovernor(const MPAdaptiveComplexity& config, int tier_count);
+
+    // Record the latency of a frame processed at `tier`. Returns the tier
+    // new frames should be sent to.
+    int Record(int tier, float latency_ms);
+
+private:
+    const float target_ms_;
+    const int tier_count_;
+
+    std::mutex mutex_;
+    int tier_;                     // current decision
+    std::vector<float> window_;    // latencies at `tier_` since the last decision
+    int headroom_windows_ = 0;     // consecutive windows with headroom
+    std::vector<int> up_failures_; // per tier: step ups into it that were undone
+    bool probing_ = false;         // first window after a step up
+    int stale_frames_ = 0;         // consecutive frames from another tier
+};
+
+#endif // COMPLEXITY_GOVERNOR_H
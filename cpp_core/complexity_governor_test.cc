@@ -0,0 +1,158 @@
+// complexity_governor_test.cc
+// Tests for ComplexityGovernor and BuildComplexityTiers
+
+#include "complexity_governor.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr int kWindow = 30;        // frames per decision
+constexpr float kTargetMs = 16.0f;
+constexpr float kSlowMs = 20.0f;   // over the target
+constexpr float kFastMs = 5.0f;    // under the headroom threshold
+constexpr float kSteadyMs = 12.0f; // between the two
+
+MPAdaptiveComplexity Adaptive() {
+    MPAdaptiveComplexity config = {};
+    config.target_latency_ms = kTargetMs;
+    return config;
+}
+
+// Record a full window of frames from `tier`, returning the last decision
+int RunWindow(ComplexityGovernor* governor, int tier, float latency_ms) {
+    int decision = -1;
+    for (int i = 0; i < kWindow; ++i) {
+        decision = governor->Record(tier, latency_ms);
+    }
+    return decision;
+}
+
+// Windows of headroom at `tier` until the governor steps up, or `limit`
+int WindowsToStepUp(ComplexityGovernor* governor, int tier, int limit) {
+    for (int windows = 1; windows <= limit; ++windows) {
+        if (RunWindow(governor, tier, kFastMs) != tier) {
+            return windows;
+        }
+    }
+    return -1;
+}
+
+TEST(ComplexityGovernorTest, FixedPipelineHasOneTier) {
+    MPConfig config = {};
+    config.model_complexity = 2;
+    config.refine_face_landmarks = true;
+    const auto tiers = BuildComplexityTiers(config);
+    ASSERT_EQ(tiers.size(), 1u);
+    EXPECT_EQ(tiers[0].model_complexity, 2);
+    EXPECT_TRUE(tiers[0].refine_face_landmarks);
+}
+
+TEST(ComplexityGovernorTest, TiersRunCheapestFirst) {
+    MPConfig config = {};
+    config.model_complexity = 2;
+    config.refine_face_landmarks = true;
+    config.adaptive_complexity = Adaptive();
+    config.adaptive_complexity.min_model_complexity = 1;
+    const auto tiers = BuildComplexityTiers(config);
+    ASSERT_EQ(tiers.size(), 4u);
+    EXPECT_EQ(tiers[0].model_complexity, 1);
+    EXPECT_FALSE(tiers[0].refine_face_landmarks);
+    EXPECT_EQ(tiers[1].model_complexity, 1);
+    EXPECT_TRUE(tiers[1].refine_face_landmarks);
+    EXPECT_EQ(tiers[3].model_complexity, 2);
+    EXPECT_TRUE(tiers[3].refine_face_landmarks);
+
+    config.adaptive_complexity.keep_refinement = true;
+    EXPECT_EQ(BuildComplexityTiers(config).size(), 2u);
+}
+
+TEST(ComplexityGovernorTest, StepsDownOnSlowWindow) {
+    ComplexityGovernor governor(Adaptive(), 3);
+    EXPECT_EQ(RunWindow(&governor, 2, kSteadyMs), 2);
+    EXPECT_EQ(RunWindow(&governor, 2, kSlowMs), 1);
+    EXPECT_EQ(RunWindow(&governor, 1, kSlowMs), 0);
+    // Nothing cheaper to fall back to
+    EXPECT_EQ(RunWindow(&governor, 0, kSlowMs), 0);
+}
+
+// A window is judged by its p90, so a few slow frames are tolerated
+TEST(ComplexityGovernorTest, IgnoresOccasionalSpikes) {
+    ComplexityGovernor governor(Adaptive(), 2);
+    int decision = -1;
+    for (int i = 0; i < kWindow; ++i) {
+        decision = governor.Record(1, i < 2 ? 2.0f * kSlowMs : kSteadyMs);
+    }
+    EXPECT_EQ(decision, 1);
+}
+
+// Frames still in flight from the tier just left do not count against the
+// new one
+TEST(ComplexityGovernorTest, IgnoresFramesFromPreviousTier) {
+    ComplexityGovernor governor(Adaptive(), 3);
+    ASSERT_EQ(RunWindow(&governor, 2, kSlowMs), 1);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(governor.Record(2, kSlowMs), 1);
+    }
+    EXPECT_EQ(RunWindow(&governor, 1, kSteadyMs), 1);
+}
+
+TEST(ComplexityGovernorTest, StepsUpAfterSustainedHeadroom) {
+    ComplexityGovernor governor(Adaptive(), 3);
+    ASSERT_EQ(RunWindow(&governor, 2, kSlowMs), 1);
+    EXPECT_EQ(WindowsToStepUp(&governor, 1, 16), 4);
+
+    // A window without headroom restarts the run
+    ASSERT_EQ(RunWindow(&governor, 2, kSteadyMs), 2);
+    ASSERT_EQ(RunWindow(&governor, 2, kSlowMs), 1);
+    RunWindow(&governor, 1, kFastMs);
+    RunWindow(&governor, 1, kFastMs);
+    RunWindow(&governor, 1, kSteadyMs);
+    EXPECT_EQ(WindowsToStepUp(&governor, 1, 16), 4);
+}
+
+// Each step up undone by its first window doubles the run needed to retry
+TEST(ComplexityGovernorTest, BacksOffFailedStepUps) {
+    ComplexityGovernor governor(Adaptive(), 2);
+    ASSERT_EQ(RunWindow(&governor, 1, kSlowMs), 0);
+
+    int expected = 4;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        ASSERT_EQ(WindowsToStepUp(&governor, 0, 64), expected) << "attempt " << attempt;
+        ASSERT_EQ(RunWindow(&governor, 1, kSlowMs), 0);
+        expected *= 2;
+    }
+
+    // Backoff stops growing at 4 << 5 windows
+    ComplexityGovernor capped(Adaptive(), 2);
+    ASSERT_EQ(RunWindow(&capped, 1, kSlowMs), 0);
+    for (int attempt = 0; attempt < 6; ++attempt) {
+        ASSERT_NE(WindowsToStepUp(&capped, 0, 4 << 5), -1);
+        ASSERT_EQ(RunWindow(&capped, 1, kSlowMs), 0);
+    }
+    EXPECT_EQ(WindowsToStepUp(&capped, 0, 4 << 5), 4 << 5);
+}
+
+// Slowing down later, after the first window held, is not held against the
+// tier
+TEST(ComplexityGovernorTest, LaterSlowdownDoesNotBackOff) {
+    ComplexityGovernor governor(Adaptive(), 2);
+    ASSERT_EQ(RunWindow(&governor, 1, kSlowMs), 0);
+    ASSERT_EQ(WindowsToStepUp(&governor, 0, 16), 4);
+    ASSERT_EQ(RunWindow(&governor, 1, kSteadyMs), 1);
+    ASSERT_EQ(RunWindow(&governor, 1, kSlowMs), 0);
+    EXPECT_EQ(WindowsToStepUp(&governor, 0, 16), 4);
+}
+
+// A switch whose frames never arrive (the new graph failed) is reverted
+// after a window's worth of frames from the old tier, and counts as undone
+TEST(ComplexityGovernorTest, RevertsSwitchThatNeverHappened) {
+    ComplexityGovernor governor(Adaptive(), 2);
+    ASSERT_EQ(RunWindow(&governor, 1, kSlowMs), 0);
+    ASSERT_EQ(WindowsToStepUp(&governor, 0, 16), 4);
+
+    EXPECT_EQ(RunWindow(&governor, 0, kFastMs), 0);
+    EXPECT_EQ(WindowsToStepUp(&governor, 0, 16), 8);
+}
+
+} // namespace
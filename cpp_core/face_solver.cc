@@ -0,0 +1,418 @@
+// face_solver.cc
+// Blendshape coefficients and head pose from face mesh landmarks
+//
+// The head pose is a least-squares similarity fit (Horn's quaternion
+// method) of six face mesh landmarks to a generic face model, under weak
+// perspective: MediaPipe's z is in the same scale as x, so the landmarks
+// are already a 3D point cloud up to scale. The fit's scale gives the
+// distance for an assumed field of view.
+//
+// Blendshapes are measured on the landmarks mapped back into the head's
+// own frame, so they do not change with head rotation or distance. Only
+// coefficients the mesh exposes reliably are estimated (eyes, gaze, jaw,
+// mouth shape, brows); the rest stay 0.
+
+#include "face_solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// ARKit ARFaceAnchor.BlendShapeLocation order
+const char* const kBlendshapeNames[MP_NUM_BLENDSHAPES] = {
+    "eyeBlinkLeft", "eyeLookDownLeft", "eyeLookInLeft", "eyeLookOutLeft",
+    "eyeLookUpLeft", "eyeSquintLeft", "eyeWideLeft",
+    "eyeBlinkRight", "eyeLookDownRight", "eyeLookInRight", "eyeLookOutRight",
+    "eyeLookUpRight", "eyeSquintRight", "eyeWideRight",
+    "jawForward", "jawLeft", "jawRight", "jawOpen",
+    "mouthClose", "mouthFunnel", "mouthPucker", "mouthLeft", "mouthRight",
+    "mouthSmileLeft", "mouthSmileRight", "mouthFrownLeft", "mouthFrownRight",
+    "mouthDimpleLeft", "mouthDimpleRight", "mouthStretchLeft", "mouthStretchRight",
+    "mouthRollLower", "mouthRollUpper", "mouthShrugLower", "mouthShrugUpper",
+    "mouthPressLeft", "mouthPressRight", "mouthLowerDownLeft", "mouthLowerDownRight",
+    "mouthUpperUpLeft", "mouthUpperUpRight",
+    "browDownLeft", "browDownRight", "browInnerUp", "browOuterUpLeft", "browOuterUpRight",
+    "cheekPuff", "cheekSquintLeft", "cheekSquintRight",
+    "noseSneerLeft", "noseSneerRight", "tongueOut",
+};
+
+enum Blendshape {
+    kEyeBlinkLeft = 0, kEyeLookDownLeft, kEyeLookInLeft, kEyeLookOutLeft,
+    kEyeLookUpLeft, kEyeSquintLeft, kEyeWideLeft,
+    kEyeBlinkRight, kEyeLookDownRight, kEyeLookInRight, kEyeLookOutRight,
+    kEyeLookUpRight, kEyeSquintRight, kEyeWideRight,
+    kJawForward, kJawLeft, kJawRight, kJawOpen,
+    kMouthClose, kMouthFunnel, kMouthPucker, kMouthLeft, kMouthRight,
+    kMouthSmileLeft, kMouthSmileRight, kMouthFrownLeft, kMouthFrownRight,
+    kMouthDimpleLeft, kMouthDimpleRight, kMouthStretchLeft, kMouthStretchRight,
+    kMouthRollLower, kMouthRollUpper, kMouthShrugLower, kMouthShrugUpper,
+    kMouthPressLeft, kMouthPressRight, kMouthLowerDownLeft, kMouthLowerDownRight,
+    kMouthUpperUpLeft, kMouthUpperUpRight,
+    kBrowDownLeft, kBrowDownRight, kBrowInnerUp, kBrowOuterUpLeft, kBrowOuterUpRight,
+    kCheekPuff, kCheekSquintLeft, kCheekSquintRight,
+    kNoseSneerLeft, kNoseSneerRight, kTongueOut,
+};
+
+// Face mesh indices. "Left" is the subject's left, which appears on the
+// right of an unmirrored image.
+constexpr int kNoseTip = 1;
+constexpr int kChin = 152;
+constexpr int kUpperLipInner = 13;
+constexpr int kLowerLipInner = 14;
+constexpr int kMouthCornerRight = 61;
+constexpr int kMouthCornerLeft = 291;
+
+struct EyeIndices {
+    int outer, inner, upper, lower, iris, brow_inner, brow_outer;
+};
+constexpr EyeIndices kLeftEye = {263, 362, 386, 374, 473, 336, 300};
+constexpr EyeIndices kRightEye = {33, 133, 159, 145, 468, 107, 70};
+
+// Mesh size with the 10 refined iris points
+constexpr int kRefinedLandmarks = 478;
+
+struct Vec3 {
+    float x, y, z;
+};
+
+inline Vec3 operator+(Vec3 a, Vec3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline Vec3 operator-(Vec3 a, Vec3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline Vec3 operator*(Vec3 a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+inline float Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float Distance(Vec3 a, Vec3 b) { return std::sqrt(Dot(a - b, a - b)); }
+inline Vec3 Midpoint(Vec3 a, Vec3 b) { return (a + b) * 0.5f; }
+
+// Unit quaternion, w last as in MPResults
+struct Quat {
+    float x, y, z, w;
+};
+
+Vec3 Rotate(const Quat& q, Vec3 v) {
+    const Vec3 u = {q.x, q.y, q.z};
+    const Vec3 t = {2.0f * (u.y * v.z - u.z * v.y),
+                    2.0f * (u.z * v.x - u.x * v.z),
+                    2.0f * (u.x * v.y - u.y * v.x)};
+    const Vec3 ut = {u.y * t.z - u.z * t.y, u.z * t.x - u.x * t.z, u.x * t.y - u.y * t.x};
+    return v + t * q.w + ut;
+}
+
+Quat Conjugate(const Quat& q) {
+    return {-q.x, -q.y, -q.z, q.w};
+}
+
+// Generic face model in meters: x toward the subject's left, y up, z out of
+// the face, nose tip at the origin. Outer eye corners are 9 cm apart.
+struct ModelPoint {
+    int index;
+    Vec3 position;
+};
+constexpr float kModelScale = 0.0002f;  // model units to meters
+const ModelPoint kFaceModel[] = {
+    {kNoseTip, {0.0f, 0.0f, 0.0f}},
+    {kChin, {0.0f, -330.0f * kModelScale, -65.0f * kModelScale}},
+    {kRightEye.outer, {-225.0f * kModelScale, 170.0f * kModelScale, -135.0f * kModelScale}},
+    {kLeftEye.outer, {225.0f * kModelScale, 170.0f * kModelScale, -135.0f * kModelScale}},
+    {kMouthCornerRight, {-150.0f * kModelScale, -150.0f * kModelScale, -125.0f * kModelScale}},
+    {kMouthCornerLeft, {150.0f * kModelScale, -150.0f * kModelScale, -125.0f * kModelScale}},
+};
+constexpr int kModelPoints = sizeof(kFaceModel) / sizeof(kFaceModel[0]);
+
+// Focal length in image widths for the assumed 60 degree horizontal FOV
+constexpr float kFocalLength = 0.8660254f;  // 0.5 / tan(30 deg)
+
+// Expression ranges, in eye widths or meters in the head frame, tuned for
+// a neutral adult face
+constexpr float kEyeOpenRatio = 0.26f;    // lid gap / eye width, relaxed
+constexpr float kEyeClosedRatio = 0.09f;
+constexpr float kEyeWideRatio = 0.32f;
+constexpr float kEyeWideRange = 0.08f;
+constexpr float kGazeRange = 0.12f;       // iris offset / eye width at full look
+constexpr float kJawClosedGap = 0.002f;   // m
+constexpr float kJawOpenRange = 0.035f;
+constexpr float kMouthRestWidth = 0.060f; // corner to corner
+constexpr float kMouthWidthRange = 0.012f;
+constexpr float kMouthShiftRange = 0.008f;
+constexpr float kJawShiftRange = 0.010f;
+constexpr float kCornerNeutral = -0.002f; // corner height above the lip center
+constexpr float kSmileRange = 0.008f;
+constexpr float kFrownRange = 0.006f;
+constexpr float kBrowRestRatio = 0.65f;   // brow height above the eye / eye width
+constexpr float kBrowRange = 0.20f;
+
+inline float Clamp01(float value) {
+    return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+// Landmarks as points in image-width units with y up and z toward the
+// camera, from either result layout
+class FacePoints {
+public:
+    FacePoints(const MPResults& results, float aspect)
+        : aos_(results.face_landmarks), planes_(results.face_planes), aspect_(aspect) {}
+
+    Vec3 operator[](int i) const {
+        if (aos_) {
+            return {aos_[i].x, -aos_[i].y * aspect_, -aos_[i].z};
+        }
+        return {planes_.x[i], -planes_.y[i] * aspect_, -planes_.z[i]};
+    }
+
+private:
+    const MPLandmark* aos_;
+    MPLandmarkPlanes planes_;
+    float aspect_;
+};
+
+// Eigenvector of the largest eigenvalue of symmetric 4x4 `m`, by cyclic
+// Jacobi rotations
+void DominantEigenvector(float m[4][4], float out[4]) {
+    float v[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+    for (int sweep = 0; sweep < 8; ++sweep) {
+        float off = 0.0f;
+        for (int p = 0; p < 4; ++p) {
+            for (int q = p + 1; q < 4; ++q) {
+                off += m[p][q] * m[p][q];
+            }
+        }
+        if (off < 1e-18f) {
+            break;
+        }
+        for (int p = 0; p < 4; ++p) {
+            for (int q = p + 1; q < 4; ++q) {
+                if (std::fabs(m[p][q]) < 1e-20f) {
+                    continue;
+                }
+                const float theta = (m[q][q] - m[p][p]) / (2.0f * m[p][q]);
+                const float t = (theta >= 0.0f ? 1.0f : -1.0f) /
+                    (std::fabs(theta) + std::sqrt(theta * theta + 1.0f));
+                const float c = 1.0f / std::sqrt(t * t + 1.0f);
+                const float s = t * c;
+                for (int k = 0; k < 4; ++k) {
+                    const float mkp = m[k][p];
+                    const float mkq = m[k][q];
+                    m[k][p] = c * mkp - s * mkq;
+                    m[k][q] = s * mkp + c * mkq;
+                }
+                for (int k = 0; k < 4; ++k) {
+                    const float mpk = m[p][k];
+                    const float mqk = m[q][k];
+                    m[p][k] = c * mpk - s * mqk;
+                    m[q][k] = s * mpk + c * mqk;
+                }
+                for (int k = 0; k < 4; ++k) {
+                    const float vkp = v[k][p];
+                    const float vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    int best = 0;
+    for (int i = 1; i < 4; ++i) {
+        if (m[i][i] > m[best][best]) {
+            best = i;
+        }
+    }
+    for (int k = 0; k < 4; ++k) {
+        out[k] = v[k][best];
+    }
+}
+
+struct HeadPose {
+    Quat rotation;   // model to observation
+    float scale;     // image widths per meter
+    Vec3 origin;     // nose tip, observation space
+};
+
+// Similarity fit of kFaceModel to the observed points (Horn 1987)
+HeadPose FitHeadPose(const FacePoints& points) {
+    Vec3 model_centroid = {0, 0, 0};
+    Vec3 observed_centroid = {0, 0, 0};
+    Vec3 observed[kModelPoints];
+    for (int i = 0; i < kModelPoints; ++i) {
+        observed[i] = points[kFaceModel[i].index];
+        model_centroid = model_centroid + kFaceModel[i].position;
+        observed_centroid = observed_centroid + observed[i];
+    }
+    model_centroid = model_centroid * (1.0f / kModelPoints);
+    observed_centroid = observed_centroid * (1.0f / kModelPoints);
+
+    float s[3][3] = {};
+    float model_spread = 0.0f;
+    float observed_spread = 0.0f;
+    for (int i = 0; i < kModelPoints; ++i) {
+        const Vec3 a = kFaceModel[i].position - model_centroid;
+        const Vec3 b = observed[i] - observed_centroid;
+        const float av[3] = {a.x, a.y, a.z};
+        const float bv[3] = {b.x, b.y, b.z};
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c) {
+                s[r][c] += av[r] * bv[c];
+            }
+        }
+        model_spread += Dot(a, a);
+        observed_spread += Dot(b, b);
+    }
+
+    float n[4][4] = {
+        {s[0][0] + s[1][1] + s[2][2], s[1][2] - s[2][1], s[2][0] - s[0][2], s[0][1] - s[1][0]},
+        {s[1][2] - s[2][1], s[0][0] - s[1][1] - s[2][2], s[0][1] + s[1][0], s[2][0] + s[0][2]},
+        {s[2][0] - s[0][2], s[0][1] + s[1][0], -s[0][0] + s[1][1] - s[2][2], s[1][2] + s[2][1]},
+        {s[0][1] - s[1][0], s[2][0] + s[0][2], s[1][2] + s[2][1], -s[0][0] - s[1][1] + s[2][2]},
+    };
+    float q[4];  // w, x, y, z
+    DominantEigenvector(n, q);
+    if (q[0] < 0.0f) {
+        for (float& component : q) {
+            component = -component;
+        }
+    }
+
+    HeadPose pose;
+    pose.rotation = {q[1], q[2], q[3], q[0]};
+    pose.scale = model_spread > 0.0f ? std::sqrt(observed_spread / model_spread) : 0.0f;
+    pose.origin = observed_centroid - Rotate(pose.rotation, model_centroid) * pose.scale;
+    return pose;
+}
+
+// Gaze of one eye from its iris position, relative to the eye's corners
+void SolveGaze(const Vec3& outer, const Vec3& inner, const Vec3& upper, const Vec3& lower,
+               const Vec3& iris, float* look_in, float* look_out,
+               float* look_up, float* look_down) {
+    const Vec3 axis = outer - inner;
+    const float width_sq = Dot(axis, axis);
+    if (width_sq <= 0.0f) {
+        return;
+    }
+    const float width = std::sqrt(width_sq);
+    const float across = Dot(iris - inner, axis) / width_sq - 0.5f;
+    const float vertical = (iris.y - Midpoint(upper, lower).y) / width;
+    *look_out = Clamp01(across / kGazeRange);
+    *look_in = Clamp01(-across / kGazeRange);
+    *look_up = Clamp01(vertical / kGazeRange);
+    *look_down = Clamp01(-vertical / kGazeRange);
+}
+
+} // anonymous namespace
+
+const char* BlendshapeName(int index) {
+    if (index < 0 || index >= MP_NUM_BLENDSHAPES) {
+        return nullptr;
+    }
+    return kBlendshapeNames[index];
+}
+
+void SolveFace(MPResults* results, float aspect) {
+    memset(results->blendshapes, 0, sizeof(results->blendshapes));
+    memset(results->head_translation, 0, sizeof(results->head_translation));
+    results->head_rotation[0] = 0.0f;
+    results->head_rotation[1] = 0.0f;
+    results->head_rotation[2] = 0.0f;
+    results->head_rotation[3] = 1.0f;
+
+    const bool has_points = results->face_landmarks || results->face_planes.x;
+    if (!results->face_detected || !has_points || results->face_count <= kChin) {
+        return;
+    }
+
+    const FacePoints points(*results, aspect);
+    const HeadPose pose = FitHeadPose(points);
+    if (pose.scale <= 0.0f) {
+        return;
+    }
+
+    results->head_rotation[0] = pose.rotation.x;
+    results->head_rotation[1] = pose.rotation.y;
+    results->head_rotation[2] = pose.rotation.z;
+    results->head_rotation[3] = pose.rotation.w;
+
+    // Pinhole camera at the image center, looking down -z
+    const float distance = kFocalLength / pose.scale;
+    const float meters_per_unit = distance / kFocalLength;
+    results->head_translation[0] = (pose.origin.x - 0.5f) * meters_per_unit;
+    results->head_translation[1] = (pose.origin.y + 0.5f * aspect) * meters_per_unit;
+    results->head_translation[2] = -distance;
+
+    // Landmarks in the head frame, in meters
+    const Quat inverse = Conjugate(pose.rotation);
+    const float inverse_scale = 1.0f / pose.scale;
+    auto local = [&](int index) {
+        return Rotate(inverse, points[index] - pose.origin) * inverse_scale;
+    };
+
+    float* bs = results->blendshapes;
+    const bool has_iris = results->face_count >= kRefinedLandmarks;
+
+    struct EyeOutputs {
+        int blink, wide, look_in, look_out, look_up, look_down, brow_down, brow_outer_up;
+    };
+    const EyeOutputs kLeftOutputs = {kEyeBlinkLeft, kEyeWideLeft, kEyeLookInLeft,
+                                     kEyeLookOutLeft, kEyeLookUpLeft, kEyeLookDownLeft,
+                                     kBrowDownLeft, kBrowOuterUpLeft};
+    const EyeOutputs kRightOutputs = {kEyeBlinkRight, kEyeWideRight, kEyeLookInRight,
+                                      kEyeLookOutRight, kEyeLookUpRight, kEyeLookDownRight,
+                                      kBrowDownRight, kBrowOuterUpRight};
+
+    float brow_inner_sum = 0.0f;
+    auto solve_eye = [&](const EyeIndices& eye, const EyeOutputs& out) {
+        const Vec3 outer = local(eye.outer);
+        const Vec3 inner = local(eye.inner);
+        const Vec3 upper = local(eye.upper);
+        const Vec3 lower = local(eye.lower);
+        const float width = Distance(outer, inner);
+        if (width <= 0.0f) {
+            return;
+        }
+
+        const float openness = Distance(upper, lower) / width;
+        bs[out.blink] = Clamp01((kEyeOpenRatio - openness) / (kEyeOpenRatio - kEyeClosedRatio));
+        bs[out.wide] = Clamp01((openness - kEyeWideRatio) / kEyeWideRange);
+
+        if (has_iris) {
+            SolveGaze(outer, inner, upper, lower, local(eye.iris), &bs[out.look_in],
+                      &bs[out.look_out], &bs[out.look_up], &bs[out.look_down]);
+        }
+
+        const float eye_y = Midpoint(outer, inner).y;
+        const float outer_height = (local(eye.brow_outer).y - eye_y) / width;
+        const float inner_height = (local(eye.brow_inner).y - eye_y) / width;
+        bs[out.brow_down] = Clamp01((kBrowRestRatio - inner_height) / kBrowRange);
+        bs[out.brow_outer_up] = Clamp01((outer_height - kBrowRestRatio) / kBrowRange);
+        brow_inner_sum += inner_height;
+    };
+    solve_eye(kLeftEye, kLeftOutputs);
+    solve_eye(kRightEye, kRightOutputs);
+    bs[kBrowInnerUp] = Clamp01((brow_inner_sum * 0.5f - kBrowRestRatio) / kBrowRange);
+
+    // Mouth and jaw
+    const Vec3 upper_lip = local(kUpperLipInner);
+    const Vec3 lower_lip = local(kLowerLipInner);
+    const Vec3 corner_left = local(kMouthCornerLeft);
+    const Vec3 corner_right = local(kMouthCornerRight);
+    const Vec3 lip_center = Midpoint(upper_lip, lower_lip);
+    const float gap = Distance(upper_lip, lower_lip);
+    const float width = Distance(corner_left, corner_right);
+    const float shift = Midpoint(corner_left, corner_right).x;
+    const float chin_shift = local(kChin).x;
+
+    bs[kJawOpen] = Clamp01((gap - kJawClosedGap) / kJawOpenRange);
+    bs[kJawLeft] = Clamp01(chin_shift / kJawShiftRange);
+    bs[kJawRight] = Clamp01(-chin_shift / kJawShiftRange);
+    bs[kMouthLeft] = Clamp01(shift / kMouthShiftRange);
+    bs[kMouthRight] = Clamp01(-shift / kMouthShiftRange);
+    bs[kMouthPucker] = Clamp01((kMouthRestWidth - width) / kMouthWidthRange);
+    bs[kMouthFunnel] = bs[kMouthPucker] * Clamp01(gap / kJawOpenRange * 4.0f);
+    bs[kMouthStretchLeft] = Clamp01((width - kMouthRestWidth) / kMouthWidthRange);
+    bs[kMouthStretchRight] = bs[kMouthStretchLeft];
+
+    const float lift_left = corner_left.y - lip_center.y - kCornerNeutral;
+    const float lift_right = corner_right.y - lip_center.y - kCornerNeutral;
+    bs[kMouthSmileLeft] = Clamp01(lift_left / kSmileRange);
+    bs[kMouthSmileRight] = Clamp01(lift_right / kSmileRange);
+    bs[kMouthFrownLeft] = Clamp01(-lift_left / kFrownRange);
+    bs[kMouthFrownRight] = Clamp01(-lift_right / kFrownRange);
+}
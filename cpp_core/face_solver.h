@@ -0,0 +1,18 @@
+// face_solver.h
+// Blendshape coefficients and head pose from face mesh landmarks
+
+#ifndef FACE_SOLVER_H
+#define FACE_SOLVER_H
+
+#include "mediapipe_bridge.h"
+
+// Fill `results->blendshapes`, `head_rotation` and `head_translation` from
+// the face landmarks in `results` (either landmark layout). `aspect` is the
+// input image's height / width, needed to undo the normalized coordinates.
+// Without a face the coefficients are zero and the pose is identity.
+void SolveFace(MPResults* results, float aspect);
+
+// ARKit name of blendshape `index`, or NULL if out of range
+const char* BlendshapeName(int index);
+
+#endif // FACE_SOLVER_H
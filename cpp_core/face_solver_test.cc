@@ -0,0 +1,149 @@
+// face_solver_test.cc
+// Tests for SolveFace and BlendshapeName
+
+#include "face_solver.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr float kAspect = 0.75f;  // 640x480
+constexpr float kScale = 2.0f;    // image widths per meter
+
+// Blendshape indices (ARKit order)
+constexpr int kEyeBlinkLeft = 0;
+constexpr int kJawOpen = 17;
+
+struct Vec3 {
+    float x, y, z;
+};
+
+// Face mesh of 478 landmarks posed by `rotation` (x, y, z, w), with points
+// given in the solver's head frame: meters, x toward the subject's left,
+// y up, z out of the face, nose tip at the origin
+class Face {
+public:
+    explicit Face(const float rotation[4]) : landmarks_(MP_MAX_FACE_LANDMARKS) {
+        memcpy(rotation_, rotation, sizeof(rotation_));
+        // The solver's generic model points, scaled to meters
+        const float m = 0.0002f;
+        Place(1, {0.0f, 0.0f, 0.0f});
+        Place(152, {0.0f, -330.0f * m, -65.0f * m});
+        Place(33, {-225.0f * m, 170.0f * m, -135.0f * m});
+        Place(263, {225.0f * m, 170.0f * m, -135.0f * m});
+        Place(61, {-150.0f * m, -150.0f * m, -125.0f * m});
+        Place(291, {150.0f * m, -150.0f * m, -125.0f * m});
+    }
+
+    // Observation = rotation * head * kScale + image center, stored with
+    // the landmarks' y down and z away from the camera
+    void Place(int index, Vec3 head) {
+        const float* q = rotation_;
+        const Vec3 t = {2.0f * (q[1] * head.z - q[2] * head.y),
+                        2.0f * (q[2] * head.x - q[0] * head.z),
+                        2.0f * (q[0] * head.y - q[1] * head.x)};
+        const Vec3 rotated = {
+            head.x + q[3] * t.x + (q[1] * t.z - q[2] * t.y),
+            head.y + q[3] * t.y + (q[2] * t.x - q[0] * t.z),
+            head.z + q[3] * t.z + (q[0] * t.y - q[1] * t.x),
+        };
+        const Vec3 observed = {0.5f + rotated.x * kScale, -0.5f * kAspect + rotated.y * kScale,
+                               rotated.z * kScale};
+        landmarks_[index] = {observed.x, -observed.y / kAspect, -observed.z, 1.0f, 1.0f};
+    }
+
+    MPResults Results() {
+        MPResults results = {};
+        results.face_landmarks = landmarks_.data();
+        results.face_count = MP_MAX_FACE_LANDMARKS;
+        results.face_detected = true;
+        return results;
+    }
+
+private:
+    float rotation_[4];
+    std::vector<MPLandmark> landmarks_;
+};
+
+const float kIdentity[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+TEST(FaceSolverTest, NoFaceGivesNeutralPose) {
+    MPResults results = {};
+    results.blendshapes[kJawOpen] = 0.5f;
+    SolveFace(&results, kAspect);
+
+    EXPECT_FLOAT_EQ(results.blendshapes[kJawOpen], 0.0f);
+    EXPECT_FLOAT_EQ(results.head_rotation[3], 1.0f);
+    EXPECT_FLOAT_EQ(results.head_translation[2], 0.0f);
+}
+
+TEST(FaceSolverTest, RecoversHeadPose) {
+    // 10 degrees about x, then 25 about y
+    const float half_yaw = 0.5f * 25.0f * 3.14159265f / 180.0f;
+    const float half_pitch = 0.5f * 10.0f * 3.14159265f / 180.0f;
+    const float rotation[4] = {
+        std::sin(half_pitch) * std::cos(half_yaw),
+        std::cos(half_pitch) * std::sin(half_yaw),
+        -std::sin(half_pitch) * std::sin(half_yaw),
+        std::cos(half_pitch) * std::cos(half_yaw),
+    };
+    Face face(rotation);
+    MPResults results = face.Results();
+    SolveFace(&results, kAspect);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_NEAR(results.head_rotation[i], rotation[i], 1e-3f) << "component " << i;
+    }
+    // Centered, at the distance where the face spans kScale widths per meter
+    // under the assumed 60 degree field of view
+    EXPECT_NEAR(results.head_translation[0], 0.0f, 1e-3f);
+    EXPECT_NEAR(results.head_translation[1], 0.0f, 1e-3f);
+    EXPECT_NEAR(results.head_translation[2], -0.8660254f / kScale, 1e-3f);
+}
+
+// Expressions are measured in the head frame, so a turned head reads the
+// same as a frontal one
+TEST(FaceSolverTest, JawOpenIgnoresHeadRotation) {
+    const float turned[4] = {0.0f, std::sin(0.3f), 0.0f, std::cos(0.3f)};
+    for (const float* rotation : {kIdentity, turned}) {
+        Face closed(rotation);
+        closed.Place(13, {0.0f, -0.030f, 0.0f});
+        closed.Place(14, {0.0f, -0.031f, 0.0f});
+        MPResults closed_results = closed.Results();
+        SolveFace(&closed_results, kAspect);
+        EXPECT_NEAR(closed_results.blendshapes[kJawOpen], 0.0f, 0.02f);
+
+        Face open(rotation);
+        open.Place(13, {0.0f, -0.030f, 0.0f});
+        open.Place(14, {0.0f, -0.050f, 0.0f});
+        MPResults open_results = open.Results();
+        SolveFace(&open_results, kAspect);
+        EXPECT_NEAR(open_results.blendshapes[kJawOpen], (0.020f - 0.002f) / 0.035f, 0.02f);
+    }
+}
+
+TEST(FaceSolverTest, ClosedEyeBlinks) {
+    Face face(kIdentity);
+    // Left eye: outer, inner corners 3 cm apart, lids touching
+    face.Place(263, {0.045f, 0.034f, -0.027f});
+    face.Place(362, {0.015f, 0.034f, -0.027f});
+    face.Place(386, {0.030f, 0.0345f, -0.025f});
+    face.Place(374, {0.030f, 0.0335f, -0.025f});
+    MPResults results = face.Results();
+    SolveFace(&results, kAspect);
+    EXPECT_FLOAT_EQ(results.blendshapes[kEyeBlinkLeft], 1.0f);
+}
+
+TEST(FaceSolverTest, BlendshapeNames) {
+    EXPECT_STREQ(BlendshapeName(kEyeBlinkLeft), "eyeBlinkLeft");
+    EXPECT_STREQ(BlendshapeName(kJawOpen), "jawOpen");
+    EXPECT_STREQ(BlendshapeName(MP_NUM_BLENDSHAPES - 1), "tongueOut");
+    EXPECT_EQ(BlendshapeName(-1), nullptr);
+    EXPECT_EQ(BlendshapeName(MP_NUM_BLENDSHAPES), nullptr);
+}
+
+} // namespace
@@ -0,0 +1,79 @@
+// frame_pool.cc
+// Recycled, preallocated RGB input frames
+
+#include "frame_pool.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Pixel buffers start on a cache line so SIMD row kernels and the first
+// MediaPipe calculator never straddle one at the start of a row
+constexpr size_t kBufferAlignment = 64;
+
+int AlignedWidthStep(int width) {
+    const int alignment = mediapipe::ImageFrame::kDefaultAlignmentBoundary;
+    return (width * 3 + alignment - 1) / alignment * alignment;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<FramePool> FramePool::Create(int depth) {
+    return std::shared_ptr<FramePool>(new FramePool(depth));
+}
+
+FramePool::FramePool(int depth)
+    : depth_(depth > 0 ? depth : 1), slots_(new Slot[depth_]) {}
+
+FramePool::~FramePool() {
+    for (int i = 0; i < depth_; ++i) {
+        free(slots_[i].pixels);
+    }
+}
+
+std::unique_ptr<mediapipe::ImageFrame> FramePool::Acquire(int width, int height) {
+    const int width_step = AlignedWidthStep(width);
+    const size_t size = static_cast<size_t>(width_step) * height;
+
+    const uint32_t start = next_slot_.fetch_add(1, std::memory_order_relaxed);
+    for (int i = 0; i < depth_; ++i) {
+        Slot* slot = &slots_[(start + i) % depth_];
+        if (slot->in_use.exchange(true, std::memory_order_acquire)) {
+            continue;
+        }
+
+        // The slot is exclusively ours until Release, so it can be resized
+        if (slot->capacity < size) {
+            free(slot->pixels);
+            slot->capacity = 0;
+            const size_t rounded = (size + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment;
+            slot->pixels = static_cast<uint8_t*>(aligned_alloc(kBufferAlignment, rounded));
+            if (!slot->pixels) {
+                slot->in_use.store(false, std::memory_order_release);
+                throw std::bad_alloc();
+            }
+            slot->capacity = rounded;
+        }
+
+        auto self = shared_from_this();
+        return std::make_unique<mediapipe::ImageFrame>(
+            mediapipe::ImageFormat::SRGB,
+            width,
+            height,
+            width_step,
+            slot->pixels,
+            [self, slot](uint8_t*) { self->Release(slot); });
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::make_unique<mediapipe::ImageFrame>(
+        mediapipe::ImageFormat::SRGB,
+        width,
+        height,
+        mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+}
+
+void FramePool::Release(Slot* slot) {
+    slot->in_use.store(false, std::memory_order_release);
+}
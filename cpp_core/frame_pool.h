@@ -0,0 +1,58 @@
+// frame_pool.h
+// Recycled, preallocated RGB input frames
+
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "mediapipe/framework/formats/image_frame.h"
+
+// Fixed set of aligned SRGB pixel buffers handed out as ImageFrames.
+// A frame's deleter returns its buffer to the pool when the graph drops the
+// last packet referencing it, so steady-state processing never allocates
+// pixel memory. Acquire and release are lock-free.
+//
+// Buffers are sized on first use and only reallocated when a larger frame
+// arrives. When every buffer is in use, Acquire falls back to a regular
+// heap-allocated frame instead of blocking.
+class FramePool : public std::enable_shared_from_this<FramePool> {
+public:
+    // Frames hold a reference to the pool, so it is always shared
+    static std::shared_ptr<FramePool> Create(int depth);
+
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // An SRGB frame of `width` x `height`. Rows start on 16-byte boundaries,
+    // so WidthStep() equals width * 3 whenever that is a multiple of 16.
+    std::unique_ptr<mediapipe::ImageFrame> Acquire(int width, int height);
+
+    int depth() const { return depth_; }
+
+    // Frames that had to be allocated because the pool was exhausted
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<bool> in_use{false};
+        uint8_t* pixels = nullptr;  // owned, cache-line aligned
+        size_t capacity = 0;
+    };
+
+    explicit FramePool(int depth);
+
+    void Release(Slot* slot);
+
+    const int depth_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint32_t> next_slot_{0};  // rotating start for the free-slot scan
+    std::atomic<uint64_t> misses_{0};
+};
+
+#endif // FRAME_POOL_H
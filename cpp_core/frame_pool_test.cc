@@ -0,0 +1,179 @@
+// frame_pool_test.cc
+// Tests for FramePool
+
+#include "frame_pool.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr int kWidth = 64;  // width * 3 is a multiple of 16
+constexpr int kHeight = 4;
+
+// Fill every byte the frame may use, so overlapping or freed buffers show
+// up as corrupted patterns or sanitizer reports
+void Fill(mediapipe::ImageFrame* frame, uint8_t value) {
+    memset(frame->MutablePixelData(), value,
+           static_cast<size_t>(frame->WidthStep()) * frame->Height());
+}
+
+bool Holds(const mediapipe::ImageFrame& frame, uint8_t value) {
+    const size_t size = static_cast<size_t>(frame.WidthStep()) * frame.Height();
+    for (size_t i = 0; i < size; ++i) {
+        if (frame.PixelData()[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(FramePoolTest, DepthIsAtLeastOne) {
+    EXPECT_EQ(FramePool::Create(0)->depth(), 1);
+    EXPECT_EQ(FramePool::Create(3)->depth(), 3);
+}
+
+TEST(FramePoolTest, FrameLayout) {
+    auto pool = FramePool::Create(2);
+    auto frame = pool->Acquire(kWidth, kHeight);
+    EXPECT_EQ(frame->Width(), kWidth);
+    EXPECT_EQ(frame->Height(), kHeight);
+    EXPECT_EQ(frame->WidthStep(), kWidth * 3);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(frame->PixelData()) % 64, 0u);
+
+    // Rows are padded to 16 bytes: 10 pixels take 30 bytes, stepped by 32
+    auto narrow = pool->Acquire(10, kHeight);
+    EXPECT_EQ(narrow->WidthStep(), 32);
+    Fill(narrow.get(), 1);
+}
+
+// Released buffers are handed out again instead of allocating
+TEST(FramePoolTest, RecyclesBuffers) {
+    auto pool = FramePool::Create(2);
+    std::set<const uint8_t*> buffers;
+    for (int i = 0; i < 10; ++i) {
+        auto frame = pool->Acquire(kWidth, kHeight);
+        Fill(frame.get(), static_cast<uint8_t>(i));
+        buffers.insert(frame->PixelData());
+    }
+    EXPECT_LE(buffers.size(), 2u);
+    EXPECT_EQ(pool->misses(), 0u);
+}
+
+// A larger frame regrows the buffer; a smaller one reuses it
+TEST(FramePoolTest, GrowsBuffers) {
+    auto pool = FramePool::Create(1);
+    pool->Acquire(kWidth, kHeight).reset();
+    auto large = pool->Acquire(4 * kWidth, 4 * kHeight);
+    Fill(large.get(), 7);
+    const uint8_t* pixels = large->PixelData();
+    large.reset();
+
+    auto small = pool->Acquire(kWidth, kHeight);
+    EXPECT_EQ(small->PixelData(), pixels);
+    EXPECT_EQ(pool->misses(), 0u);
+}
+
+// An exhausted pool allocates on the heap, counts the miss, and recycles
+// again once a buffer comes back
+TEST(FramePoolTest, FallsBackToHeapWhenExhausted) {
+    auto pool = FramePool::Create(2);
+    auto first = pool->Acquire(kWidth, kHeight);
+    auto second = pool->Acquire(kWidth, kHeight);
+    Fill(first.get(), 1);
+    Fill(second.get(), 2);
+
+    auto extra = pool->Acquire(kWidth, kHeight);
+    EXPECT_EQ(pool->misses(), 1u);
+    EXPECT_NE(extra->PixelData(), first->PixelData());
+    EXPECT_NE(extra->PixelData(), second->PixelData());
+    EXPECT_EQ(extra->Width(), kWidth);
+    Fill(extra.get(), 3);
+    EXPECT_TRUE(Holds(*first, 1));
+    EXPECT_TRUE(Holds(*second, 2));
+
+    // A heap frame going away does not free a pool buffer
+    extra.reset();
+    EXPECT_NE(pool->Acquire(kWidth, kHeight), nullptr);
+    EXPECT_EQ(pool->misses(), 2u);
+
+    const uint8_t* returned = first->PixelData();
+    first.reset();
+    auto again = pool->Acquire(kWidth, kHeight);
+    EXPECT_EQ(again->PixelData(), returned);
+    EXPECT_EQ(pool->misses(), 2u);
+}
+
+// Frames keep the pool alive, so one released after its processor is gone
+// still returns its buffer safely
+TEST(FramePoolTest, FrameOutlivesPoolOwner) {
+    auto pool = FramePool::Create(2);
+    std::weak_ptr<FramePool> weak = pool;
+    auto frame = pool->Acquire(kWidth, kHeight);
+    auto other = pool->Acquire(kWidth, kHeight);
+    pool.reset();
+
+    EXPECT_FALSE(weak.expired());
+    Fill(frame.get(), 5);
+    EXPECT_TRUE(Holds(*frame, 5));
+    frame.reset();
+    EXPECT_FALSE(weak.expired());
+    other.reset();
+    EXPECT_TRUE(weak.expired());
+}
+
+// Threads acquire, fill and check frames, and hand some to each other so
+// that buffers are released on a different thread than acquired them. A
+// buffer given to two holders at once breaks the fill pattern.
+TEST(FramePoolTest, ConcurrentAcquireAndRelease) {
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 2000;
+    auto pool = FramePool::Create(3);
+
+    std::mutex handoff_mutex;
+    std::unique_ptr<mediapipe::ImageFrame> handoff;
+    std::vector<int> corrupted(kThreads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kIterations; ++i) {
+                auto frame = pool->Acquire(kWidth + (i % 3) * 16, kHeight);
+                const uint8_t value = static_cast<uint8_t>(t * 64 + i % 64);
+                Fill(frame.get(), value);
+                std::this_thread::yield();
+                if (!Holds(*frame, value)) {
+                    ++corrupted[t];
+                }
+                if (i % 4 == 0) {
+                    std::lock_guard<std::mutex> lock(handoff_mutex);
+                    handoff.swap(frame);
+                }
+                // `frame` (ours, or the one another thread left) is
+                // released here
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    handoff.reset();
+
+    for (int t = 0; t < kThreads; ++t) {
+        EXPECT_EQ(corrupted[t], 0) << "thread " << t;
+    }
+    // Every buffer is free again
+    std::vector<std::unique_ptr<mediapipe::ImageFrame>> held;
+    const uint64_t misses = pool->misses();
+    for (int i = 0; i < pool->depth(); ++i) {
+        held.push_back(pool->Acquire(kWidth, kHeight));
+    }
+    EXPECT_EQ(pool->misses(), misses);
+}
+
+} // namespace
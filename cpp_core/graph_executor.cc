@@ -0,0 +1,176 @@
+// graph_executor.cc
+// Calculator graph executors with explicit thread count and CPU affinity
+
+#include "graph_executor.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Fixed-size FIFO thread pool, every thread pinned to the same cores
+class PinnedThreadPool : public mediapipe::Executor {
+public:
+    PinnedThreadPool(int num_threads, uint64_t cpu_affinity) {
+        threads_.reserve(num_threads);
+        for (int i = 0; i < num_threads; ++i) {
+            threads_.emplace_back([this, cpu_affinity] { WorkerLoop(cpu_affinity); });
+        }
+    }
+
+    ~PinnedThreadPool() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void Schedule(std::function<void()> task) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+private:
+    void WorkerLoop(uint64_t cpu_affinity) {
+#ifdef __linux__
+        pthread_setname_np(pthread_self(), "mp_executor");
+#endif
+        // Threads created from here, such as XNNPACK's, inherit the mask
+        PinCurrentThread(cpu_affinity);
+
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+};
+
+// `cpu_affinity` without the cores this machine does not have
+uint64_t UsableCores(uint64_t cpu_affinity) {
+    const unsigned cores = std::thread::hardware_concurrency();
+    return cores == 0 || cores >= 64 ? cpu_affinity
+                                     : cpu_affinity & ((uint64_t{1} << cores) - 1);
+}
+
+} // anonymous namespace
+
+int CountAffinityCores(uint64_t cpu_affinity) {
+    return __builtin_popcountll(UsableCores(cpu_affinity));
+}
+
+uint64_t AffinitySlice(uint64_t cpu_affinity, int index, int count) {
+    if (cpu_affinity == 0) {
+        const unsigned cores = std::max(1u, std::min(std::thread::hardware_concurrency(), 64u));
+        cpu_affinity = cores >= 64 ? ~uint64_t{0} : (uint64_t{1} << cores) - 1;
+    }
+    const int cores = CountAffinityCores(cpu_affinity);
+    if (cores == 0 || count <= 0) {
+        return 0;
+    }
+    if (cores < count) {
+        return uint64_t{1} << NthAffinityCore(cpu_affinity, index);
+    }
+
+    // Contiguous runs of the mask's cores, sizes differing by at most one
+    const int first = static_cast<int>(static_cast<int64_t>(index % count) * cores / count);
+    const int last = static_cast<int>(static_cast<int64_t>(index % count + 1) * cores / count);
+    uint64_t slice = 0;
+    for (int i = first; i < last; ++i) {
+        slice |= uint64_t{1} << NthAffinityCore(cpu_affinity, i);
+    }
+    return slice;
+}
+
+void PinCurrentThread(uint64_t cpu_affinity) {
+#ifdef __linux__
+    if (cpu_affinity == 0) {
+        return;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int core = 0; core < 64; ++core) {
+        if (cpu_affinity & (uint64_t{1} << core)) {
+            CPU_SET(core, &cpus);
+        }
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#else
+    (void)cpu_affinity;
+#endif
+}
+
+int NthAffinityCore(uint64_t cpu_affinity, int index) {
+    const uint64_t usable = UsableCores(cpu_affinity);
+    const int count = __builtin_popcountll(usable);
+    if (count == 0) {
+        return -1;
+    }
+    int skip = index % count;
+    for (int core = 0; core < 64; ++core) {
+        if ((usable & (uint64_t{1} << core)) && skip-- == 0) {
+            return core;
+        }
+    }
+    return -1;
+}
+
+std::shared_ptr<mediapipe::Executor> CreateGraphExecutor(const MPThreading& threading) {
+    if (threading.executor_threads <= 0 && threading.cpu_affinity == 0 && !threading.shared) {
+        return nullptr;
+    }
+
+    int num_threads = threading.executor_threads;
+    if (num_threads <= 0 && threading.cpu_affinity != 0) {
+        num_threads = CountAffinityCores(threading.cpu_affinity);
+    }
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    if (!threading.shared) {
+        return std::make_shared<PinnedThreadPool>(num_threads, threading.cpu_affinity);
+    }
+
+    static std::mutex mutex;
+    static std::map<std::pair<int, uint64_t>, std::weak_ptr<mediapipe::Executor>> executors;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::weak_ptr<mediapipe::Executor>& entry = executors[{num_threads, threading.cpu_affinity}];
+    auto executor = entry.lock();
+    if (!executor) {
+        executor = std::make_shared<PinnedThreadPool>(num_threads, threading.cpu_affinity);
+        entry = executor;
+    }
+    return executor;
+}
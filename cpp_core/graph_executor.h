@@ -0,0 +1,35 @@
+// graph_executor.h
+// Calculator graph executors with explicit thread count and CPU affinity
+
+#ifndef GRAPH_EXECUTOR_H
+#define GRAPH_EXECUTOR_H
+
+#include <memory>
+
+#include "mediapipe_bridge.h"
+
+#include "mediapipe/framework/executor.h"
+
+// Number of cores set in `cpu_affinity` that this machine has
+int CountAffinityCores(uint64_t cpu_affinity);
+
+// The `index`-th core of `cpu_affinity`, wrapping around; -1 for an empty
+// mask
+int NthAffinityCore(uint64_t cpu_affinity, int index);
+
+// Slice `index` of the cores of `cpu_affinity` (0 = every core) split
+// into `count` disjoint slices. With fewer cores than `count`, each slice
+// is one core and the cores wrap around.
+uint64_t AffinitySlice(uint64_t cpu_affinity, int index, int count);
+
+// Restrict the calling thread to `cpu_affinity` (0 = leave it as is)
+void PinCurrentThread(uint64_t cpu_affinity);
+
+// Default executor for a graph configured with `threading`, or null to
+// keep MediaPipe's own. With `threading.shared`, handles whose thread count
+// and affinity match get the same executor for as long as any of them
+// lives. Set it with CalculatorGraph::SetExecutor("", ...) before
+// Initialize.
+std::shared_ptr<mediapipe::Executor> CreateGraphExecutor(const MPThreading& threading);
+
+#endif // GRAPH_EXECUTOR_H
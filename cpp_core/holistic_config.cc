@@ -3,61 +3,400 @@
 
 // This is the graph configuration for MediaPipe Holistic.
 // It defines the processing pipeline: face mesh + hands + pose tracking.
+// The graph is assembled from the node snippets below so that it only
+// contains what the MPConfig asks for, and model selection flags reach the
+// subgraphs as input side packets instead of being baked into the text.
 //
 // Reference: mediapipe/graphs/holistic_tracking/holistic_tracking_cpu.pbtxt
+//            mediapipe/graphs/holistic_tracking/holistic_tracking_gpu.pbtxt
 
-const char* kHolisticGraphConfig = R"pb(
-# MediaPipe Holistic Tracking Graph (CPU)
-# Inputs: "input_video" (ImageFrame)
-# Outputs: "face_landmarks", "pose_landmarks", "left_hand_landmarks", "right_hand_landmarks"
+#include "holistic_config.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+#include "mediapipe/calculators/tensor/inference_calculator.pb.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/tool/subgraph_expansion.h"
+
+namespace {
+
+// Profiler histogram: 0.25 ms buckets up to 100 ms, anything slower lands
+// in the last bucket. MP_GetStats reports percentiles at bucket edges.
+constexpr int64_t kProfilerIntervalUsec = 250;
+constexpr int64_t kProfilerIntervals = 400;
+
+// Graph inputs and side packets. Output streams are declared per enabled
+// output in BuildHolisticGraphConfig.
+// Side packets: see BuildHolisticSidePackets
+const char kGraphHeader[] = R"pb(
+# MediaPipe Holistic Tracking Graph ($DEVICE)
+# Inputs: "input_video" (ImageFrame on CPU, GpuBuffer on GPU)
+# Outputs: "face_landmarks", "pose_landmarks", "pose_world_landmarks",
+#          "left_hand_landmarks", "right_hand_landmarks" (when enabled)
 
 input_stream: "input_video"
 
-# Outputs
-output_stream: "face_landmarks"
-output_stream: "pose_landmarks"
-output_stream: "pose_world_landmarks"
-output_stream: "left_hand_landmarks"
-output_stream: "right_hand_landmarks"
+input_side_packet: "model_complexity"
+input_side_packet: "hand_model_complexity"
+input_side_packet: "smooth_landmarks"
+input_side_packet: "refine_face_landmarks"
+input_side_packet: "enable_segmentation"
+input_side_packet: "use_prev_landmarks"
+)pb";
 
-# Face detection for initial frame
+// Throttles video input while earlier frames are still in the graph.
+// Left out in static image and offline mode, where every image must be
+// processed.
+const char kFlowLimiterNode[] = R"pb(
 node {
   calculator: "FlowLimiterCalculator"
   input_stream: "input_video"
-  input_stream: "FINISHED:face_landmarks"
+  input_stream: "FINISHED:$FINISHED"
   input_stream_info: {
     tag_index: "FINISHED"
     back_edge: true
   }
   output_stream: "throttled_input_video"
+  options {
+    [mediapipe.FlowLimiterCalculatorOptions.ext] {
+      max_in_flight: $MAX_IN_FLIGHT
+    }
+  }
 }
+)pb";
 
-# Face landmark detection
+// Face landmark detection (WITH_ATTENTION adds the 10 iris landmarks)
+const char kFaceNode[] = R"pb(
 node {
-  calculator: "FaceLandmarkCpu"
-  input_stream: "IMAGE:throttled_input_video"
+  calculator: "FaceLandmark$DEVICE"
+  input_stream: "IMAGE:$IMAGE"
+  input_side_packet: "WITH_ATTENTION:refine_face_landmarks"
   output_stream: "LANDMARKS:face_landmarks"
 }
+)pb";
 
-# Pose detection
+// Pose detection ($OUTPUTS: world landmarks when enabled)
+const char kPoseNode[] = R"pb(
 node {
-  calculator: "PoseLandmarkCpu"
-  input_stream: "IMAGE:throttled_input_video"
+  calculator: "PoseLandmark$DEVICE"
+  input_stream: "IMAGE:$IMAGE"
+  input_side_packet: "MODEL_COMPLEXITY:model_complexity"
+  input_side_packet: "SMOOTH_LANDMARKS:smooth_landmarks"
+  input_side_packet: "ENABLE_SEGMENTATION:enable_segmentation"
+  input_side_packet: "USE_PREV_LANDMARKS:use_prev_landmarks"
   output_stream: "LANDMARKS:pose_landmarks"
-  output_stream: "WORLD_LANDMARKS:pose_world_landmarks"
+  $OUTPUTS
 }
+)pb";
 
-# Hand tracking from pose wrist landmarks
+// Hand tracking from pose wrist landmarks ($OUTPUTS: enabled hands)
+const char kHandNode[] = R"pb(
 node {
-  calculator: "HandLandmarkTrackingCpu"
-  input_stream: "IMAGE:throttled_input_video"
+  calculator: "HandLandmarkTracking$DEVICE"
+  input_stream: "IMAGE:$IMAGE"
   input_stream: "ROI_FROM_POSE:pose_landmarks"
-  output_stream: "LEFT_HAND_LANDMARKS:left_hand_landmarks"
-  output_stream: "RIGHT_HAND_LANDMARKS:right_hand_landmarks"
+  input_side_packet: "MODEL_COMPLEXITY:hand_model_complexity"
+  input_side_packet: "USE_PREV_LANDMARKS:use_prev_landmarks"
+  $OUTPUTS
 }
 )pb";
 
-// Note: The above is a SIMPLIFIED placeholder configuration.
+// Subgraph variant matching the input the processor sends: GpuBuffer in
+// GPU builds, ImageFrame otherwise
+#ifdef MEDIAPIPE_GPU_ENABLED
+const char kDevice[] = "Gpu";
+#else
+const char kDevice[] = "Cpu";
+#endif
+
+void ReplaceAll(std::string* text, const std::string& from, const std::string& to) {
+    for (size_t pos = text->find(from); pos != std::string::npos;
+         pos = text->find(from, pos + to.size())) {
+        text->replace(pos, from.size(), to);
+    }
+}
+
+} // anonymous namespace
+
+uint32_t ResolveEnabledOutputs(const MPConfig& config) {
+    return config.enabled_outputs == 0 ? MP_OUTPUT_ALL
+                                       : config.enabled_outputs & MP_OUTPUT_ALL;
+}
+
+namespace {
+
+// Text of the graph for `config`, empty if no output is enabled
+std::string BuildHolisticGraphText(const MPConfig& config) {
+    const uint32_t outputs = ResolveEnabledOutputs(config);
+    const bool want_face = outputs & MP_OUTPUT_FACE;
+    const bool want_hands = outputs & (MP_OUTPUT_LEFT_HAND | MP_OUTPUT_RIGHT_HAND);
+    const bool want_pose =
+        want_hands || (outputs & (MP_OUTPUT_POSE | MP_OUTPUT_POSE_WORLD));
+    if (!want_face && !want_pose) {
+        return std::string();
+    }
+
+    std::string text = kGraphHeader;
+    text += "\n# Outputs\n";
+    if (outputs & MP_OUTPUT_FACE) text += "output_stream: \"face_landmarks\"\n";
+    if (outputs & MP_OUTPUT_POSE) text += "output_stream: \"pose_landmarks\"\n";
+    if (outputs & MP_OUTPUT_POSE_WORLD) text += "output_stream: \"pose_world_landmarks\"\n";
+    if (outputs & MP_OUTPUT_LEFT_HAND) text += "output_stream: \"left_hand_landmarks\"\n";
+    if (outputs & MP_OUTPUT_RIGHT_HAND) text += "output_stream: \"right_hand_landmarks\"\n";
+
+    std::string image_stream = "input_video";
+    if (!config.static_image_mode && !config.offline_mode) {
+        std::string node = kFlowLimiterNode;
+        ReplaceAll(&node, "$MAX_IN_FLIGHT",
+                   std::to_string(std::max(1, config.max_frames_in_flight)));
+        // Any per-frame stream of an instantiated subgraph can close the loop
+        ReplaceAll(&node, "$FINISHED", want_face ? "face_landmarks" : "pose_landmarks");
+        text += node;
+        image_stream = "throttled_input_video";
+    }
+
+    if (want_face) {
+        text += kFaceNode;
+    }
+
+    if (want_pose) {
+        std::string node = kPoseNode;
+        ReplaceAll(&node, "$OUTPUTS",
+                   (outputs & MP_OUTPUT_POSE_WORLD)
+                       ? "output_stream: \"WORLD_LANDMARKS:pose_world_landmarks\""
+                       : "");
+        text += node;
+    }
+
+    if (want_hands) {
+        std::string hand_outputs;
+        if (outputs & MP_OUTPUT_LEFT_HAND) {
+            hand_outputs += "output_stream: \"LEFT_HAND_LANDMARKS:left_hand_landmarks\"\n";
+        }
+        if (outputs & MP_OUTPUT_RIGHT_HAND) {
+            hand_outputs += "output_stream: \"RIGHT_HAND_LANDMARKS:right_hand_landmarks\"\n";
+        }
+        std::string node = kHandNode;
+        ReplaceAll(&node, "$OUTPUTS", hand_outputs);
+        text += node;
+    }
+
+    ReplaceAll(&text, "$IMAGE", image_stream);
+    ReplaceAll(&text, "$DEVICE", kDevice);
+    return text;
+}
+
+void AddProfiler(mediapipe::CalculatorGraphConfig* graph_config) {
+    auto* profiler = graph_config->mutable_profiler_config();
+    profiler->set_enable_profiler(true);
+    profiler->set_histogram_interval_size_usec(kProfilerIntervalUsec);
+    profiler->set_num_histogram_intervals(kProfilerIntervals);
+}
+
+// Expand the subgraphs, where the inference nodes live, and apply
+// MPConfig::inference_backend and MPThreading::inference_threads to every
+// model. Threads go to the interpreter, and to XNNPACK where it is the
+// node's delegate. Without either setting the graph is left as it is.
+absl::Status ConfigureInference(const MPConfig& config,
+                                mediapipe::CalculatorGraphConfig* graph_config) {
+    const int threads = config.threading.inference_threads;
+    const MPInferenceBackend backend = config.inference_backend;
+    if (threads <= 0 && backend == MP_BACKEND_DEFAULT) {
+        return absl::OkStatus();
+    }
+
+    auto status = mediapipe::tool::ExpandSubgraphs(graph_config);
+    if (!status.ok()) {
+        return status;
+    }
+    for (auto& node : *graph_config->mutable_node()) {
+        if (node.calculator().rfind("InferenceCalculator", 0) != 0) {
+            continue;
+        }
+        auto* options = node.mutable_options()->MutableExtension(
+            mediapipe::InferenceCalculatorOptions::ext);
+        // An empty delegate message would itself change the choice, so
+        // the default backend leaves it alone
+        switch (backend) {
+        case MP_BACKEND_TFLITE_CPU: options->mutable_delegate()->mutable_tflite(); break;
+        case MP_BACKEND_XNNPACK:    options->mutable_delegate()->mutable_xnnpack(); break;
+        case MP_BACKEND_GPU:        options->mutable_delegate()->mutable_gpu(); break;
+        case MP_BACKEND_NNAPI:      options->mutable_delegate()->mutable_nnapi(); break;
+        default:                    break;
+        }
+        if (threads > 0) {
+            options->set_cpu_num_thread(threads);
+            if (options->delegate().has_xnnpack()) {
+                options->mutable_delegate()->mutable_xnnpack()->set_num_threads(threads);
+            }
+        }
+    }
+    return absl::OkStatus();
+}
+
+// Text protos are printable; binary ones carry field tags and lengths
+// below 0x20 almost from the first byte
+bool LooksLikeTextProto(const std::string& data) {
+    return std::all_of(data.begin(), data.end(), [](char c) {
+        const auto byte = static_cast<unsigned char>(c);
+        return byte >= 0x20 || byte == '\t' || byte == '\n' || byte == '\r';
+    });
+}
+
+// Stream or side packet name of a "TAG:index:name" / "TAG:name" / "name"
+// reference
+std::string ReferenceName(const std::string& reference) {
+    const size_t colon = reference.rfind(':');
+    return colon == std::string::npos ? reference : reference.substr(colon + 1);
+}
+
+bool ReferencesName(const google::protobuf::RepeatedPtrField<std::string>& references,
+                    const std::string& name) {
+    return std::any_of(references.begin(), references.end(),
+                       [&name](const std::string& reference) {
+                           return ReferenceName(reference) == name;
+                       });
+}
+
+} // anonymous namespace
+
+bool BuildHolisticGraphConfig(
+    const MPConfig& config,
+    mediapipe::CalculatorGraphConfig* graph_config
+) {
+    const std::string text = BuildHolisticGraphText(config);
+    if (text.empty() ||
+        !mediapipe::ParseTextProto<mediapipe::CalculatorGraphConfig>(text, graph_config)) {
+        return false;
+    }
+
+    if (!ConfigureInference(config, graph_config).ok()) {
+        return false;
+    }
+    if (config.enable_profiling) {
+        AddProfiler(graph_config);
+    }
+    return true;
+}
+
+std::shared_ptr<const mediapipe::CalculatorGraphConfig> SharedHolisticGraphConfig(
+    const MPConfig& config
+) {
+    // Keyed by everything BuildHolisticGraphConfig looks at. Entries are
+    // never evicted; a process only ever sees a handful of variants.
+    static std::mutex mutex;
+    static std::unordered_map<std::string,
+                              std::shared_ptr<const mediapipe::CalculatorGraphConfig>> cache;
+
+    std::string key = BuildHolisticGraphText(config);
+    if (config.threading.inference_threads > 0) {
+        key += "#threads=" + std::to_string(config.threading.inference_threads);
+    }
+    if (config.inference_backend != MP_BACKEND_DEFAULT) {
+        key += "#backend=" + std::to_string(config.inference_backend);
+    }
+    if (config.enable_profiling) {
+        key += "#profiled";
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            return it->second;
+        }
+    }
+
+    // Parsed outside the lock; a concurrent parse of the same key is harmless
+    auto graph_config = std::make_shared<mediapipe::CalculatorGraphConfig>();
+    if (!BuildHolisticGraphConfig(config, graph_config.get())) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return cache.emplace(key, std::move(graph_config)).first->second;
+}
+
+absl::StatusOr<std::shared_ptr<const mediapipe::CalculatorGraphConfig>> LoadHolisticGraphConfig(
+    const MPConfig& config,
+    const void* graph,
+    size_t graph_size
+) {
+    std::string data;
+    if (graph_size == 0) {
+        const char* path = static_cast<const char*>(graph);
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return absl::NotFoundError(std::string("Cannot open graph file ") + path);
+        }
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (file.bad()) {
+            return absl::UnavailableError(std::string("Cannot read graph file ") + path);
+        }
+    } else {
+        data.assign(static_cast<const char*>(graph), graph_size);
+    }
+
+    auto graph_config = std::make_shared<mediapipe::CalculatorGraphConfig>();
+    if (LooksLikeTextProto(data)) {
+        if (!mediapipe::ParseTextProto<mediapipe::CalculatorGraphConfig>(data, graph_config.get())) {
+            return absl::InvalidArgumentError("Graph text proto does not parse");
+        }
+    } else if (!graph_config->ParseFromString(data)) {
+        return absl::InvalidArgumentError("Graph binary proto does not parse");
+    }
+
+    auto status = ConfigureInference(config, graph_config.get());
+    if (!status.ok()) {
+        return status;
+    }
+    if (config.enable_profiling) {
+        AddProfiler(graph_config.get());
+    }
+    return std::shared_ptr<const mediapipe::CalculatorGraphConfig>(std::move(graph_config));
+}
+
+bool GraphHasStream(const mediapipe::CalculatorGraphConfig& graph_config, const std::string& name) {
+    if (ReferencesName(graph_config.input_stream(), name)) {
+        return true;
+    }
+    return std::any_of(graph_config.node().begin(), graph_config.node().end(),
+                       [&name](const mediapipe::CalculatorGraphConfig::Node& node) {
+                           return ReferencesName(node.output_stream(), name);
+                       });
+}
+
+std::map<std::string, mediapipe::Packet> BuildHolisticSidePackets(
+    const MPConfig& config,
+    const mediapipe::CalculatorGraphConfig& graph_config
+) {
+    // Pose supports 0=Lite, 1=Full, 2=Heavy; the hand model only Lite/Full
+    const int model_complexity = std::clamp(config.model_complexity, 0, 2);
+
+    std::map<std::string, mediapipe::Packet> side_packets = {
+        {"model_complexity", mediapipe::MakePacket<int>(model_complexity)},
+        {"hand_model_complexity", mediapipe::MakePacket<int>(std::min(model_complexity, 1))},
+        {"smooth_landmarks",
+         mediapipe::MakePacket<bool>(config.smooth_landmarks && !config.static_image_mode)},
+        {"refine_face_landmarks", mediapipe::MakePacket<bool>(config.refine_face_landmarks)},
+        {"enable_segmentation", mediapipe::MakePacket<bool>(config.enable_segmentation)},
+        {"use_prev_landmarks", mediapipe::MakePacket<bool>(!config.static_image_mode)},
+    };
+
+    // A loaded graph may take only some of them
+    for (auto it = side_packets.begin(); it != side_packets.end();) {
+        if (ReferencesName(graph_config.input_side_packet(), it->first)) {
+            ++it;
+        } else {
+            it = side_packets.erase(it);
+        }
+    }
+    return side_packets;
+}
+
+// Note: The node snippets above are a SIMPLIFIED placeholder configuration.
 // In production, you need to use the actual MediaPipe graph configuration
 // from: mediapipe/graphs/holistic_tracking/holistic_tracking_cpu.pbtxt
 //
@@ -70,6 +409,10 @@ node {
 // - Result smoothing and filtering
 //
 // To use the official config:
-// 1. Copy the .pbtxt file content here
-// 2. Or load it from a file at runtime
+// 1. Copy the relevant .pbtxt node blocks into the snippets above
+// 2. Or load it at runtime with MP_CreateFromGraph (LoadHolisticGraphConfig)
 // 3. Make sure all calculator dependencies are linked in BUILD file
+//
+// min_detection_confidence / min_tracking_confidence are calculator options
+// inside the subgraphs and can't be set through side packets; tune them in
+// the subgraph .pbtxt files if the defaults don't fit.
@@ -0,0 +1,58 @@
+// holistic_config.h
+// Builds the MediaPipe Holistic graph configuration from MPConfig
+
+#ifndef HOLISTIC_CONFIG_H
+#define HOLISTIC_CONFIG_H
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "mediapipe_bridge.h"
+
+#include "mediapipe/framework/calculator_framework.h"
+
+// MPConfig::enabled_outputs with the 0 = all default applied
+uint32_t ResolveEnabledOutputs(const MPConfig& config);
+
+// Generate the holistic graph specialized for `config`.
+// Nodes and output streams the configuration does not need are left out.
+// With MPThreading::inference_threads or MPConfig::inference_backend the
+// subgraphs come back expanded, their inference nodes set accordingly.
+// Returns false if no output is enabled or the generated text fails to parse.
+bool BuildHolisticGraphConfig(
+    const MPConfig& config,
+    mediapipe::CalculatorGraphConfig* graph_config
+);
+
+// BuildHolisticGraphConfig through a process-wide cache, so handles whose
+// MPConfigs generate the same graph share one parsed config.
+// Returns null where BuildHolisticGraphConfig would return false.
+std::shared_ptr<const mediapipe::CalculatorGraphConfig> SharedHolisticGraphConfig(
+    const MPConfig& config
+);
+
+// Load a caller-supplied graph in place of the generated one. With
+// `graph_size` 0, `graph` is a NUL-terminated path to a .pbtxt or
+// .binarypb file; otherwise it is `graph_size` bytes of either form.
+// Inference backend, threads and profiling are applied as for the
+// generated graph.
+absl::StatusOr<std::shared_ptr<const mediapipe::CalculatorGraphConfig>> LoadHolisticGraphConfig(
+    const MPConfig& config,
+    const void* graph,
+    size_t graph_size
+);
+
+// Whether some node of `graph_config` produces the stream `name`, or the
+// graph takes it as input
+bool GraphHasStream(const mediapipe::CalculatorGraphConfig& graph_config, const std::string& name);
+
+// Input side packets for `graph_config`, which BuildHolisticGraphConfig or
+// LoadHolisticGraphConfig returned; packets the graph does not declare are
+// left out. Pass them to CalculatorGraph::StartRun.
+std::map<std::string, mediapipe::Packet> BuildHolisticSidePackets(
+    const MPConfig& config,
+    const mediapipe::CalculatorGraphConfig& graph_config
+);
+
+#endif // HOLISTIC_CONFIG_H
@@ -0,0 +1,327 @@
+// landmark_filter.cc
+// Temporal smoothing of landmark coordinates across frames
+//
+// One-Euro (Casiez et al. 2012) adapts a low-pass cutoff to the speed of
+// each coordinate: strong smoothing at rest, little lag when moving. The
+// Kalman filter tracks position and velocity per coordinate; with the same
+// time step, noise and initial state for all of them, its covariance and
+// gains are scalars shared by the whole set, leaving only a few vector
+// multiply-adds per coordinate.
+
+#include "landmark_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LANDMARK_FILTER_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LANDMARK_FILTER_NEON 1
+#endif
+
+namespace {
+
+constexpr float kDefaultMinCutoff = 1.0f;         // Hz
+constexpr float kDefaultBeta = 10.0f;             // Hz per unit/s
+constexpr float kDefaultDerivativeCutoff = 1.0f;  // Hz
+constexpr float kDefaultProcessNoise = 0.01f;     // units^2/s^3
+constexpr float kDefaultMeasurementNoise = 1e-5f; // units^2, ~2 px at 640 px
+constexpr float kInitialVelocityVariance = 1.0f;  // units^2/s^2
+
+constexpr float kTwoPi = 6.28318530718f;
+
+inline float OrDefault(float value, float fallback) {
+    return value > 0.0f ? value : fallback;
+}
+
+// Smoothing factor of a first-order low-pass at `cutoff` Hz over `dt` s
+inline float LowPassAlpha(float cutoff, float dt) {
+    const float r = kTwoPi * cutoff * dt;
+    return r / (r + 1.0f);
+}
+
+struct OneEuroParams {
+    float inv_dt;
+    float two_pi_dt;
+    float derivative_alpha;
+    float min_cutoff;
+    float beta;
+};
+
+// ============================================================================
+// Kernels: filter `values` in place against per-coordinate state
+// ============================================================================
+
+void OneEuroScalar(float* values, float* prev, float* prev_rate, int i, int count,
+                   const OneEuroParams& params) {
+    for (; i < count; ++i) {
+        const float delta = values[i] - prev[i];
+        const float rate = prev_rate[i] +
+            params.derivative_alpha * (delta * params.inv_dt - prev_rate[i]);
+        const float r = params.two_pi_dt * (params.min_cutoff + params.beta * std::fabs(rate));
+        const float filtered = prev[i] + r / (r + 1.0f) * delta;
+        prev[i] = filtered;
+        prev_rate[i] = rate;
+        values[i] = filtered;
+    }
+}
+
+void KalmanScalar(float* values, float* position, float* velocity, int i, int count,
+                  float dt, float gain_position, float gain_velocity) {
+    for (; i < count; ++i) {
+        const float predicted = position[i] + velocity[i] * dt;
+        const float innovation = values[i] - predicted;
+        position[i] = predicted + gain_position * innovation;
+        velocity[i] += gain_velocity * innovation;
+        values[i] = position[i];
+    }
+}
+
+#if LANDMARK_FILTER_SSE2
+
+void OneEuro(float* values, float* prev, float* prev_rate, int count,
+             const OneEuroParams& params) {
+    const __m128 inv_dt = _mm_set1_ps(params.inv_dt);
+    const __m128 two_pi_dt = _mm_set1_ps(params.two_pi_dt);
+    const __m128 derivative_alpha = _mm_set1_ps(params.derivative_alpha);
+    const __m128 min_cutoff = _mm_set1_ps(params.min_cutoff);
+    const __m128 beta = _mm_set1_ps(params.beta);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 p = _mm_loadu_ps(prev + i);
+        const __m128 pr = _mm_loadu_ps(prev_rate + i);
+        const __m128 delta = _mm_sub_ps(_mm_loadu_ps(values + i), p);
+        const __m128 rate = _mm_add_ps(pr, _mm_mul_ps(derivative_alpha,
+            _mm_sub_ps(_mm_mul_ps(delta, inv_dt), pr)));
+        const __m128 cutoff = _mm_add_ps(min_cutoff, _mm_mul_ps(beta, _mm_andnot_ps(sign, rate)));
+        const __m128 r = _mm_mul_ps(two_pi_dt, cutoff);
+        const __m128 alpha = _mm_div_ps(r, _mm_add_ps(r, one));
+        const __m128 filtered = _mm_add_ps(p, _mm_mul_ps(alpha, delta));
+        _mm_storeu_ps(prev + i, filtered);
+        _mm_storeu_ps(prev_rate + i, rate);
+        _mm_storeu_ps(values + i, filtered);
+    }
+    OneEuroScalar(values, prev, prev_rate, i, count, params);
+}
+
+void Kalman(float* values, float* position, float* velocity, int count,
+            float dt, float gain_position, float gain_velocity) {
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 k0 = _mm_set1_ps(gain_position);
+    const __m128 k1 = _mm_set1_ps(gain_velocity);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 v = _mm_loadu_ps(velocity + i);
+        const __m128 predicted = _mm_add_ps(_mm_loadu_ps(position + i), _mm_mul_ps(v, step));
+        const __m128 innovation = _mm_sub_ps(_mm_loadu_ps(values + i), predicted);
+        const __m128 p = _mm_add_ps(predicted, _mm_mul_ps(k0, innovation));
+        _mm_storeu_ps(position + i, p);
+        _mm_storeu_ps(velocity + i, _mm_add_ps(v, _mm_mul_ps(k1, innovation)));
+        _mm_storeu_ps(values + i, p);
+    }
+    KalmanScalar(values, position, velocity, i, count, dt, gain_position, gain_velocity);
+}
+
+#elif LANDMARK_FILTER_NEON
+
+// Full-precision division; vrecpeq_f32 alone is too coarse for the cutoff
+inline float32x4_t Divide(float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__)
+    return vdivq_f32(a, b);
+#else
+    float32x4_t inverse = vrecpeq_f32(b);
+    inverse = vmulq_f32(vrecpsq_f32(b, inverse), inverse);
+    inverse = vmulq_f32(vrecpsq_f32(b, inverse), inverse);
+    return vmulq_f32(a, inverse);
+#endif
+}
+
+void OneEuro(float* values, float* prev, float* prev_rate, int count,
+             const OneEuroParams& params) {
+    const float32x4_t inv_dt = vdupq_n_f32(params.inv_dt);
+    const float32x4_t two_pi_dt = vdupq_n_f32(params.two_pi_dt);
+    const float32x4_t derivative_alpha = vdupq_n_f32(params.derivative_alpha);
+    const float32x4_t min_cutoff = vdupq_n_f32(params.min_cutoff);
+    const float32x4_t beta = vdupq_n_f32(params.beta);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t p = vld1q_f32(prev + i);
+        const float32x4_t pr = vld1q_f32(prev_rate + i);
+        const float32x4_t delta = vsubq_f32(vld1q_f32(values + i), p);
+        const float32x4_t rate = vmlaq_f32(pr, derivative_alpha,
+                                           vsubq_f32(vmulq_f32(delta, inv_dt), pr));
+        const float32x4_t cutoff = vmlaq_f32(min_cutoff, beta, vabsq_f32(rate));
+        const float32x4_t r = vmulq_f32(two_pi_dt, cutoff);
+        const float32x4_t filtered = vmlaq_f32(p, Divide(r, vaddq_f32(r, one)), delta);
+        vst1q_f32(prev + i, filtered);
+        vst1q_f32(prev_rate + i, rate);
+        vst1q_f32(values + i, filtered);
+    }
+    OneEuroScalar(values, prev, prev_rate, i, count, params);
+}
+
+void Kalman(float* values, float* position, float* velocity, int count,
+            float dt, float gain_position, float gain_velocity) {
+    const float32x4_t step = vdupq_n_f32(dt);
+    const float32x4_t k0 = vdupq_n_f32(gain_position);
+    const float32x4_t k1 = vdupq_n_f32(gain_velocity);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t v = vld1q_f32(velocity + i);
+        const float32x4_t predicted = vmlaq_f32(vld1q_f32(position + i), v, step);
+        const float32x4_t innovation = vsubq_f32(vld1q_f32(values + i), predicted);
+        const float32x4_t p = vmlaq_f32(predicted, k0, innovation);
+        vst1q_f32(position + i, p);
+        vst1q_f32(velocity + i, vmlaq_f32(v, k1, innovation));
+        vst1q_f32(values + i, p);
+    }
+    KalmanScalar(values, position, velocity, i, count, dt, gain_position, gain_velocity);
+}
+
+#else
+
+void OneEuro(float* values, float* prev, float* prev_rate, int count,
+             const OneEuroParams& params) {
+    OneEuroScalar(values, prev, prev_rate, 0, count, params);
+}
+
+void Kalman(float* values, float* position, float* velocity, int count,
+            float dt, float gain_position, float gain_velocity) {
+    KalmanScalar(values, position, velocity, 0, count, dt, gain_position, gain_velocity);
+}
+
+#endif
+
+} // anonymous namespace
+
+LandmarkFilter::LandmarkFilter(const MPSmoothingConfig& config)
+    : filter_(config.filter),
+      min_cutoff_(OrDefault(config.min_cutoff, kDefaultMinCutoff)),
+      beta_(OrDefault(config.beta, kDefaultBeta)),
+      derivative_cutoff_(OrDefault(config.derivative_cutoff, kDefaultDerivativeCutoff)),
+      process_noise_(OrDefault(config.process_noise, kDefaultProcessNoise)),
+      measurement_noise_(OrDefault(config.measurement_noise, kDefaultMeasurementNoise)) {}
+
+void LandmarkFilter::Reset() {
+    for (SetState& state : sets_) {
+        state.count = 0;
+    }
+    last_timestamp_us_ = -1;
+}
+
+void LandmarkFilter::Apply(MPResults* results, int64_t timestamp_us) {
+    if (filter_ == MP_SMOOTHING_NONE) {
+        return;
+    }
+    if (last_timestamp_us_ >= 0 && timestamp_us <= last_timestamp_us_) {
+        return;
+    }
+    const float dt = last_timestamp_us_ < 0
+        ? 0.0f
+        : static_cast<float>(timestamp_us - last_timestamp_us_) * 1e-6f;
+    last_timestamp_us_ = timestamp_us;
+
+    ApplySet(&sets_[0], results->face_landmarks, results->face_planes,
+             results->face_count, dt);
+    ApplySet(&sets_[1], results->left_hand_landmarks, results->left_hand_planes,
+             results->left_hand_count, dt);
+    ApplySet(&sets_[2], results->right_hand_landmarks, results->right_hand_planes,
+             results->right_hand_count, dt);
+    ApplySet(&sets_[3], results->pose_landmarks, results->pose_planes,
+             results->pose_count, dt);
+    ApplySet(&sets_[4], results->pose_world_landmarks, results->pose_world_planes,
+             results->pose_world_count, dt);
+}
+
+void LandmarkFilter::ApplySet(SetState* state, MPLandmark* aos,
+                              const MPLandmarkPlanes& planes, int count, float dt) {
+    if (count <= 0 || (!aos && !planes.x)) {
+        state->count = 0;
+        return;
+    }
+
+    // x, y and z as three planes: the result's own with MP_LAYOUT_SOA,
+    // otherwise gathered from the MPLandmark structs
+    float* axes[3] = {planes.x, planes.y, planes.z};
+    if (aos) {
+        scratch_.resize(3 * static_cast<size_t>(count));
+        for (int c = 0; c < 3; ++c) {
+            axes[c] = scratch_.data() + c * count;
+        }
+        for (int i = 0; i < count; ++i) {
+            axes[0][i] = aos[i].x;
+            axes[1][i] = aos[i].y;
+            axes[2][i] = aos[i].z;
+        }
+    }
+
+    if (state->count != count || dt <= 0.0f) {
+        // (Re)acquired: start from the measurement, at rest
+        state->count = count;
+        state->value.resize(3 * static_cast<size_t>(count));
+        state->rate.assign(3 * static_cast<size_t>(count), 0.0f);
+        for (int c = 0; c < 3; ++c) {
+            std::copy(axes[c], axes[c] + count, state->value.data() + c * count);
+        }
+        state->p00 = measurement_noise_;
+        state->p01 = 0.0f;
+        state->p11 = kInitialVelocityVariance;
+        return;
+    }
+
+    float gain_position = 0.0f;
+    float gain_velocity = 0.0f;
+    if (filter_ == MP_SMOOTHING_KALMAN) {
+        // Predict with white-noise acceleration, then update with a
+        // position measurement
+        const float q = process_noise_;
+        state->p00 += dt * (2.0f * state->p01 + dt * state->p11) + q * dt * dt * dt / 3.0f;
+        state->p01 += dt * state->p11 + q * dt * dt / 2.0f;
+        state->p11 += q * dt;
+        const float innovation_variance = state->p00 + measurement_noise_;
+        gain_position = state->p00 / innovation_variance;
+        gain_velocity = state->p01 / innovation_variance;
+        state->p11 -= gain_velocity * state->p01;
+        state->p01 *= 1.0f - gain_position;
+        state->p00 *= 1.0f - gain_position;
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        FilterPlane(state, axes[c], c * count, count, dt, gain_position, gain_velocity);
+    }
+
+    if (aos) {
+        for (int i = 0; i < count; ++i) {
+            aos[i].x = axes[0][i];
+            aos[i].y = axes[1][i];
+            aos[i].z = axes[2][i];
+        }
+    }
+}
+
+void LandmarkFilter::FilterPlane(SetState* state, float* values, int offset, int count,
+                                 float dt, float gain_position, float gain_velocity) {
+    float* value = state->value.data() + offset;
+    float* rate = state->rate.data() + offset;
+    if (filter_ == MP_SMOOTHING_KALMAN) {
+        Kalman(values, value, rate, count, dt, gain_position, gain_velocity);
+        return;
+    }
+
+    OneEuroParams params;
+    params.inv_dt = 1.0f / dt;
+    params.two_pi_dt = kTwoPi * dt;
+    params.derivative_alpha = LowPassAlpha(derivative_cutoff_, dt);
+    params.min_cutoff = min_cutoff_;
+    params.beta = beta_;
+    OneEuro(values, value, rate, count, params);
+}
@@ -0,0 +1,61 @@
+// landmark_filter.h
+// Temporal smoothing of landmark coordinates across frames
+
+#ifndef LANDMARK_FILTER_H
+#define LANDMARK_FILTER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "mediapipe_bridge.h"
+
+// One-Euro or constant-velocity Kalman filter for every x, y and z value of
+// every landmark set in MPResults. Each coordinate is an independent scalar
+// filter, so a set is filtered as flat float arrays with SSE2 or NEON
+// kernels and a scalar tail. Works on both MP_LAYOUT_AOS and MP_LAYOUT_SOA
+// results; visibility and presence pass through unchanged.
+//
+// A set's state is reset whenever it is not detected or its landmark count
+// changes, so a re-acquired face or hand starts from its new position.
+// Not thread-safe: frames must be applied one at a time, in order.
+class LandmarkFilter {
+public:
+    // Zero parameters in `config` take their documented defaults
+    explicit LandmarkFilter(const MPSmoothingConfig& config);
+
+    // Smooth `results` in place. `timestamp_us` gives the time step; a frame
+    // that is not newer than the previous one passes through unfiltered.
+    void Apply(MPResults* results, int64_t timestamp_us);
+
+    void Reset();
+
+private:
+    struct SetState {
+        int count = 0;               // landmarks in the filtered set, 0 = uninitialized
+        std::vector<float> value;    // 3 * count filtered coordinates (x plane, y plane, z plane)
+        std::vector<float> rate;     // One-Euro: smoothed derivative; Kalman: velocity
+        // Kalman covariance; identical for every coordinate of the set
+        // because it does not depend on the measurements
+        float p00 = 0.0f;
+        float p01 = 0.0f;
+        float p11 = 0.0f;
+    };
+
+    void ApplySet(SetState* state, MPLandmark* aos, const MPLandmarkPlanes& planes,
+                  int count, float dt);
+    void FilterPlane(SetState* state, float* values, int offset, int count,
+                     float dt, float gain_position, float gain_velocity);
+
+    MPSmoothingFilter filter_;
+    float min_cutoff_;
+    float beta_;
+    float derivative_cutoff_;
+    float process_noise_;
+    float measurement_noise_;
+
+    SetState sets_[5];            // face, left hand, right hand, pose, pose world
+    std::vector<float> scratch_;  // AoS coordinates gathered into planes
+    int64_t last_timestamp_us_ = -1;
+};
+
+#endif // LANDMARK_FILTER_H
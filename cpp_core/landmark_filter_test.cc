@@ -0,0 +1,140 @@
+// landmark_filter_test.cc
+// Tests for LandmarkFilter
+
+#include "landmark_filter.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr int64_t kFrameUs = 33333;  // 30 fps
+
+MPSmoothingConfig Config(MPSmoothingFilter filter) {
+    MPSmoothingConfig config = {};
+    config.filter = filter;
+    return config;
+}
+
+// Results with a single AoS hand of `count` landmarks at (value, value, 0)
+struct Hand {
+    explicit Hand(int count, float value) : landmarks(count) {
+        for (MPLandmark& landmark : landmarks) {
+            landmark = {value, value, 0.0f, 0.9f, 0.8f};
+        }
+        results.left_hand_landmarks = landmarks.data();
+        results.left_hand_count = count;
+        results.hands_detected = true;
+    }
+
+    std::vector<MPLandmark> landmarks;
+    MPResults results = {};
+};
+
+// Every filter must pass the first frame through untouched
+TEST(LandmarkFilterTest, FirstFramePassesThrough) {
+    for (MPSmoothingFilter type : {MP_SMOOTHING_ONE_EURO, MP_SMOOTHING_KALMAN}) {
+        LandmarkFilter filter(Config(type));
+        Hand hand(MP_MAX_HAND_LANDMARKS, 0.25f);
+        filter.Apply(&hand.results, 0);
+        for (const MPLandmark& landmark : hand.landmarks) {
+            EXPECT_FLOAT_EQ(landmark.x, 0.25f);
+            EXPECT_FLOAT_EQ(landmark.y, 0.25f);
+        }
+    }
+}
+
+TEST(LandmarkFilterTest, SmoothsJump) {
+    for (MPSmoothingFilter type : {MP_SMOOTHING_ONE_EURO, MP_SMOOTHING_KALMAN}) {
+        LandmarkFilter filter(Config(type));
+        Hand first(MP_MAX_HAND_LANDMARKS, 0.2f);
+        filter.Apply(&first.results, 0);
+
+        Hand second(MP_MAX_HAND_LANDMARKS, 0.8f);
+        filter.Apply(&second.results, kFrameUs);
+        for (const MPLandmark& landmark : second.landmarks) {
+            EXPECT_GT(landmark.x, 0.2f);
+            EXPECT_LT(landmark.x, 0.8f);
+            // Scores are not filtered
+            EXPECT_FLOAT_EQ(landmark.visibility, 0.9f);
+            EXPECT_FLOAT_EQ(landmark.presence, 0.8f);
+        }
+    }
+}
+
+// A set whose landmark count changes is re-acquired at its new position
+TEST(LandmarkFilterTest, ResetsOnCountChange) {
+    LandmarkFilter filter(Config(MP_SMOOTHING_ONE_EURO));
+    Hand first(MP_MAX_HAND_LANDMARKS, 0.2f);
+    filter.Apply(&first.results, 0);
+
+    Hand fewer(MP_MAX_HAND_LANDMARKS - 1, 0.8f);
+    filter.Apply(&fewer.results, kFrameUs);
+    for (const MPLandmark& landmark : fewer.landmarks) {
+        EXPECT_FLOAT_EQ(landmark.x, 0.8f);
+    }
+}
+
+TEST(LandmarkFilterTest, ResetsWhenSetIsLost) {
+    LandmarkFilter filter(Config(MP_SMOOTHING_KALMAN));
+    Hand first(MP_MAX_HAND_LANDMARKS, 0.2f);
+    filter.Apply(&first.results, 0);
+
+    MPResults lost = {};
+    filter.Apply(&lost, kFrameUs);
+
+    Hand found(MP_MAX_HAND_LANDMARKS, 0.8f);
+    filter.Apply(&found.results, 2 * kFrameUs);
+    EXPECT_FLOAT_EQ(found.landmarks[0].x, 0.8f);
+}
+
+// Late frames, e.g. fetched after a newer one, are left alone
+TEST(LandmarkFilterTest, StaleFramePassesThrough) {
+    LandmarkFilter filter(Config(MP_SMOOTHING_ONE_EURO));
+    Hand first(MP_MAX_HAND_LANDMARKS, 0.2f);
+    filter.Apply(&first.results, kFrameUs);
+
+    Hand stale(MP_MAX_HAND_LANDMARKS, 0.8f);
+    filter.Apply(&stale.results, kFrameUs);
+    EXPECT_FLOAT_EQ(stale.landmarks[0].x, 0.8f);
+}
+
+// SoA planes go through the same kernels as gathered AoS coordinates
+TEST(LandmarkFilterTest, LayoutsAgree) {
+    constexpr int kCount = MP_MAX_POSE_LANDMARKS;
+    LandmarkFilter aos_filter(Config(MP_SMOOTHING_ONE_EURO));
+    LandmarkFilter soa_filter(Config(MP_SMOOTHING_ONE_EURO));
+
+    for (int frame = 0; frame < 4; ++frame) {
+        std::vector<MPLandmark> aos(kCount);
+        std::vector<float> planes(5 * kCount);
+        for (int i = 0; i < kCount; ++i) {
+            const float x = 0.1f * frame + 0.01f * i;
+            const float y = 0.5f - 0.05f * frame;
+            const float z = -0.02f * i;
+            aos[i] = {x, y, z, 1.0f, 1.0f};
+            planes[i] = x;
+            planes[kCount + i] = y;
+            planes[2 * kCount + i] = z;
+        }
+
+        MPResults aos_results = {};
+        aos_results.pose_landmarks = aos.data();
+        aos_results.pose_count = kCount;
+        MPResults soa_results = {};
+        soa_results.pose_planes = {&planes[0], &planes[kCount], &planes[2 * kCount],
+                                   &planes[3 * kCount], &planes[4 * kCount]};
+        soa_results.pose_count = kCount;
+
+        aos_filter.Apply(&aos_results, frame * kFrameUs);
+        soa_filter.Apply(&soa_results, frame * kFrameUs);
+        for (int i = 0; i < kCount; ++i) {
+            EXPECT_FLOAT_EQ(aos[i].x, planes[i]);
+            EXPECT_FLOAT_EQ(aos[i].y, planes[kCount + i]);
+            EXPECT_FLOAT_EQ(aos[i].z, planes[2 * kCount + i]);
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,127 @@
+// landmark_projection.cc
+// Compact landmark output: selected indices, optional scores, int16 values
+
+#include "landmark_projection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void WriteValue(float value, MPCompactFormat format, uint8_t** out) {
+    if (format == MP_COMPACT_INT16) {
+        const float scaled = std::nearbyint(value * MP_INT16_SCALE);
+        const int16_t quantized = static_cast<int16_t>(
+            scaled < -32768.0f ? -32768.0f : (scaled > 32767.0f ? 32767.0f : scaled));
+        memcpy(*out, &quantized, sizeof(quantized));
+        *out += sizeof(quantized);
+    } else {
+        memcpy(*out, &value, sizeof(value));
+        *out += sizeof(value);
+    }
+}
+
+} // anonymous namespace
+
+std::unique_ptr<LandmarkProjection> LandmarkProjection::Create(const MPOutputProjection& config) {
+    if (!config.face_index_count && !config.hand_index_count && !config.pose_index_count &&
+        !config.drop_scores && config.format == MP_COMPACT_FLOAT32) {
+        return nullptr;
+    }
+
+    auto make_part = [](const char* name, const int* indices, int count, int limit) {
+        Part part;
+        part.limit = limit;
+        if (count == 0) {
+            return part;
+        }
+        part.all = false;
+        if (count == MP_PROJECTION_NONE) {
+            return part;
+        }
+        if (count < 0 || count > limit || !indices) {
+            throw std::invalid_argument(std::string("Invalid ") + name + " projection");
+        }
+        for (int i = 0; i < count; ++i) {
+            if (indices[i] < 0 || indices[i] >= limit) {
+                throw std::invalid_argument(std::string(name) + " projection index " +
+                                            std::to_string(indices[i]) + " out of range");
+            }
+        }
+        part.indices.assign(indices, indices + count);
+        return part;
+    };
+
+    return std::unique_ptr<LandmarkProjection>(new LandmarkProjection(
+        config,
+        make_part("face", config.face_indices, config.face_index_count, MP_MAX_FACE_LANDMARKS),
+        make_part("hand", config.hand_indices, config.hand_index_count, MP_MAX_HAND_LANDMARKS),
+        make_part("pose", config.pose_indices, config.pose_index_count, MP_MAX_POSE_LANDMARKS)));
+}
+
+LandmarkProjection::LandmarkProjection(const MPOutputProjection& config,
+                                       Part face, Part hand, Part pose)
+    : face_(std::move(face)),
+      hand_(std::move(hand)),
+      pose_(std::move(pose)),
+      drop_scores_(config.drop_scores),
+      format_(config.format),
+      stride_((config.drop_scores ? 3 : 5) *
+              (config.format == MP_COMPACT_INT16 ? 2 : 4)) {}
+
+void LandmarkProjection::Apply(MPResults* results, uint8_t* storage) const {
+    uint8_t* out = storage;
+    out = PackSet(results->face_landmarks, results->face_planes,
+                  &results->face_count, face_, out);
+    out = PackSet(results->left_hand_landmarks, results->left_hand_planes,
+                  &results->left_hand_count, hand_, out);
+    out = PackSet(results->right_hand_landmarks, results->right_hand_planes,
+                  &results->right_hand_count, hand_, out);
+    out = PackSet(results->pose_landmarks, results->pose_planes,
+                  &results->pose_count, pose_, out);
+    PackSet(results->pose_world_landmarks, results->pose_world_planes,
+            &results->pose_world_count, pose_, out);
+
+    results->compact_landmarks = storage;
+    results->compact_stride = stride_;
+}
+
+uint8_t* LandmarkProjection::PackSet(const MPLandmark* aos, const MPLandmarkPlanes& planes,
+                                     int* count, const Part& part, uint8_t* out) const {
+    const int available = (aos || planes.x) ? std::min(*count, part.limit) : 0;
+    int kept = 0;
+    auto pack = [&](int i) {
+        MPLandmark lm = {};  // stays zero for an index the set lacks
+        if (i < available) {
+            lm = aos ? aos[i]
+                     : MPLandmark{planes.x[i], planes.y[i], planes.z[i],
+                                  planes.visibility[i], planes.presence[i]};
+        }
+        WriteValue(lm.x, format_, &out);
+        WriteValue(lm.y, format_, &out);
+        WriteValue(lm.z, format_, &out);
+        if (!drop_scores_) {
+            WriteValue(lm.visibility, format_, &out);
+            WriteValue(lm.presence, format_, &out);
+        }
+        ++kept;
+    };
+
+    if (part.all) {
+        for (int i = 0; i < available; ++i) {
+            pack(i);
+        }
+    } else if (available > 0) {
+        // Indices the detected set does not have (iris points without
+        // refinement) are written as zeros
+        for (int i : part.indices) {
+            pack(i);
+        }
+    }
+
+    *count = kept;
+    return out;
+}
@@ -0,0 +1,50 @@
+// landmark_projection.h
+// Compact landmark output: selected indices, optional scores, int16 values
+
+#ifndef LANDMARK_PROJECTION_H
+#define LANDMARK_PROJECTION_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mediapipe_bridge.h"
+
+// Packs the landmarks selected by an MPOutputProjection into one compact
+// block, so callers only copy what they consume
+class LandmarkProjection {
+public:
+    // Null when `config` asks for the full output. Throws
+    // std::invalid_argument for out-of-range indices.
+    static std::unique_ptr<LandmarkProjection> Create(const MPOutputProjection& config);
+
+    // Pack the selected landmarks of `results` (either layout) into
+    // `storage`, which holds MP_COMPACT_STORAGE_BYTES, and point
+    // `compact_landmarks` at it. Counts become the number of landmarks kept;
+    // the full arrays are left for the caller to release.
+    void Apply(MPResults* results, uint8_t* storage) const;
+
+    // Bytes per packed landmark
+    int stride() const { return stride_; }
+
+private:
+    struct Part {
+        bool all = true;           // every landmark, in order
+        std::vector<int> indices;  // otherwise these (empty = none)
+        int limit = 0;             // MP_MAX_*_LANDMARKS of the part
+    };
+
+    LandmarkProjection(const MPOutputProjection& config, Part face, Part hand, Part pose);
+
+    uint8_t* PackSet(const MPLandmark* aos, const MPLandmarkPlanes& planes, int* count,
+                     const Part& part, uint8_t* out) const;
+
+    Part face_;
+    Part hand_;
+    Part pose_;
+    bool drop_scores_;
+    MPCompactFormat format_;
+    int stride_;
+};
+
+#endif // LANDMARK_PROJECTION_H
@@ -0,0 +1,180 @@
+// landmark_projection_test.cc
+// Tests for LandmarkProjection
+
+#include "landmark_projection.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// Landmark `i` of a set is (i / 100, 2 * i / 100, -i / 100), scores 0.5, 0.25
+MPLandmark Synthetic(int i) {
+    return {i * 0.01f, i * 0.02f, -i * 0.01f, 0.5f, 0.25f};
+}
+
+struct Sets {
+    Sets() : face(MP_MAX_FACE_LANDMARKS), hand(MP_MAX_HAND_LANDMARKS),
+             pose(MP_MAX_POSE_LANDMARKS) {
+        for (size_t i = 0; i < face.size(); ++i) face[i] = Synthetic(static_cast<int>(i));
+        for (size_t i = 0; i < hand.size(); ++i) hand[i] = Synthetic(static_cast<int>(i));
+        for (size_t i = 0; i < pose.size(); ++i) pose[i] = Synthetic(static_cast<int>(i));
+        results.face_landmarks = face.data();
+        results.face_count = MP_MAX_FACE_LANDMARKS;
+        results.right_hand_landmarks = hand.data();
+        results.right_hand_count = MP_MAX_HAND_LANDMARKS;
+        results.pose_landmarks = pose.data();
+        results.pose_count = MP_MAX_POSE_LANDMARKS;
+    }
+
+    std::vector<MPLandmark> face;
+    std::vector<MPLandmark> hand;
+    std::vector<MPLandmark> pose;
+    MPResults results = {};
+};
+
+float FloatAt(const uint8_t* data, int index) {
+    float value;
+    memcpy(&value, data + index * sizeof(float), sizeof(value));
+    return value;
+}
+
+int16_t Int16At(const uint8_t* data, int index) {
+    int16_t value;
+    memcpy(&value, data + index * sizeof(int16_t), sizeof(value));
+    return value;
+}
+
+TEST(LandmarkProjectionTest, FullOutputNeedsNoProjection) {
+    EXPECT_EQ(LandmarkProjection::Create(MPOutputProjection{}), nullptr);
+}
+
+TEST(LandmarkProjectionTest, RejectsOutOfRangeIndex) {
+    const int indices[] = {0, MP_MAX_HAND_LANDMARKS};
+    MPOutputProjection config = {};
+    config.hand_indices = indices;
+    config.hand_index_count = 2;
+    EXPECT_THROW(LandmarkProjection::Create(config), std::invalid_argument);
+}
+
+// Sets are packed back to back in MPResults order; a missing set takes no room
+TEST(LandmarkProjectionTest, PacksSelectedIndices) {
+    const int face_indices[] = {1, 468, 4};
+    const int pose_indices[] = {32, 0};
+    MPOutputProjection config = {};
+    config.face_indices = face_indices;
+    config.face_index_count = 3;
+    config.hand_index_count = MP_PROJECTION_NONE;
+    config.pose_indices = pose_indices;
+    config.pose_index_count = 2;
+    config.drop_scores = true;
+    auto projection = LandmarkProjection::Create(config);
+    ASSERT_NE(projection, nullptr);
+    ASSERT_EQ(projection->stride(), 3 * 4);
+
+    Sets sets;
+    std::vector<uint8_t> storage(MP_COMPACT_STORAGE_BYTES);
+    projection->Apply(&sets.results, storage.data());
+
+    EXPECT_EQ(sets.results.compact_landmarks, storage.data());
+    EXPECT_EQ(sets.results.compact_stride, 12);
+    EXPECT_EQ(sets.results.face_count, 3);
+    EXPECT_EQ(sets.results.left_hand_count, 0);
+    EXPECT_EQ(sets.results.right_hand_count, 0);
+    EXPECT_EQ(sets.results.pose_count, 2);
+
+    const int expected[] = {1, 468, 4, 32, 0};
+    for (int slot = 0; slot < 5; ++slot) {
+        const MPLandmark landmark = Synthetic(expected[slot]);
+        EXPECT_FLOAT_EQ(FloatAt(storage.data(), 3 * slot + 0), landmark.x);
+        EXPECT_FLOAT_EQ(FloatAt(storage.data(), 3 * slot + 1), landmark.y);
+        EXPECT_FLOAT_EQ(FloatAt(storage.data(), 3 * slot + 2), landmark.z);
+    }
+}
+
+// Iris points requested from an unrefined 468-point mesh come out as zeros
+TEST(LandmarkProjectionTest, ZeroFillsIndicesTheSetLacks) {
+    const int face_indices[] = {468, 10};
+    MPOutputProjection config = {};
+    config.face_indices = face_indices;
+    config.face_index_count = 2;
+    auto projection = LandmarkProjection::Create(config);
+
+    Sets sets;
+    sets.results.face_count = 468;
+    std::vector<uint8_t> storage(MP_COMPACT_STORAGE_BYTES);
+    projection->Apply(&sets.results, storage.data());
+
+    ASSERT_EQ(sets.results.face_count, 2);
+    for (int value = 0; value < 5; ++value) {
+        EXPECT_FLOAT_EQ(FloatAt(storage.data(), value), 0.0f);
+    }
+    EXPECT_FLOAT_EQ(FloatAt(storage.data(), 5 + 0), Synthetic(10).x);
+    EXPECT_FLOAT_EQ(FloatAt(storage.data(), 5 + 3), 0.5f);
+    EXPECT_FLOAT_EQ(FloatAt(storage.data(), 5 + 4), 0.25f);
+}
+
+TEST(LandmarkProjectionTest, Int16RoundsAndSaturates) {
+    const int pose_indices[] = {0};
+    MPOutputProjection config = {};
+    config.face_index_count = MP_PROJECTION_NONE;
+    config.hand_index_count = MP_PROJECTION_NONE;
+    config.pose_indices = pose_indices;
+    config.pose_index_count = 1;
+    config.format = MP_COMPACT_INT16;
+    auto projection = LandmarkProjection::Create(config);
+    ASSERT_EQ(projection->stride(), 5 * 2);
+
+    MPLandmark pose = {0.5f, -0.25f, 3.0f, -7.5f, 1.0f / 65536.0f};
+    MPResults results = {};
+    results.pose_landmarks = &pose;
+    results.pose_count = 1;
+    std::vector<uint8_t> storage(MP_COMPACT_STORAGE_BYTES);
+    projection->Apply(&results, storage.data());
+
+    EXPECT_EQ(Int16At(storage.data(), 0), 8192);
+    EXPECT_EQ(Int16At(storage.data(), 1), -4096);
+    EXPECT_EQ(Int16At(storage.data(), 2), 32767);   // 3.0 is beyond [-2, 2)
+    EXPECT_EQ(Int16At(storage.data(), 3), -32768);
+    EXPECT_EQ(Int16At(storage.data(), 4), 0);       // rounds to nearest
+}
+
+TEST(LandmarkProjectionTest, AosAndSoaPackTheSame) {
+    MPOutputProjection config = {};
+    config.format = MP_COMPACT_INT16;
+    auto projection = LandmarkProjection::Create(config);
+
+    std::vector<MPLandmark> hand(MP_MAX_HAND_LANDMARKS);
+    std::vector<float> planes(5 * MP_MAX_HAND_LANDMARKS);
+    for (int i = 0; i < MP_MAX_HAND_LANDMARKS; ++i) {
+        const MPLandmark landmark = Synthetic(i);
+        hand[i] = landmark;
+        planes[i] = landmark.x;
+        planes[MP_MAX_HAND_LANDMARKS + i] = landmark.y;
+        planes[2 * MP_MAX_HAND_LANDMARKS + i] = landmark.z;
+        planes[3 * MP_MAX_HAND_LANDMARKS + i] = landmark.visibility;
+        planes[4 * MP_MAX_HAND_LANDMARKS + i] = landmark.presence;
+    }
+    MPResults soa = {};
+    soa.left_hand_planes = {&planes[0], &planes[MP_MAX_HAND_LANDMARKS],
+                            &planes[2 * MP_MAX_HAND_LANDMARKS],
+                            &planes[3 * MP_MAX_HAND_LANDMARKS],
+                            &planes[4 * MP_MAX_HAND_LANDMARKS]};
+    soa.left_hand_count = MP_MAX_HAND_LANDMARKS;
+    MPResults aos = {};
+    aos.left_hand_landmarks = hand.data();
+    aos.left_hand_count = MP_MAX_HAND_LANDMARKS;
+
+    std::vector<uint8_t> aos_storage(MP_COMPACT_STORAGE_BYTES);
+    std::vector<uint8_t> soa_storage(MP_COMPACT_STORAGE_BYTES);
+    projection->Apply(&aos, aos_storage.data());
+    projection->Apply(&soa, soa_storage.data());
+
+    const size_t bytes = MP_MAX_HAND_LANDMARKS * static_cast<size_t>(projection->stride());
+    EXPECT_EQ(memcmp(aos_storage.data(), soa_storage.data(), bytes), 0);
+}
+
+} // namespace
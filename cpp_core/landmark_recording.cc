@@ -0,0 +1,698 @@
+// landmark_recording.cc
+// Chunked, delta-encoded binary recordings of results streams
+//
+// File layout, little-endian:
+//   FileHeader
+//   chunks: ChunkHeader, then frame_count frames of varint fields
+//   IndexEntry per chunk, then IndexTrailer (absent if the recorder died)
+//
+// Values are quantized to fixed point and stored as zigzag varint deltas
+// from the same value in the previous frame, field by field within each
+// landmark set (all x, then all y, ...) so unchanged values form runs of
+// zero deltas, which take one token per run. Each chunk restarts from zero,
+// so it decodes on its own and seeking only decodes from a chunk start.
+
+#include "landmark_recording.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "shm_ring.h"
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x4352504Du;   // "MPRC"
+constexpr uint32_t kChunkMagic = 0x4B4E4843u;  // "CHNK"
+constexpr uint32_t kIndexMagic = 0x4952504Du;  // "MPRI"
+constexpr uint32_t kFormatVersion = 1;
+
+// Fixed-point steps: 1/16384 for coordinates (0.12 px across 1920 px, or
+// 0.06 mm), blendshapes and head pose; 1/1024 for visibility and presence
+constexpr float kFineScale = 16384.0f;
+constexpr float kScoreScale = 1024.0f;
+constexpr float kTimeScale = 100.0f;  // processing time, 10 us steps
+
+// Snapshots queued for the writer; frames beyond it are dropped
+constexpr size_t kQueueFrames = 64;
+
+// A chunk ends after this many frames or payload bytes
+constexpr uint32_t kChunkFrames = 120;
+constexpr size_t kChunkBytes = 1 << 20;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    float fine_scale;
+    float score_scale;
+    uint32_t values_per_frame;  // kRecordedValues
+    uint32_t reserved[3];
+};
+
+struct ChunkHeader {
+    uint32_t magic;
+    uint32_t frame_count;
+    uint32_t payload_bytes;
+    uint32_t reserved;
+    int64_t first_timestamp_us;
+    int64_t last_timestamp_us;
+};
+
+struct IndexEntry {
+    int64_t first_timestamp_us;
+    int64_t last_timestamp_us;
+    uint64_t offset;
+    uint32_t frame_count;
+    uint32_t reserved;
+};
+
+struct IndexTrailer {
+    uint64_t index_offset;
+    uint32_t chunk_count;
+    uint32_t magic;
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader layout");
+static_assert(sizeof(ChunkHeader) == 32, "ChunkHeader layout");
+static_assert(sizeof(IndexEntry) == 32, "IndexEntry layout");
+static_assert(sizeof(IndexTrailer) == 16, "IndexTrailer layout");
+
+// Where each landmark set's values start, in MPResults order
+constexpr int kSetCount = 5;
+constexpr int kPoseValues = MP_NUM_BLENDSHAPES + 4 + 3;
+constexpr int kSetCapacity[kSetCount] = {
+    MP_MAX_FACE_LANDMARKS, MP_MAX_HAND_LANDMARKS, MP_MAX_HAND_LANDMARKS,
+    MP_MAX_POSE_LANDMARKS, MP_MAX_POSE_LANDMARKS,
+};
+constexpr int kSetOffset[kSetCount] = {
+    kPoseValues,
+    kPoseValues + 5 * MP_MAX_FACE_LANDMARKS,
+    kPoseValues + 5 * (MP_MAX_FACE_LANDMARKS + MP_MAX_HAND_LANDMARKS),
+    kPoseValues + 5 * (MP_MAX_FACE_LANDMARKS + 2 * MP_MAX_HAND_LANDMARKS),
+    kPoseValues + 5 * (MP_MAX_FACE_LANDMARKS + 2 * MP_MAX_HAND_LANDMARKS + MP_MAX_POSE_LANDMARKS),
+};
+
+// MPShmFrame flags byte
+constexpr uint8_t kFaceDetected = 1 << 0;
+constexpr uint8_t kHandsDetected = 1 << 1;
+constexpr uint8_t kPoseDetected = 1 << 2;
+constexpr uint8_t kRefineFace = 1 << 3;
+constexpr uint8_t kPredicted = 1 << 4;  // MPResults::predicted
+
+int32_t Quantize(float value, float scale) {
+    const float scaled = value * scale;
+    if (!(std::fabs(scaled) < 1e9f)) {
+        return std::isnan(scaled) ? 0 : (scaled > 0 ? 1000000000 : -1000000000);
+    }
+    return static_cast<int32_t>(std::lrint(scaled));
+}
+
+void PutUnsigned(uint64_t value, std::vector<uint8_t>* out) {
+    while (value >= 0x80) {
+        out->push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out->push_back(static_cast<uint8_t>(value));
+}
+
+void PutSigned(int64_t value, std::vector<uint8_t>* out) {
+    PutUnsigned((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63), out);
+}
+
+bool GetUnsigned(const uint8_t** cursor, const uint8_t* end, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && *cursor < end; shift += 7) {
+        const uint8_t byte = *(*cursor)++;
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GetSigned(const uint8_t** cursor, const uint8_t* end, int64_t* value) {
+    uint64_t zigzag;
+    if (!GetUnsigned(cursor, end, &zigzag)) {
+        return false;
+    }
+    *value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    return true;
+}
+
+// Delta tokens: zigzag(delta) << 1 for a delta, run << 1 | 1 for `run`
+// zero deltas. Runs never cross frames.
+class DeltaWriter {
+public:
+    explicit DeltaWriter(std::vector<uint8_t>* out) : out_(out) {}
+
+    void Put(int64_t delta) {
+        if (delta == 0) {
+            ++run_;
+            return;
+        }
+        FlushRun();
+        PutUnsigned(((static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63)) << 1,
+                    out_);
+    }
+
+    // End of the frame
+    void Finish() { FlushRun(); }
+
+private:
+    void FlushRun() {
+        if (run_ > 1) {
+            PutUnsigned(run_ << 1 | 1, out_);
+        } else if (run_ == 1) {
+            PutUnsigned(0, out_);
+        }
+        run_ = 0;
+    }
+
+    std::vector<uint8_t>* out_;
+    uint64_t run_ = 0;
+};
+
+class DeltaReader {
+public:
+    DeltaReader(const uint8_t** cursor, const uint8_t* end) : cursor_(cursor), end_(end) {}
+
+    bool Get(int64_t* delta) {
+        if (run_ > 0) {
+            --run_;
+            *delta = 0;
+            return true;
+        }
+        uint64_t token;
+        if (!GetUnsigned(cursor_, end_, &token)) {
+            return false;
+        }
+        if (token & 1) {
+            run_ = (token >> 1) - 1;
+            *delta = 0;
+            return token > 1;
+        }
+        const uint64_t zigzag = token >> 1;
+        *delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        return true;
+    }
+
+    // Whether the frame ended on a token boundary
+    bool Done() const { return run_ == 0; }
+
+private:
+    const uint8_t** cursor_;
+    const uint8_t* end_;
+    uint64_t run_ = 0;
+};
+
+// The landmarks of set `set` in a snapshot
+const MPLandmark* SetLandmarks(const MPShmFrame& frame, int set) {
+    const MPLandmark* sets[kSetCount] = {
+        frame.face_landmarks, frame.left_hand_landmarks, frame.right_hand_landmarks,
+        frame.pose_landmarks, frame.pose_world_landmarks,
+    };
+    return sets[set];
+}
+
+int SetCount(const MPShmFrame& frame, int set) {
+    const int counts[kSetCount] = {
+        frame.face_count, frame.left_hand_count, frame.right_hand_count,
+        frame.pose_count, frame.pose_world_count,
+    };
+    return counts[set];
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Recorder
+// ============================================================================
+
+LandmarkRecorder::LandmarkRecorder(const std::string& path)
+    : file_(fopen(path.c_str(), "wb")), path_(path),
+      queue_(kQueueFrames), previous_(kRecordedValues, 0) {
+    if (!file_) {
+        throw std::runtime_error("Failed to create " + path + ": " + strerror(errno));
+    }
+    const FileHeader header = {kFileMagic, kFormatVersion, kFineScale, kScoreScale,
+                               kRecordedValues, {}};
+    Write(&header, sizeof(header));
+    writer_ = std::thread([this] { WriterLoop(); });
+}
+
+LandmarkRecorder::~LandmarkRecorder() {
+    std::string ignored;
+    Finish(&ignored);
+}
+
+void LandmarkRecorder::Append(const MPResults& results, int64_t timestamp_us,
+                              float processing_time_ms) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) {
+            return;
+        }
+        if (queue_size_ == queue_.size()) {
+            frames_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        QueuedFrame& queued = queue_[(queue_head_ + queue_size_) % queue_.size()];
+        SnapshotResults(results, timestamp_us, processing_time_ms, &queued.frame);
+        queued.predicted = results.predicted;
+        ++queue_size_;
+    }
+    cv_.notify_one();
+}
+
+bool LandmarkRecorder::Finish(std::string* message) {
+    if (!finished_) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        writer_.join();
+        finished_ = true;
+    }
+    if (!error_.empty()) {
+        *message = error_;
+        return false;
+    }
+    return true;
+}
+
+void LandmarkRecorder::WriterLoop() {
+    for (;;) {
+        const QueuedFrame* queued;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || queue_size_ > 0; });
+            if (queue_size_ == 0) {
+                break;
+            }
+            queued = &queue_[queue_head_];
+        }
+
+        // Append leaves the slot alone until it is popped below
+        Encode(*queued);
+        if (error_.empty()) {
+            frames_recorded_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_head_ = (queue_head_ + 1) % queue_.size();
+        --queue_size_;
+    }
+
+    FlushChunk();
+    const IndexTrailer trailer = {offset_, chunk_count_, kIndexMagic};
+    Write(index_.data(), index_.size());
+    Write(&trailer, sizeof(trailer));
+    if (fclose(file_) != 0 && error_.empty()) {
+        error_ = "Failed to write " + path_ + ": " + strerror(errno);
+    }
+    file_ = nullptr;
+}
+
+void LandmarkRecorder::Encode(const QueuedFrame& queued) {
+    const MPShmFrame& frame = queued.frame;
+    if (chunk_frames_ == 0) {
+        chunk_first_us_ = frame.timestamp_us;
+        previous_us_ = frame.timestamp_us;
+        std::fill(previous_.begin(), previous_.end(), 0);
+    }
+
+    PutSigned(frame.timestamp_us - previous_us_, &chunk_);
+    previous_us_ = frame.timestamp_us;
+    PutUnsigned(static_cast<uint64_t>(std::max(Quantize(frame.processing_time_ms, kTimeScale), 0)),
+                &chunk_);
+    chunk_.push_back((frame.face_detected ? kFaceDetected : 0) |
+                     (frame.hands_detected ? kHandsDetected : 0) |
+                     (frame.pose_detected ? kPoseDetected : 0) |
+                     (frame.refine_face_landmarks ? kRefineFace : 0) |
+                     (queued.predicted ? kPredicted : 0));
+    chunk_.push_back(static_cast<uint8_t>(frame.model_complexity));
+    for (int set = 0; set < kSetCount; ++set) {
+        PutUnsigned(static_cast<uint64_t>(SetCount(frame, set)), &chunk_);
+    }
+
+    DeltaWriter deltas(&chunk_);
+    auto put = [this, &deltas](int index, float value, float scale) {
+        const int32_t quantized = Quantize(value, scale);
+        deltas.Put(static_cast<int64_t>(quantized) - previous_[index]);
+        previous_[index] = quantized;
+    };
+    int index = 0;
+    for (float value : frame.blendshapes) {
+        put(index++, value, kFineScale);
+    }
+    for (float value : frame.head_rotation) {
+        put(index++, value, kFineScale);
+    }
+    for (float value : frame.head_translation) {
+        put(index++, value, kFineScale);
+    }
+    for (int set = 0; set < kSetCount; ++set) {
+        const MPLandmark* landmarks = SetLandmarks(frame, set);
+        const int count = SetCount(frame, set);
+        const int base = kSetOffset[set];
+        for (int i = 0; i < count; ++i) {
+            put(base + 5 * i + 0, landmarks[i].x, kFineScale);
+        }
+        for (int i = 0; i < count; ++i) {
+            put(base + 5 * i + 1, landmarks[i].y, kFineScale);
+        }
+        for (int i = 0; i < count; ++i) {
+            put(base + 5 * i + 2, landmarks[i].z, kFineScale);
+        }
+        for (int i = 0; i < count; ++i) {
+            put(base + 5 * i + 3, landmarks[i].visibility, kScoreScale);
+        }
+        for (int i = 0; i < count; ++i) {
+            put(base + 5 * i + 4, landmarks[i].presence, kScoreScale);
+        }
+    }
+    deltas.Finish();
+
+    if (++chunk_frames_ >= kChunkFrames || chunk_.size() >= kChunkBytes) {
+        FlushChunk();
+    }
+}
+
+void LandmarkRecorder::FlushChunk() {
+    if (chunk_frames_ == 0) {
+        return;
+    }
+    const ChunkHeader header = {kChunkMagic, chunk_frames_, static_cast<uint32_t>(chunk_.size()),
+                                0, chunk_first_us_, previous_us_};
+    const IndexEntry entry = {chunk_first_us_, previous_us_, offset_, chunk_frames_, 0};
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&entry);
+    index_.insert(index_.end(), bytes, bytes + sizeof(entry));
+    ++chunk_count_;
+    Write(&header, sizeof(header));
+    Write(chunk_.data(), chunk_.size());
+    chunk_.clear();
+    chunk_frames_ = 0;
+}
+
+void LandmarkRecorder::Write(const void* data, size_t size) {
+    if (!error_.empty() || size == 0) {
+        return;
+    }
+    if (fwrite(data, 1, size, file_) != size) {
+        error_ = "Failed to write " + path_ + ": " + strerror(errno);
+        return;
+    }
+    offset_ += size;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+std::unique_ptr<RecordingReader> RecordingReader::Open(const char* path, int* error,
+                                                       std::string* message) {
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        *error = 83;
+        *message = std::string("Failed to open ") + path + ": " + strerror(errno);
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        *error = 83;
+        *message = std::string("Failed to stat ") + path + ": " + strerror(errno);
+        close(fd);
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(info.st_size);
+    if (size < sizeof(FileHeader)) {
+        close(fd);
+        *error = 84;
+        *message = std::string(path) + " is not a recording";
+        return nullptr;
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        *error = 83;
+        *message = std::string("Failed to map ") + path + ": " + strerror(errno);
+        return nullptr;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    const auto* data = static_cast<const uint8_t*>(mapping);
+
+    FileHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != kFileMagic || header.version != kFormatVersion ||
+        header.fine_scale != kFineScale || header.score_scale != kScoreScale ||
+        header.values_per_frame != static_cast<uint32_t>(kRecordedValues)) {
+        munmap(mapping, size);
+        *error = 84;
+        *message = std::string(path) + " is not a recording of format version " +
+                   std::to_string(kFormatVersion);
+        return nullptr;
+    }
+
+    // A chunk header at `offset` whose payload ends by `limit`
+    auto read_chunk = [data](uint64_t offset, uint64_t limit, Chunk* chunk) {
+        ChunkHeader chunk_header;
+        if (offset < sizeof(FileHeader) || offset + sizeof(ChunkHeader) > limit) {
+            return false;
+        }
+        memcpy(&chunk_header, data + offset, sizeof(chunk_header));
+        if (chunk_header.magic != kChunkMagic ||
+            offset + sizeof(ChunkHeader) + chunk_header.payload_bytes > limit) {
+            return false;
+        }
+        *chunk = {chunk_header.first_timestamp_us, chunk_header.last_timestamp_us, offset,
+                  chunk_header.frame_count, chunk_header.payload_bytes};
+        return true;
+    };
+
+    // The index, if the recorder wrote one
+    std::vector<Chunk> chunks;
+    bool indexed = false;
+    IndexTrailer trailer = {};
+    if (size >= sizeof(FileHeader) + sizeof(IndexTrailer)) {
+        memcpy(&trailer, data + size - sizeof(trailer), sizeof(trailer));
+    }
+    if (trailer.magic == kIndexMagic && trailer.index_offset >= sizeof(FileHeader) &&
+        trailer.index_offset + uint64_t{trailer.chunk_count} * sizeof(IndexEntry) +
+            sizeof(trailer) == size) {
+        indexed = true;
+        for (uint32_t i = 0; i < trailer.chunk_count && indexed; ++i) {
+            IndexEntry entry;
+            memcpy(&entry, data + trailer.index_offset + i * sizeof(IndexEntry), sizeof(entry));
+            Chunk chunk;
+            indexed = read_chunk(entry.offset, trailer.index_offset, &chunk);
+            chunks.push_back(chunk);
+        }
+    }
+
+    // Otherwise every whole chunk, in file order
+    if (!indexed) {
+        chunks.clear();
+        uint64_t offset = sizeof(FileHeader);
+        Chunk chunk;
+        while (read_chunk(offset, size, &chunk)) {
+            chunks.push_back(chunk);
+            offset += sizeof(ChunkHeader) + chunk.payload_bytes;
+        }
+    }
+
+    return std::unique_ptr<RecordingReader>(
+        new RecordingReader(data, size, std::move(chunks), indexed));
+}
+
+RecordingReader::RecordingReader(const uint8_t* data, size_t size, std::vector<Chunk> chunks,
+                                 bool indexed)
+    : data_(data), size_(size), chunks_(std::move(chunks)), indexed_(indexed),
+      values_(kRecordedValues, 0) {
+    if (!chunks_.empty()) {
+        StartChunk(0);
+    }
+}
+
+RecordingReader::~RecordingReader() {
+    munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+void RecordingReader::GetInfo(MPRecordingInfo* info) const {
+    memset(info, 0, sizeof(MPRecordingInfo));
+    for (const Chunk& chunk : chunks_) {
+        info->frame_count += chunk.frame_count;
+    }
+    info->chunk_count = static_cast<int>(chunks_.size());
+    if (!chunks_.empty()) {
+        info->first_timestamp_us = chunks_.front().first_timestamp_us;
+        info->last_timestamp_us = chunks_.back().last_timestamp_us;
+    }
+    info->complete = indexed_;
+}
+
+int RecordingReader::Next(MPResultsBuffer* buffer) {
+    if (pending_) {
+        pending_ = false;
+        Emit(buffer);
+        return 1;
+    }
+    const int decoded = Decode();
+    if (decoded == 1) {
+        Emit(buffer);
+    }
+    return decoded;
+}
+
+bool RecordingReader::Seek(int64_t timestamp_us) {
+    pending_ = false;
+    if (chunks_.empty()) {
+        return true;
+    }
+    // The last chunk starting at or before the target
+    auto it = std::upper_bound(chunks_.begin(), chunks_.end(), timestamp_us,
+                               [](int64_t t, const Chunk& chunk) {
+                                   return t < chunk.first_timestamp_us;
+                               });
+    StartChunk(it == chunks_.begin() ? 0 : static_cast<size_t>(it - chunks_.begin()) - 1);
+    for (;;) {
+        const int decoded = Decode();
+        if (decoded <= 0) {
+            return decoded == 0;
+        }
+        if (timestamp_us_ >= timestamp_us) {
+            pending_ = true;
+            return true;
+        }
+    }
+}
+
+void RecordingReader::StartChunk(size_t chunk) {
+    chunk_ = chunk;
+    chunk_frame_ = 0;
+    cursor_ = data_ + chunks_[chunk].offset + sizeof(ChunkHeader);
+    chunk_end_ = cursor_ + chunks_[chunk].payload_bytes;
+    timestamp_us_ = chunks_[chunk].first_timestamp_us;
+    std::fill(values_.begin(), values_.end(), 0);
+}
+
+int RecordingReader::Decode() {
+    if (chunks_.empty()) {
+        return 0;
+    }
+    while (chunk_frame_ >= chunks_[chunk_].frame_count) {
+        if (chunk_ + 1 >= chunks_.size()) {
+            return 0;
+        }
+        StartChunk(chunk_ + 1);
+    }
+
+    int64_t delta;
+    uint64_t value;
+    if (!GetSigned(&cursor_, chunk_end_, &delta)) {
+        return -1;
+    }
+    timestamp_us_ += delta;
+    if (!GetUnsigned(&cursor_, chunk_end_, &value) || chunk_end_ - cursor_ < 2) {
+        return -1;
+    }
+    processing_time_ms_ = static_cast<float>(value) / kTimeScale;
+    flags_ = *cursor_++;
+    model_complexity_ = *cursor_++;
+    for (int set = 0; set < kSetCount; ++set) {
+        if (!GetUnsigned(&cursor_, chunk_end_, &value) ||
+            value > static_cast<uint64_t>(kSetCapacity[set])) {
+            return -1;
+        }
+        counts_[set] = static_cast<int>(value);
+    }
+
+    DeltaReader deltas(&cursor_, chunk_end_);
+    auto get = [this, &deltas, &delta](int index) {
+        if (!deltas.Get(&delta)) {
+            return false;
+        }
+        values_[index] = static_cast<int32_t>(values_[index] + delta);
+        return true;
+    };
+    for (int index = 0; index < kPoseValues; ++index) {
+        if (!get(index)) {
+            return -1;
+        }
+    }
+    for (int set = 0; set < kSetCount; ++set) {
+        for (int field = 0; field < 5; ++field) {
+            for (int i = 0; i < counts_[set]; ++i) {
+                if (!get(kSetOffset[set] + 5 * i + field)) {
+                    return -1;
+                }
+            }
+        }
+    }
+    if (!deltas.Done()) {
+        return -1;
+    }
+
+    ++chunk_frame_;
+    return 1;
+}
+
+void RecordingReader::Emit(MPResultsBuffer* buffer) const {
+    MPResults& results = buffer->results;
+    memset(&results, 0, sizeof(MPResults));
+    results.timestamp_us = timestamp_us_;
+    results.timestamp_ms = timestamp_us_ / 1000;
+    results.processing_time_ms = processing_time_ms_;
+    results.face_detected = flags_ & kFaceDetected;
+    results.hands_detected = flags_ & kHandsDetected;
+    results.pose_detected = flags_ & kPoseDetected;
+    results.refine_face_landmarks = flags_ & kRefineFace;
+    results.predicted = flags_ & kPredicted;
+    results.model_complexity = model_complexity_;
+
+    int index = 0;
+    for (float& value : results.blendshapes) {
+        value = values_[index++] / kFineScale;
+    }
+    for (float& value : results.head_rotation) {
+        value = values_[index++] / kFineScale;
+    }
+    for (float& value : results.head_translation) {
+        value = values_[index++] / kFineScale;
+    }
+
+    MPLandmark* storage[kSetCount] = {
+        buffer->face_storage, buffer->left_hand_storage, buffer->right_hand_storage,
+        buffer->pose_storage, buffer->pose_world_storage,
+    };
+    MPLandmark** landmarks[kSetCount] = {
+        &results.face_landmarks, &results.left_hand_landmarks, &results.right_hand_landmarks,
+        &results.pose_landmarks, &results.pose_world_landmarks,
+    };
+    int* counts[kSetCount] = {
+        &results.face_count, &results.left_hand_count, &results.right_hand_count,
+        &results.pose_count, &results.pose_world_count,
+    };
+    for (int set = 0; set < kSetCount; ++set) {
+        *counts[set] = counts_[set];
+        if (counts_[set] == 0) {
+            continue;
+        }
+        *landmarks[set] = storage[set];
+        for (int i = 0; i < counts_[set]; ++i) {
+            const int32_t* q = &values_[kSetOffset[set] + 5 * i];
+            storage[set][i] = {q[0] / kFineScale, q[1] / kFineScale, q[2] / kFineScale,
+                               q[3] / kScoreScale, q[4] / kScoreScale};
+        }
+    }
+}
@@ -0,0 +1,146 @@
+// landmark_recording.h
+// Chunked, delta-encoded binary recordings of results streams
+
+#ifndef LANDMARK_RECORDING_H
+#define LANDMARK_RECORDING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mediapipe_bridge.h"
+
+// Values delta-coded per frame: blendshapes, head pose, then x, y, z,
+// visibility, presence of every landmark set in MPResults order
+constexpr int kRecordedValues = MP_NUM_BLENDSHAPES + 4 + 3 +
+    5 * (MP_MAX_FACE_LANDMARKS + 2 * MP_MAX_HAND_LANDMARKS + 2 * MP_MAX_POSE_LANDMARKS);
+
+// Appends frames to a recording file. Append only snapshots the results;
+// encoding and file writes happen on a background thread.
+class LandmarkRecorder {
+public:
+    // Create `path` and start the writer thread. Throws std::runtime_error
+    // if the file cannot be created.
+    explicit LandmarkRecorder(const std::string& path);
+
+    // Finish() unless already done
+    ~LandmarkRecorder();
+
+    LandmarkRecorder(const LandmarkRecorder&) = delete;
+    LandmarkRecorder& operator=(const LandmarkRecorder&) = delete;
+
+    // Queue one frame of `results` (either layout). Never waits for the
+    // disk: the frame is dropped if the writer is a full queue behind.
+    void Append(const MPResults& results, int64_t timestamp_us, float processing_time_ms);
+
+    // Write out queued frames, the last chunk and the seek index, and close
+    // the file. False with `*message` if any write failed.
+    bool Finish(std::string* message);
+
+    uint64_t frames_recorded() const { return frames_recorded_.load(std::memory_order_relaxed); }
+    uint64_t frames_dropped() const { return frames_dropped_.load(std::memory_order_relaxed); }
+
+private:
+    // MPShmFrame has no room for the results' predicted flag
+    struct QueuedFrame {
+        MPShmFrame frame;
+        bool predicted;
+    };
+
+    void WriterLoop();
+    void Encode(const QueuedFrame& queued);
+    void FlushChunk();
+    void Write(const void* data, size_t size);
+
+    FILE* file_;
+    std::string path_;
+
+    // Snapshots waiting for the writer, a ring guarded by mutex_
+    std::vector<QueuedFrame> queue_;
+    size_t queue_head_ = 0;
+    size_t queue_size_ = 0;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread writer_;
+    bool finished_ = false;
+
+    // Writer thread only
+    std::vector<uint8_t> chunk_;
+    uint32_t chunk_frames_ = 0;
+    int64_t chunk_first_us_ = 0;
+    int64_t previous_us_ = 0;  // also the chunk's last timestamp
+    std::vector<int32_t> previous_;  // kRecordedValues, quantized
+    std::vector<uint8_t> index_;     // one entry per chunk, as written
+    uint32_t chunk_count_ = 0;
+    uint64_t offset_ = 0;
+    std::string error_;
+
+    std::atomic<uint64_t> frames_recorded_{0};
+    std::atomic<uint64_t> frames_dropped_{0};
+};
+
+// Replays a recording from a read-only mapping of the whole file
+class RecordingReader {
+public:
+    // Null with `*error` set to 83 (cannot open) or 84 (not a recording of
+    // this version), and `*message` describing it
+    static std::unique_ptr<RecordingReader> Open(const char* path, int* error,
+                                                 std::string* message);
+
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    void GetInfo(MPRecordingInfo* info) const;
+
+    // Decode the next frame into `buffer`: 1 if one was written, 0 at the
+    // end, -1 for a corrupt chunk
+    int Next(MPResultsBuffer* buffer);
+
+    // Make the next frame the first one at or after `timestamp_us`; false
+    // for a corrupt chunk
+    bool Seek(int64_t timestamp_us);
+
+private:
+    struct Chunk {
+        int64_t first_timestamp_us;
+        int64_t last_timestamp_us;
+        uint64_t offset;
+        uint32_t frame_count;
+        uint32_t payload_bytes;
+    };
+
+    RecordingReader(const uint8_t* data, size_t size, std::vector<Chunk> chunks, bool indexed);
+
+    void StartChunk(size_t chunk);
+    int Decode();  // 1, 0 at the end, -1 if corrupt
+    void Emit(MPResultsBuffer* buffer) const;
+
+    const uint8_t* const data_;
+    const size_t size_;
+    const std::vector<Chunk> chunks_;
+    const bool indexed_;  // false: index rebuilt by scanning a truncated file
+
+    // Decoder position and the state of the last decoded frame
+    size_t chunk_ = 0;
+    uint32_t chunk_frame_ = 0;
+    const uint8_t* cursor_ = nullptr;
+    const uint8_t* chunk_end_ = nullptr;
+    bool pending_ = false;  // decoded by Seek, not yet returned
+    int64_t timestamp_us_ = 0;
+    float processing_time_ms_ = 0.0f;
+    uint8_t flags_ = 0;
+    int model_complexity_ = 0;
+    int counts_[5] = {};
+    std::vector<int32_t> values_;  // kRecordedValues, quantized
+};
+
+#endif // LANDMARK_RECORDING_H
@@ -0,0 +1,253 @@
+// landmark_recording_test.cc
+// Tests for LandmarkRecorder and RecordingReader
+
+#include "landmark_recording.h"
+
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr int kFrames = 300;  // two full chunks of 120 and a partial one
+constexpr int kChunkFrames = 120;
+constexpr int64_t kStartUs = 1000000;
+constexpr int64_t kFrameUs = 16667;
+
+// Half a 1/16384 quantization step
+constexpr float kTolerance = 0.5f / 16384.0f + 1e-6f;
+
+std::string TempPath(const char* name) {
+    return testing::TempDir() + name;
+}
+
+float FaceX(int frame, int i) { return 0.5f + 0.1f * std::sin(frame * 0.05f + i); }
+float PoseX(int frame, int i) { return 0.3f + 0.01f * i + 0.002f * frame; }
+float Blendshape(int frame, int i) { return std::fmod(frame * 0.01f + i * 0.02f, 1.0f); }
+
+// Frame `f` of a synthetic stream: an AoS face, lost for the last ten
+// frames of every hundred, a SoA pose, and every third frame predicted
+class Stream {
+public:
+    Stream() : face_(MP_MAX_FACE_LANDMARKS), planes_(5 * MP_MAX_POSE_LANDMARKS) {}
+
+    const MPResults& Frame(int f) {
+        results_ = {};
+        for (int i = 0; i < MP_MAX_FACE_LANDMARKS; ++i) {
+            face_[i] = {FaceX(f, i), 0.4f + 0.001f * f, -0.02f * i / MP_MAX_FACE_LANDMARKS,
+                        0.0f, 0.0f};
+        }
+        results_.face_landmarks = face_.data();
+        results_.face_count = f % 100 < 90 ? MP_MAX_FACE_LANDMARKS : 0;
+        results_.face_detected = results_.face_count > 0;
+
+        constexpr int n = MP_MAX_POSE_LANDMARKS;
+        for (int i = 0; i < n; ++i) {
+            planes_[i] = PoseX(f, i);
+            planes_[n + i] = 0.6f;
+            planes_[2 * n + i] = 0.1f;
+            planes_[3 * n + i] = 0.95f;
+            planes_[4 * n + i] = 0.99f;
+        }
+        results_.pose_planes = {&planes_[0], &planes_[n], &planes_[2 * n], &planes_[3 * n],
+                                &planes_[4 * n]};
+        results_.pose_count = n;
+        results_.pose_detected = true;
+
+        for (int i = 0; i < MP_NUM_BLENDSHAPES; ++i) {
+            results_.blendshapes[i] = Blendshape(f, i);
+        }
+        results_.head_rotation[3] = 1.0f;
+        results_.head_translation[2] = 0.5f;
+        results_.model_complexity = 1;
+        results_.refine_face_landmarks = true;
+        results_.predicted = f % 3 == 2;
+        return results_;
+    }
+
+private:
+    std::vector<MPLandmark> face_;
+    std::vector<float> planes_;
+    MPResults results_;
+};
+
+// Record `kFrames` frames to `path`. Append drops frames once the writer
+// is a queue behind, so wait for it to keep the recording whole.
+void Record(const std::string& path) {
+    LandmarkRecorder recorder(path);
+    Stream stream;
+    for (int f = 0; f < kFrames; ++f) {
+        recorder.Append(stream.Frame(f), kStartUs + f * kFrameUs, 3.25f);
+        while (recorder.frames_recorded() < static_cast<uint64_t>(f + 1)) {
+            std::this_thread::yield();
+        }
+    }
+    std::string message;
+    ASSERT_TRUE(recorder.Finish(&message)) << message;
+    ASSERT_EQ(recorder.frames_recorded(), static_cast<uint64_t>(kFrames));
+    ASSERT_EQ(recorder.frames_dropped(), 0u);
+}
+
+std::unique_ptr<RecordingReader> Open(const std::string& path) {
+    int error = 0;
+    std::string message;
+    auto reader = RecordingReader::Open(path.c_str(), &error, &message);
+    EXPECT_NE(reader, nullptr) << error << ": " << message;
+    return reader;
+}
+
+int FrameOf(const MPResults& results) {
+    return static_cast<int>((results.timestamp_us - kStartUs) / kFrameUs);
+}
+
+class LandmarkRecordingTest : public testing::Test {
+protected:
+    void SetUp() override {
+        path_ = TempPath("landmark_recording_test.mprec");
+        Record(path_);
+    }
+
+    void TearDown() override { unlink(path_.c_str()); }
+
+    std::string path_;
+    MPResultsBuffer buffer_;
+};
+
+TEST_F(LandmarkRecordingTest, RoundTrip) {
+    auto reader = Open(path_);
+    ASSERT_NE(reader, nullptr);
+    MPRecordingInfo info;
+    reader->GetInfo(&info);
+    EXPECT_EQ(info.frame_count, kFrames);
+    EXPECT_EQ(info.chunk_count, 3);
+    EXPECT_EQ(info.first_timestamp_us, kStartUs);
+    EXPECT_EQ(info.last_timestamp_us, kStartUs + (kFrames - 1) * kFrameUs);
+    EXPECT_TRUE(info.complete);
+
+    int frames = 0;
+    while (reader->Next(&buffer_) == 1) {
+        const MPResults& results = buffer_.results;
+        const int f = frames++;
+        ASSERT_EQ(results.timestamp_us, kStartUs + f * kFrameUs);
+        EXPECT_FLOAT_EQ(results.processing_time_ms, 3.25f);
+        EXPECT_EQ(results.model_complexity, 1);
+        EXPECT_TRUE(results.refine_face_landmarks);
+        EXPECT_EQ(results.predicted, f % 3 == 2) << "frame " << f;
+
+        if (f % 100 < 90) {
+            ASSERT_EQ(results.face_count, MP_MAX_FACE_LANDMARKS);
+            ASSERT_NE(results.face_landmarks, nullptr);
+            EXPECT_TRUE(results.face_detected);
+            for (int i = 0; i < MP_MAX_FACE_LANDMARKS; ++i) {
+                EXPECT_NEAR(results.face_landmarks[i].x, FaceX(f, i), kTolerance);
+            }
+        } else {
+            EXPECT_EQ(results.face_count, 0);
+            EXPECT_EQ(results.face_landmarks, nullptr);
+            EXPECT_FALSE(results.face_detected);
+        }
+
+        // Recorded from planes, replayed as AoS
+        ASSERT_EQ(results.pose_count, MP_MAX_POSE_LANDMARKS);
+        ASSERT_NE(results.pose_landmarks, nullptr);
+        for (int i = 0; i < MP_MAX_POSE_LANDMARKS; ++i) {
+            EXPECT_NEAR(results.pose_landmarks[i].x, PoseX(f, i), kTolerance);
+        }
+        EXPECT_NEAR(results.pose_landmarks[0].visibility, 0.95f, 0.5f / 1024.0f);
+        EXPECT_EQ(results.left_hand_count, 0);
+
+        for (int i = 0; i < MP_NUM_BLENDSHAPES; ++i) {
+            EXPECT_NEAR(results.blendshapes[i], Blendshape(f, i), kTolerance);
+        }
+        EXPECT_FLOAT_EQ(results.head_rotation[3], 1.0f);
+        EXPECT_FLOAT_EQ(results.head_translation[2], 0.5f);
+    }
+    EXPECT_EQ(frames, kFrames);
+    EXPECT_EQ(reader->Next(&buffer_), 0);
+}
+
+TEST_F(LandmarkRecordingTest, SeekFindsFirstFrameAtOrAfter) {
+    auto reader = Open(path_);
+    ASSERT_NE(reader, nullptr);
+
+    // Mid-chunk, just before a frame
+    const int target = kChunkFrames + 50;
+    ASSERT_TRUE(reader->Seek(kStartUs + target * kFrameUs - 5));
+    ASSERT_EQ(reader->Next(&buffer_), 1);
+    EXPECT_EQ(FrameOf(buffer_.results), target);
+    EXPECT_NEAR(buffer_.results.pose_landmarks[3].x, PoseX(target, 3), kTolerance);
+    ASSERT_EQ(reader->Next(&buffer_), 1);
+    EXPECT_EQ(FrameOf(buffer_.results), target + 1);
+
+    // Exactly on a chunk's first frame, backwards
+    ASSERT_TRUE(reader->Seek(kStartUs + kChunkFrames * kFrameUs));
+    ASSERT_EQ(reader->Next(&buffer_), 1);
+    EXPECT_EQ(FrameOf(buffer_.results), kChunkFrames);
+    EXPECT_NEAR(buffer_.results.face_landmarks[7].x, FaceX(kChunkFrames, 7), kTolerance);
+
+    ASSERT_TRUE(reader->Seek(0));
+    ASSERT_EQ(reader->Next(&buffer_), 1);
+    EXPECT_EQ(buffer_.results.timestamp_us, kStartUs);
+
+    ASSERT_TRUE(reader->Seek(INT64_MAX));
+    EXPECT_EQ(reader->Next(&buffer_), 0);
+}
+
+// A recorder that died leaves no index; every whole chunk is still read
+TEST_F(LandmarkRecordingTest, RecoversTruncatedFile) {
+    FILE* file = fopen(path_.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fclose(file);
+    ASSERT_EQ(truncate(path_.c_str(), size / 2), 0);
+
+    auto reader = Open(path_);
+    ASSERT_NE(reader, nullptr);
+    MPRecordingInfo info;
+    reader->GetInfo(&info);
+    EXPECT_FALSE(info.complete);
+    EXPECT_GT(info.chunk_count, 0);
+    EXPECT_LT(info.chunk_count, 3);
+    EXPECT_EQ(info.frame_count, info.chunk_count * kChunkFrames);
+    EXPECT_EQ(info.last_timestamp_us, kStartUs + (info.frame_count - 1) * kFrameUs);
+
+    int frames = 0;
+    while (reader->Next(&buffer_) == 1) {
+        ASSERT_EQ(FrameOf(buffer_.results), frames);
+        EXPECT_NEAR(buffer_.results.blendshapes[5], Blendshape(frames, 5), kTolerance);
+        ++frames;
+    }
+    EXPECT_EQ(frames, info.frame_count);
+
+    ASSERT_TRUE(reader->Seek(kStartUs + 10 * kFrameUs));
+    ASSERT_EQ(reader->Next(&buffer_), 1);
+    EXPECT_EQ(FrameOf(buffer_.results), 10);
+}
+
+TEST(RecordingReaderTest, RejectsOtherFiles) {
+    int error = 0;
+    std::string message;
+    EXPECT_EQ(RecordingReader::Open(TempPath("missing.mprec").c_str(), &error, &message),
+              nullptr);
+    EXPECT_EQ(error, 83);
+
+    const std::string path = TempPath("not_a_recording.mprec");
+    FILE* file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    const char text[] = "definitely not a recording, but long enough to hold a header";
+    fwrite(text, 1, sizeof(text), file);
+    fclose(file);
+    EXPECT_EQ(RecordingReader::Open(path.c_str(), &error, &message), nullptr);
+    EXPECT_EQ(error, 84);
+    unlink(path.c_str());
+}
+
+} // namespace
@@ -2,85 +2,312 @@
 // Implementation of MediaPipe Holistic C wrapper
 
 #include "mediapipe_bridge.h"
+#include "complexity_governor.h"
+#include "face_solver.h"
+#include "frame_pool.h"
+#include "graph_executor.h"
+#include "holistic_config.h"
+#include "landmark_filter.h"
+#include "landmark_projection.h"
+#include "landmark_recording.h"
+#include "model_cache.h"
+#include "motion_gate.h"
+#include "pixel_convert.h"
+#include "roi_tracker.h"
+#include "shm_ring.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 // MediaPipe includes
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/port/status.h"
-#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/profiler/graph_profiler.h"
+#include "mediapipe/framework/resources_service.h"
+
+#ifdef MEDIAPIPE_GPU_ENABLED
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gl_texture_buffer.h"
+#include "mediapipe/gpu/gpu_buffer.h"
+#include "mediapipe/gpu/gpu_shared_data_internal.h"
+#endif
 
 // OpenCV for image handling
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 
-// Graph configuration (defined in holistic_config.cc)
-extern const char* kHolisticGraphConfig;
-
 namespace {
 
 // Thread-local error storage
 thread_local MPError g_last_error = {0, ""};
 
+// Most recent failure on one MPHandle, whichever thread made the call
+class ErrorSlot {
+public:
+    void Store(const MPError& error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = error;
+    }
+
+    MPError Load() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    MPError error_ = {0, ""};
+};
+
+// Where the API call running on this thread reports besides g_last_error:
+// the caller's MPError out-parameter and the handle's slot (either may be
+// null)
+struct ErrorTargets {
+    MPError* call = nullptr;
+    ErrorSlot* handle = nullptr;
+};
+thread_local ErrorTargets g_error_targets;
+
 void SetError(int code, const std::string& message) {
     g_last_error.code = code;
     strncpy(g_last_error.message, message.c_str(), sizeof(g_last_error.message) - 1);
     g_last_error.message[sizeof(g_last_error.message) - 1] = '\0';
+    if (g_error_targets.call) {
+        *g_error_targets.call = g_last_error;
+    }
+    if (g_error_targets.handle) {
+        g_error_targets.handle->Store(g_last_error);
+    }
 }
 
+// Success: only the thread's and the call's error are reset, since the
+// handle's slot may hold another thread's failure
 void ClearError() {
     g_last_error.code = 0;
     g_last_error.message[0] = '\0';
+    if (g_error_targets.call) {
+        *g_error_targets.call = g_last_error;
+    }
 }
 
-// Convert MediaPipe NormalizedLandmarkList to MPLandmark array
-MPLandmark* ConvertLandmarks(
-    const mediapipe::NormalizedLandmarkList& landmarks,
-    int* out_count
-) {
-    *out_count = landmarks.landmark_size();
-    if (*out_count == 0) {
-        return nullptr;
+// Routes SetError / ClearError for the duration of one API call, starting
+// the out-parameter as success
+class ErrorScope {
+public:
+    ErrorScope(MPError* call, ErrorSlot* handle) : saved_(g_error_targets) {
+        g_error_targets = {call, handle};
+        if (call) {
+            call->code = 0;
+            call->message[0] = '\0';
+        }
+    }
+
+    ~ErrorScope() { g_error_targets = saved_; }
+
+    ErrorScope(const ErrorScope&) = delete;
+    ErrorScope& operator=(const ErrorScope&) = delete;
+
+private:
+    const ErrorTargets saved_;
+};
+
+// Copy packed RGB24 pixels into `frame`, in one memcpy when its rows are
+// unpadded
+void CopyRgbPixels(const uint8_t* pixels, mediapipe::ImageFrame* frame) {
+    const size_t row_bytes = static_cast<size_t>(frame->Width()) * 3;
+    const size_t width_step = frame->WidthStep();
+    uint8_t* dst = frame->MutablePixelData();
+    if (width_step == row_bytes) {
+        memcpy(dst, pixels, row_bytes * frame->Height());
+        return;
+    }
+    for (int row = 0; row < frame->Height(); ++row) {
+        memcpy(dst + row * width_step, pixels + row * row_bytes, row_bytes);
+    }
+}
+
+// Value below which `quantile` of a profiler histogram's samples fall, in
+// milliseconds, taken at the upper edge of the bucket that crosses it
+float HistogramPercentile(const mediapipe::TimeHistogram& histogram, double quantile) {
+    int64_t samples = 0;
+    for (int i = 0; i < histogram.count_size(); ++i) {
+        samples += histogram.count(i);
+    }
+    if (samples == 0) {
+        return 0.0f;
+    }
+    const double target = quantile * samples;
+    int64_t seen = 0;
+    for (int i = 0; i < histogram.count_size(); ++i) {
+        seen += histogram.count(i);
+        if (seen >= target) {
+            return (i + 1) * histogram.interval_size_usec() / 1000.0f;
+        }
     }
+    return histogram.count_size() * histogram.interval_size_usec() / 1000.0f;
+}
+
+// Copy up to `capacity` landmarks from a MediaPipe (Normalized)LandmarkList
+// into `dst`. Returns the number of landmarks written.
+template <typename LandmarkListT>
+int CopyLandmarks(const LandmarkListT& landmarks, MPLandmark* dst, int capacity) {
+    const int count = std::min(landmarks.landmark_size(), capacity);
+    for (int i = 0; i < count; ++i) {
+        const auto& lm = landmarks.landmark(i);
+        dst[i].x = lm.x();
+        dst[i].y = lm.y();
+        dst[i].z = lm.z();
+        dst[i].visibility = lm.has_visibility() ? lm.visibility() : 1.0f;
+        dst[i].presence = lm.has_presence() ? lm.presence() : 1.0f;
+    }
+    return count;
+}
 
-    auto* result = new MPLandmark[*out_count];
-    for (int i = 0; i < *out_count; ++i) {
+// Copy up to `capacity` landmarks into SoA planes. Returns the number of
+// landmarks written.
+template <typename LandmarkListT>
+int CopyLandmarkPlanes(const LandmarkListT& landmarks, const MPLandmarkPlanes& dst, int capacity) {
+    const int count = std::min(landmarks.landmark_size(), capacity);
+    for (int i = 0; i < count; ++i) {
         const auto& lm = landmarks.landmark(i);
-        result[i].x = lm.x();
-        result[i].y = lm.y();
-        result[i].z = lm.z();
-        result[i].visibility = lm.has_visibility() ? lm.visibility() : 1.0f;
-        result[i].presence = lm.has_presence() ? lm.presence() : 1.0f;
+        dst.x[i] = lm.x();
+        dst.y[i] = lm.y();
+        dst.z[i] = lm.z();
+        dst.visibility[i] = lm.has_visibility() ? lm.visibility() : 1.0f;
+        dst.presence[i] = lm.has_presence() ? lm.presence() : 1.0f;
     }
-    return result;
+    return count;
 }
 
-// Convert MediaPipe LandmarkList (world coordinates) to MPLandmark array
-MPLandmark* ConvertWorldLandmarks(
-    const mediapipe::LandmarkList& landmarks,
+// Convert a MediaPipe (Normalized)LandmarkList to an MPLandmark array.
+// With `planes` set, landmarks go to those SoA planes instead and nothing
+// is returned. With `storage` set, landmarks are written into it (truncated
+// to `capacity`); otherwise a new array is allocated for MP_ReleaseResults.
+template <typename LandmarkListT>
+MPLandmark* ConvertLandmarks(
+    const LandmarkListT& landmarks,
+    const MPLandmarkPlanes* planes,
+    MPLandmark* storage,
+    int capacity,
     int* out_count
 ) {
-    *out_count = landmarks.landmark_size();
-    if (*out_count == 0) {
+    if (planes) {
+        *out_count = CopyLandmarkPlanes(landmarks, *planes, capacity);
         return nullptr;
     }
 
-    auto* result = new MPLandmark[*out_count];
-    for (int i = 0; i < *out_count; ++i) {
-        const auto& lm = landmarks.landmark(i);
-        result[i].x = lm.x();
-        result[i].y = lm.y();
-        result[i].z = lm.z();
-        result[i].visibility = lm.has_visibility() ? lm.visibility() : 1.0f;
-        result[i].presence = lm.has_presence() ? lm.presence() : 1.0f;
+    if (!storage) {
+        capacity = landmarks.landmark_size();
+        if (capacity == 0) {
+            *out_count = 0;
+            return nullptr;
+        }
+        storage = new MPLandmark[capacity];
     }
-    return result;
+
+    *out_count = CopyLandmarks(landmarks, storage, capacity);
+    return *out_count > 0 ? storage : nullptr;
+}
+
+// The reverse of ConvertLandmarks, for packets the bridge makes up itself
+template <typename LandmarkListT>
+mediapipe::Packet LandmarkPacket(const MPLandmark* landmarks, int count) {
+    LandmarkListT list;
+    for (int i = 0; i < count; ++i) {
+        auto* lm = list.add_landmark();
+        lm->set_x(landmarks[i].x);
+        lm->set_y(landmarks[i].y);
+        lm->set_z(landmarks[i].z);
+        lm->set_visibility(landmarks[i].visibility);
+        lm->set_presence(landmarks[i].presence);
+    }
+    return mediapipe::MakePacket<LandmarkListT>(std::move(list));
+}
+
+constexpr size_t kSoaBlockBytes = MP_SOA_BLOCK_FLOATS * sizeof(float);
+
+// The 64-byte aligned SoA block inside a results buffer
+float* SoaBlock(MPResultsBuffer* buffer) {
+    const auto address = reinterpret_cast<uintptr_t>(buffer->soa_storage);
+    return reinterpret_cast<float*>((address + 63) & ~static_cast<uintptr_t>(63));
+}
+
+// An SoA block for results released by MP_ReleaseResults
+float* AllocateSoaBlock() {
+    auto* block = static_cast<float*>(aligned_alloc(64, kSoaBlockBytes));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    memset(block, 0, kSoaBlockBytes);
+    return block;
+}
+
+// Point every set's planes into `block`: sets in MPResults order, each as
+// x, y, z, visibility, presence planes of the set's padded capacity
+void AssignPlanes(float* block, MPResults* results) {
+    auto assign = [&block](MPLandmarkPlanes* planes, int capacity) {
+        planes->x = block;
+        planes->y = block + capacity;
+        planes->z = block + 2 * capacity;
+        planes->visibility = block + 3 * capacity;
+        planes->presence = block + 4 * capacity;
+        block += 5 * capacity;
+    };
+    assign(&results->face_planes, MP_SOA_FACE_CAPACITY);
+    assign(&results->left_hand_planes, MP_SOA_HAND_CAPACITY);
+    assign(&results->right_hand_planes, MP_SOA_HAND_CAPACITY);
+    assign(&results->pose_planes, MP_SOA_POSE_CAPACITY);
+    assign(&results->pose_world_planes, MP_SOA_POSE_CAPACITY);
+}
+
+// Free the landmark arrays of results filled without a buffer
+void ReleaseLandmarkArrays(MPResults* results) {
+    delete[] results->face_landmarks;
+    delete[] results->left_hand_landmarks;
+    delete[] results->right_hand_landmarks;
+    delete[] results->pose_landmarks;
+    delete[] results->pose_world_landmarks;
+    free(results->face_planes.x);  // start of the whole SoA block
+}
+
+// Clear the full landmark arrays once only compact output remains
+void DetachLandmarkArrays(MPResults* results) {
+    results->face_landmarks = nullptr;
+    results->left_hand_landmarks = nullptr;
+    results->right_hand_landmarks = nullptr;
+    results->pose_landmarks = nullptr;
+    results->pose_world_landmarks = nullptr;
+    results->face_planes = {};
+    results->left_hand_planes = {};
+    results->right_hand_planes = {};
+    results->pose_planes = {};
+    results->pose_world_planes = {};
 }
 
 } // anonymous namespace
@@ -89,85 +316,307 @@ MPLandmark* ConvertWorldLandmarks(
 // Processor Implementation
 // ============================================================================
 
+// Graph output streams, in the order they are reported in MPResults
+enum OutputStream {
+    kFaceStream = 0,
+    kLeftHandStream,
+    kRightHandStream,
+    kPoseStream,
+    kPoseWorldStream,
+    kNumOutputStreams
+};
+
+const char* const kOutputStreamNames[kNumOutputStreams] = {
+    "face_landmarks",
+    "left_hand_landmarks",
+    "right_hand_landmarks",
+    "pose_landmarks",
+    "pose_world_landmarks",
+};
+
+// MPConfig::enabled_outputs bit for each output stream
+const uint32_t kOutputStreamMasks[kNumOutputStreams] = {
+    MP_OUTPUT_FACE,
+    MP_OUTPUT_LEFT_HAND,
+    MP_OUTPUT_RIGHT_HAND,
+    MP_OUTPUT_POSE,
+    MP_OUTPUT_POSE_WORLD,
+};
+
+// Completed async frames kept for MP_PollResults before the oldest is dropped
+constexpr size_t kMaxCompletedFrames = 64;
+
+// Recent end-to-end latencies kept for the MP_GetStats percentiles
+constexpr size_t kLatencyWindow = 1024;
+
+using SteadyTime = std::chrono::steady_clock::time_point;
+
+// SendFrame timestamp argument: stamp the frame with the current time
+constexpr int64_t kAutoTimestamp = -1;
+
+// SendFrame timestamp argument: the smallest timestamp still allowed
+constexpr int64_t kNextTimestamp = -2;
+
+// How often a blocking MP_Process re-checks the graph for errors
+constexpr auto kSyncWaitSlice = std::chrono::milliseconds(100);
+
+// MP_Warmup frames: the first runs detection from scratch, the later ones
+// run with the graph's previous-frame state in place
+constexpr int kWarmupFrames = 3;
+
+// A frame that has been sent into the graph. Output packets are collected
+// per stream until every stream has either produced a packet or advanced
+// its timestamp bound past the frame.
+struct PendingFrame {
+    int64_t timestamp = 0;
+    uint64_t user_tag = 0;
+    bool sync = false;  // a blocked MP_Process call is waiting for it
+    SteadyTime submit_time;
+    float aspect = 1.0f;  // camera frame height / width, for the head pose
+    InputRegion region;   // what of the camera frame was sent, with `roi`
+    RoiTracker* roi = nullptr;
+    int tier = 0;  // complexity tier of the graph it was sent to
+    bool predicted = false;  // packets extrapolated by the MotionGate, not the graph
+    uint32_t pending_streams = 0;  // bit per OutputStream still outstanding
+    mediapipe::Packet packets[kNumOutputStreams];
+};
+
+// A realtime frame waiting for the graph to have room
+struct MailboxFrame {
+    std::unique_ptr<mediapipe::ImageFrame> image;
+    uint64_t user_tag = 0;
+    SteadyTime submit_time;
+};
+
+// Signalled by the deleter of a borrowed input frame once the graph has
+// dropped its last reference to the caller's pixels
+struct InputRelease {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool released = false;
+
+    void Signal() {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+        cv.notify_all();
+    }
+};
+
 class MediaPipeProcessor {
 public:
-    explicit MediaPipeProcessor(const MPConfig* config)
-        : config_(*config), frame_count_(0) {
-        
-        // Parse graph configuration
-        mediapipe::CalculatorGraphConfig graph_config;
-        if (!mediapipe::ParseTextProto<mediapipe::CalculatorGraphConfig>(
-                kHolisticGraphConfig, &graph_config)) {
-            throw std::runtime_error("Failed to parse graph config");
-        }
-
-        // Initialize calculator graph
-        graph_ = std::make_unique<mediapipe::CalculatorGraph>();
-        auto status = graph_->Initialize(graph_config);
-        if (!status.ok()) {
-            throw std::runtime_error("Graph initialization failed: " + status.message());
+    // `graph_config` replaces the generated holistic graph when set
+    explicit MediaPipeProcessor(
+        const MPConfig* config,
+        std::shared_ptr<const mediapipe::CalculatorGraphConfig> graph_config = nullptr
+    ) : config_(*config), graph_config_(std::move(graph_config)),
+        last_timestamp_(-1), observed_streams_(0) {
+
+        // Enough input frames for every frame in flight, plus the one being
+        // filled and one the graph has not yet released (and in realtime
+        // mode the one waiting in the mailbox)
+        input_pool_ = FramePool::Create(config_.input_pool_size > 0
+            ? config_.input_pool_size
+            : std::max(config_.max_frames_in_flight, 1) + (config_.realtime_mode ? 3 : 2));
+
+        if (config_.smoothing.filter != MP_SMOOTHING_NONE) {
+            filter_ = std::make_unique<LandmarkFilter>(config_.smoothing);
+        }
+        projection_ = LandmarkProjection::Create(config_.projection);
+        if (RoiTracker::Enabled(config_.input_scaling)) {
+            roi_ = std::make_unique<RoiTracker>(config_.input_scaling,
+                                                config_.min_tracking_confidence);
+        }
+        config_.projection = MPOutputProjection{};  // index arrays are the caller's
+        shm_writer_ = ShmRingWriter::Create(config_.shm_publish);
+        config_.shm_publish = MPShmConfig{};  // so is the name
+        if (MotionGate::Enabled(config_.motion_gating)) {
+            gate_ = std::make_unique<MotionGate>(config_.motion_gating);
         }
 
-        // Start the graph
-        status = graph_->StartRun({});
-        if (!status.ok()) {
-            throw std::runtime_error("Failed to start graph: " + status.message());
+        // Graph configuration for this MPConfig, parsed once per process.
+        // Tiers only differ in their side packets, so they share it too.
+        if (!graph_config_) {
+            graph_config_ = SharedHolisticGraphConfig(config_);
+            if (!graph_config_) {
+                throw std::runtime_error("Failed to parse graph config");
+            }
+        }
+        if (!GraphHasStream(*graph_config_, "input_video")) {
+            throw std::runtime_error("Graph has no \"input_video\" input stream");
+        }
+        flow_limited_ = GraphHasStream(*graph_config_, "throttled_input_video");
+
+        // Every tier's graph runs on the same threads and model variants
+        executor_ = CreateGraphExecutor(config_.threading);
+        model_resources_ = std::make_shared<ModelResources>(config_.precision);
+
+        tiers_ = BuildComplexityTiers(config_);
+        if (tiers_.size() > 1) {
+            governor_ = std::make_unique<ComplexityGovernor>(
+                config_.adaptive_complexity, static_cast<int>(tiers_.size()));
+        }
+        active_tier_ = static_cast<int>(tiers_.size()) - 1;
+        requested_tier_ = active_tier_.load();
+        graphs_.resize(tiers_.size());
+        warm_failed_.assign(tiers_.size(), false);
+
+#ifdef MEDIAPIPE_GPU_ENABLED
+        // GL context and GPU resources shared by every GPU calculator. With a
+        // caller context, its textures can be fed to MP_ProcessTexture.
+        auto gpu_resources = config_.shared_gl_context
+            ? mediapipe::GpuResources::Create(
+                  static_cast<mediapipe::PlatformGlContext>(config_.shared_gl_context))
+            : mediapipe::GpuResources::Create();
+        if (!gpu_resources.ok()) {
+            throw std::runtime_error(
+                "GPU setup failed: " + std::string(gpu_resources.status().message()));
+        }
+        gpu_resources_ = *gpu_resources;
+        gpu_helper_.InitializeForTest(gpu_resources_.get());
+#endif
+
+        // Observe every enabled output stream, including timestamp bound
+        // updates, so frames for which a stream produces nothing still complete
+        const uint32_t enabled_outputs = ResolveEnabledOutputs(config_);
+        for (int stream = 0; stream < kNumOutputStreams; ++stream) {
+            if ((enabled_outputs & kOutputStreamMasks[stream]) &&
+                GraphHasStream(*graph_config_, kOutputStreamNames[stream])) {
+                observed_streams_ |= 1u << stream;
+            }
+        }
+        if (observed_streams_ == 0) {
+            throw std::runtime_error("Graph produces none of the enabled output streams");
+        }
+
+        graphs_[active_tier_] = StartGraph(active_tier_);
+
+        // Neighbouring tiers start in the background
+        if (governor_) {
+            warm_worker_ = std::thread([this] { WarmLoop(); });
+            RequestWarmup();
+        }
+
+        if (config_.realtime_mode) {
+            mailbox_worker_ = std::thread([this] { MailboxLoop(); });
         }
     }
 
     ~MediaPipeProcessor() {
-        if (graph_) {
-            auto status = graph_->CloseAllInputStreams();
-            if (status.ok()) {
-                graph_->WaitUntilDone();
+        if (warm_worker_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(warm_mutex_);
+                warm_stop_ = true;
+            }
+            warm_cv_.notify_all();
+            warm_worker_.join();
+        }
+
+        if (mailbox_worker_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mailbox_mutex_);
+                mailbox_stop_ = true;
+            }
+            mailbox_cv_.notify_all();
+            cv_.notify_all();
+            mailbox_worker_.join();
+            delete mailbox_.exchange(nullptr);
+        }
+
+        for (auto& graph : graphs_) {
+            if (graph && graph->CloseAllInputStreams().ok()) {
+                graph->WaitUntilDone();
             }
         }
     }
 
-    bool Process(const uint8_t* pixels, int width, int height, MPResults* results) {
-        if (!pixels || !results) {
+    // Failures of calls on this handle, for MP_GetLastError
+    ErrorSlot* errors() { return &errors_; }
+
+    // Process one frame and block until its results are available. With
+    // `buffer` set, landmarks are written into its preallocated storage;
+    // otherwise they are heap-allocated per call.
+    bool Process(
+        const uint8_t* pixels,
+        int width,
+        int height,
+        MPResults* results,
+        MPResultsBuffer* buffer = nullptr
+    ) {
+        if (!pixels || !results || width <= 0 || height <= 0) {
             SetError(1, "Invalid arguments");
             return false;
         }
 
+        // In borrowed mode the graph reads the caller's pixels directly, so
+        // this call must outlive every packet that references them
+        std::shared_ptr<InputRelease> release;
+
         try {
             // Clear previous results
             memset(results, 0, sizeof(MPResults));
             auto start = std::chrono::high_resolution_clock::now();
 
-            // Create OpenCV Mat from raw RGB data (no copy)
-            cv::Mat rgb_mat(height, width, CV_8UC3, const_cast<uint8_t*>(pixels));
-
-            // Convert to MediaPipe ImageFrame
-            auto image_frame = std::make_unique<mediapipe::ImageFrame>(
-                mediapipe::ImageFormat::SRGB,
-                width,
-                height,
-                width * 3,
-                const_cast<uint8_t*>(pixels),
-                [](uint8_t*) {} // No-op deleter (we don't own the memory)
-            );
-
-            // Create packet with timestamp
-            auto timestamp = mediapipe::Timestamp(frame_count_++);
-            auto packet = mediapipe::MakePacket<mediapipe::ImageFrame>(
-                std::move(*image_frame)).At(timestamp);
-
-            // Send to graph
-            auto status = graph_->AddPacketToInputStream("input_video", packet);
-            if (!status.ok()) {
-                SetError(2, "Failed to add packet: " + status.message());
-                return false;
+            if (gate_ && gate_->Skip(pixels, width, height, width * 3)) {
+                return Predict(width, height, kAutoTimestamp, start, results, buffer);
+            }
+
+            mediapipe::Packet packet;
+            if (config_.input_ownership == MP_INPUT_BORROWED) {
+                release = std::make_shared<InputRelease>();
+                packet = mediapipe::Adopt(new mediapipe::ImageFrame(
+                    mediapipe::ImageFormat::SRGB,
+                    width,
+                    height,
+                    width * 3,
+                    const_cast<uint8_t*>(pixels),
+                    [release](uint8_t*) { release->Signal(); }));
+            } else {
+                auto image_frame = input_pool_->Acquire(width, height);
+                CopyRgbPixels(pixels, image_frame.get());
+                packet = mediapipe::Adopt(image_frame.release());
+            }
+
+            // Send to graph and wait for every output stream to settle
+            int64_t timestamp = 0;
+            bool ok = SendImageFrame(std::move(packet), 0, /*sync=*/true, &timestamp) &&
+                      WaitAndFetch(timestamp, start, results, buffer);
+            if (release && !WaitForInputRelease(*release)) {
+                ok = false;
             }
+            return ok;
 
-            // Fetch results from output streams
-            FetchResults(results);
+        } catch (const std::exception& e) {
+            SetError(3, std::string("Processing error: ") + e.what());
+            if (release) {
+                WaitForInputRelease(*release);
+            }
+            return false;
+        }
+    }
+
+    // Queue one frame and return without waiting for inference. The pixels
+    // are copied, so the caller may reuse its buffer immediately. In
+    // realtime mode the frame replaces any frame still waiting for the graph.
+    bool Submit(const uint8_t* pixels, int width, int height, uint64_t user_tag) {
+        if (!pixels || width <= 0 || height <= 0) {
+            SetError(1, "Invalid arguments");
+            return false;
+        }
+
+        try {
+            auto image_frame = input_pool_->Acquire(width, height);
+            CopyRgbPixels(pixels, image_frame.get());
 
-            // Calculate processing time
-            auto end = std::chrono::high_resolution_clock::now();
-            results->processing_time_ms = 
-                std::chrono::duration<float, std::milli>(end - start).count();
-            results->timestamp_ms = timestamp.Value() / 1000;
+            if (config_.realtime_mode) {
+                PostToMailbox(std::move(image_frame), user_tag);
+                ClearError();
+                return true;
+            }
+
+            if (!SendImageFrame(mediapipe::Adopt(image_frame.release()),
+                                user_tag, /*sync=*/false, nullptr)) {
+                return false;
+            }
 
             ClearError();
             return true;
@@ -178,131 +627,2401 @@ public:
         }
     }
 
-private:
-    void FetchResults(MPResults* results) {
-        // Try to get face landmarks
-        mediapipe::Packet face_packet;
-        if (graph_->GetOutputStream("face_landmarks")->GetPacket(&face_packet)) {
-            const auto& face_landmarks = 
-                face_packet.Get<mediapipe::NormalizedLandmarkList>();
-            results->face_landmarks = ConvertLandmarks(
-                face_landmarks, &results->face_count);
-            results->face_detected = results->face_count > 0;
+    // Process a frame in any MPPixelFormat. Conversion to RGB24 (and the
+    // optional mirror) is done in one pass straight into the ImageFrame
+    // that is sent to the graph.
+    bool ProcessFrame(
+        const MPFrame& frame,
+        MPResults* results,
+        MPResultsBuffer* buffer,
+        int64_t capture_timestamp_us = kAutoTimestamp
+    ) {
+        if (!frame.pixels || frame.width <= 0 || frame.height <= 0) {
+            SetError(1, "Invalid arguments");
+            return false;
         }
 
-        // Try to get left hand landmarks
-        mediapipe::Packet left_hand_packet;
-        if (graph_->GetOutputStream("left_hand_landmarks")->GetPacket(&left_hand_packet)) {
-            const auto& left_hand_landmarks = 
-                left_hand_packet.Get<mediapipe::NormalizedLandmarkList>();
-            results->left_hand_landmarks = ConvertLandmarks(
-                left_hand_landmarks, &results->left_hand_count);
-            results->hands_detected = true;
-        }
+        try {
+            memset(results, 0, sizeof(MPResults));
+            auto start = std::chrono::high_resolution_clock::now();
 
-        // Try to get right hand landmarks
-        mediapipe::Packet right_hand_packet;
-        if (graph_->GetOutputStream("right_hand_landmarks")->GetPacket(&right_hand_packet)) {
-            const auto& right_hand_landmarks = 
-                right_hand_packet.Get<mediapipe::NormalizedLandmarkList>();
-            results->right_hand_landmarks = ConvertLandmarks(
-                right_hand_landmarks, &results->right_hand_count);
-            results->hands_detected = true;
-        }
+            auto image_frame = input_pool_->Acquire(frame.width, frame.height);
+            if (!ConvertFrameToRgb(frame, image_frame->MutablePixelData(),
+                                   image_frame->WidthStep())) {
+                SetError(1, "Invalid frame description or undecodable MJPEG data");
+                return false;
+            }
+            if (gate_ && gate_->Skip(image_frame->PixelData(), frame.width, frame.height,
+                                     image_frame->WidthStep())) {
+                return Predict(frame.width, frame.height, capture_timestamp_us, start,
+                               results, buffer);
+            }
 
-        // Try to get pose landmarks
-        mediapipe::Packet pose_packet;
-        if (graph_->GetOutputStream("pose_landmarks")->GetPacket(&pose_packet)) {
-            const auto& pose_landmarks = 
-                pose_packet.Get<mediapipe::NormalizedLandmarkList>();
-            results->pose_landmarks = ConvertLandmarks(
-                pose_landmarks, &results->pose_count);
-            results->pose_detected = results->pose_count > 0;
-        }
+            int64_t timestamp = 0;
+            if (!SendImageFrame(mediapipe::Adopt(image_frame.release()),
+                                0, /*sync=*/true, &timestamp, capture_timestamp_us)) {
+                return false;
+            }
+            return WaitAndFetch(timestamp, start, results, buffer);
 
-        // Try to get pose world landmarks (3D in meters)
-        mediapipe::Packet pose_world_packet;
-        if (graph_->GetOutputStream("pose_world_landmarks")->GetPacket(&pose_world_packet)) {
-            const auto& pose_world_landmarks = 
-                pose_world_packet.Get<mediapipe::LandmarkList>();
-            results->pose_world_landmarks = ConvertWorldLandmarks(
-                pose_world_landmarks, &results->pose_world_count);
+        } catch (const std::exception& e) {
+            SetError(3, std::string("Processing error: ") + e.what());
+            return false;
         }
     }
 
-    MPConfig config_;
-    std::unique_ptr<mediapipe::CalculatorGraph> graph_;
-    int64_t frame_count_;
-};
+    // Process `count` frames, keeping up to a window of them in the graph
+    // while the next ones are converted. Returns the number of leading
+    // frames whose results were written. `capture_timestamps_us` may be
+    // null to stamp frames at submission.
+    int ProcessBatch(const MPFrame* frames, int count,
+                     const int64_t* capture_timestamps_us, MPResultsBuffer* results) {
+        // With a flow limiter, more than max_frames_in_flight would be dropped
+        int window = input_pool_->depth();
+        if (flow_limited_) {
+            window = std::min(window, std::max(config_.max_frames_in_flight, 1));
+        }
 
-// ============================================================================
-// C API Implementation
-// ============================================================================
+        struct Sent {
+            int64_t timestamp;
+            std::chrono::high_resolution_clock::time_point start;
+        };
+        std::deque<Sent> outstanding;
+        int done = 0;
+        bool failed = false;
+        std::string error_message;
+        int error_code = 0;
 
-MPHandle MP_Create(const MPConfig* config) {
-    if (!config) {
-        SetError(10, "Config is null");
-        return nullptr;
-    }
+        auto fail = [&](int code, const std::string& message) {
+            failed = true;
+            error_code = code;
+            error_message = message;
+        };
 
-    try {
-        auto* processor = new MediaPipeProcessor(config);
-        ClearError();
-        return static_cast<MPHandle>(processor);
-    } catch (const std::exception& e) {
-        SetError(11, std::string("Creation failed: ") + e.what());
-        return nullptr;
-    }
-}
+        for (int i = 0; i < count && !failed; ++i) {
+            const MPFrame& frame = frames[i];
+            const int64_t capture_timestamp_us =
+                capture_timestamps_us ? capture_timestamps_us[i] : kAutoTimestamp;
+            if (!frame.pixels || frame.width <= 0 || frame.height <= 0 ||
+                (capture_timestamps_us && capture_timestamp_us < 0)) {
+                fail(1, "Invalid arguments");
+                break;
+            }
 
-bool MP_Process(
-    MPHandle handle,
-    const uint8_t* pixels,
-    int width,
-    int height,
-    MPResults* results
-) {
-    if (!handle) {
-        SetError(20, "Invalid handle");
-        return false;
-    }
+            try {
+                auto start = std::chrono::high_resolution_clock::now();
+                auto image_frame = input_pool_->Acquire(frame.width, frame.height);
+                if (!ConvertFrameToRgb(frame, image_frame->MutablePixelData(),
+                                       image_frame->WidthStep())) {
+                    fail(1, "Invalid frame description or undecodable MJPEG data");
+                    break;
+                }
 
-    auto* processor = static_cast<MediaPipeProcessor*>(handle);
-    return processor->Process(pixels, width, height, results);
-}
+                int64_t timestamp = 0;
+                if (!SendImageFrame(mediapipe::Adopt(image_frame.release()),
+                                    0, /*sync=*/true, &timestamp, capture_timestamp_us)) {
+                    fail(g_last_error.code, g_last_error.message);
+                    break;
+                }
+                outstanding.push_back({timestamp, start});
+            } catch (const std::exception& e) {
+                fail(3, std::string("Processing error: ") + e.what());
+                break;
+            }
 
-void MP_ReleaseResults(MPResults* results) {
-    if (!results) return;
+            if (static_cast<int>(outstanding.size()) >= window) {
+                const Sent sent = outstanding.front();
+                outstanding.pop_front();
+                MPResultsBuffer* buffer = &results[done];
+                memset(&buffer->results, 0, sizeof(MPResults));
+                if (!WaitAndFetch(sent.timestamp, sent.start, &buffer->results, buffer)) {
+                    fail(g_last_error.code, g_last_error.message);
+                    break;
+                }
+                ++done;
+            }
+        }
 
-    delete[] results->face_landmarks;
-    delete[] results->left_hand_landmarks;
-    delete[] results->right_hand_landmarks;
-    delete[] results->pose_landmarks;
-    delete[] results->pose_world_landmarks;
+        // Drain the rest; after a failure their results are discarded, but
+        // they must still leave the in-flight table
+        while (!outstanding.empty()) {
+            const Sent sent = outstanding.front();
+            outstanding.pop_front();
+            if (failed) {
+                PendingFrame discarded;
+                WaitForFrame(sent.timestamp, &discarded);
+                continue;
+            }
+            MPResultsBuffer* buffer = &results[done];
+            memset(&buffer->results, 0, sizeof(MPResults));
+            if (!WaitAndFetch(sent.timestamp, sent.start, &buffer->results, buffer)) {
+                fail(g_last_error.code, g_last_error.message);
+                continue;
+            }
+            ++done;
+        }
 
-    memset(results, 0, sizeof(MPResults));
-}
+        if (failed) {
+            SetError(error_code, error_message);
+        } else {
+            ClearError();
+        }
+        return done;
+    }
 
-MPError MP_GetLastError(MPHandle handle) {
-    (void)handle; // Unused - we use thread-local storage
-    return g_last_error;
-}
+    // Run kWarmupFrames neutral frames of `width` x `height` through the
+    // active graph, so kernels, arenas and shaders that are set up on first
+    // use are ready for the first real frame. The results are dropped
+    // unseen by smoothing, ROI tracking, the governor and latency stats.
+    // They take the lowest free timestamps (0-2 on a new handle), which
+    // leaves any later capture timestamp usable.
+    bool Warmup(int width, int height) {
+        if (width <= 0 || height <= 0) {
+            SetError(1, "Invalid arguments");
+            return false;
+        }
 
-void MP_Destroy(MPHandle handle) {
-    if (handle) {
-        auto* processor = static_cast<MediaPipeProcessor*>(handle);
-        delete processor;
+        try {
+            for (int i = 0; i < kWarmupFrames; ++i) {
+                auto image_frame = input_pool_->Acquire(width, height);
+                memset(image_frame->MutablePixelData(), 128,
+                       static_cast<size_t>(image_frame->WidthStep()) * height);
+
+                int64_t timestamp = 0;
+                if (!SendImageFrame(mediapipe::Adopt(image_frame.release()),
+                                    0, /*sync=*/true, &timestamp, kNextTimestamp)) {
+                    return false;
+                }
+                PendingFrame discarded;
+                if (!WaitForFrame(timestamp, &discarded)) {
+                    return false;
+                }
+            }
+            ClearError();
+            return true;
+
+        } catch (const std::exception& e) {
+            SetError(3, std::string("Warm-up error: ") + e.what());
+            return false;
+        }
     }
-}
 
-const char* MP_GetVersion(void) {
-    return "MediaPipe Bridge v1.0.0";
-}
+    // Process an RGB frame the caller has already prepared, such as one
+    // converted by a ProcessorPool at submission time. `stream_filter` and
+    // `stream_roi` replace the processor's own smoothing and ROI state.
+    bool ProcessImage(
+        std::unique_ptr<mediapipe::ImageFrame> image_frame,
+        MPResults* results,
+        MPResultsBuffer* buffer,
+        LandmarkFilter* stream_filter = nullptr,
+        RoiTracker* stream_roi = nullptr
+    ) {
+        try {
+            memset(results, 0, sizeof(MPResults));
+            auto start = std::chrono::high_resolution_clock::now();
 
-bool MP_IsGPUAvailable(void) {
+            int64_t timestamp = 0;
+            if (!SendImageFrame(mediapipe::Adopt(image_frame.release()),
+                                0, /*sync=*/true, &timestamp, kAutoTimestamp,
+                                SteadyTime(), stream_roi)) {
+                return false;
+            }
+            return WaitAndFetch(timestamp, start, results, buffer, stream_filter);
+
+        } catch (const std::exception& e) {
+            SetError(3, std::string("Processing error: ") + e.what());
+            return false;
+        }
+    }
+
+    bool StartRecording(const char* path) {
+        std::lock_guard<std::mutex> lock(recorder_mutex_);
+        if (recorder_) {
+            SetError(80, "Already recording");
+            return false;
+        }
+        try {
+            recorder_ = std::make_shared<LandmarkRecorder>(path);
+        } catch (const std::exception& e) {
+            SetError(81, std::string("Recording failed: ") + e.what());
+            return false;
+        }
+        ClearError();
+        return true;
+    }
+
+    bool StopRecording() {
+        std::shared_ptr<LandmarkRecorder> recorder;
+        {
+            std::lock_guard<std::mutex> lock(recorder_mutex_);
+            recorder.swap(recorder_);
+        }
+        if (!recorder) {
+            SetError(80, "Not recording");
+            return false;
+        }
+        // Drained outside the lock so frames keep completing meanwhile
+        std::string message;
+        if (!recorder->Finish(&message)) {
+            SetError(82, "Recording failed: " + message);
+            return false;
+        }
+        ClearError();
+        return true;
+    }
+
+    void GetStats(MPStats* stats) {
+        memset(stats, 0, sizeof(MPStats));
+        stats->frames_submitted = frames_submitted_.load(std::memory_order_relaxed);
+        stats->frames_completed = frames_completed_.load(std::memory_order_relaxed);
+        const uint64_t admitted = frames_admitted_.load(std::memory_order_relaxed);
+        if (flow_limited_ && stats->frames_completed > admitted) {
+            stats->frames_dropped = stats->frames_completed - admitted;
+        }
+        stats->frames_superseded = frames_superseded_.load(std::memory_order_relaxed);
+        stats->input_pool_misses = input_pool_->misses();
+        stats->frames_cropped = frames_cropped_.load(std::memory_order_relaxed);
+        stats->tier_switches = tier_switches_.load(std::memory_order_relaxed);
+        const ComplexityTier& tier = tiers_[active_tier_.load(std::memory_order_relaxed)];
+        stats->model_complexity = tier.model_complexity;
+        stats->refine_face_landmarks = tier.refine_face_landmarks;
+        const ModelCacheStats models = GetModelCacheStats();
+        stats->mapped_models = models.files;
+        stats->mapped_model_bytes = models.bytes;
+        stats->precision = model_resources_->precision();
+        stats->variant_models = model_resources_->variant_models();
+        stats->fallback_models = model_resources_->fallback_models();
+        {
+            std::lock_guard<std::mutex> lock(recorder_mutex_);
+            if (recorder_) {
+                stats->frames_recorded = recorder_->frames_recorded();
+                stats->frames_record_dropped = recorder_->frames_dropped();
+            }
+        }
+        stats->frames_predicted = frames_predicted_.load(std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats->frames_in_flight = static_cast<int>(in_flight_.size());
+            stats->results_queued = static_cast<int>(completed_.size());
+        }
+
+        std::vector<float> latencies;
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            const size_t count = std::min(latency_count_, kLatencyWindow);
+            latencies.assign(latencies_.begin(), latencies_.begin() + count);
+        }
+        if (!latencies.empty()) {
+            std::sort(latencies.begin(), latencies.end());
+            auto percentile = [&latencies](double quantile) {
+                const size_t index = static_cast<size_t>(quantile * (latencies.size() - 1));
+                return latencies[index];
+            };
+            stats->latency_p50_ms = percentile(0.50);
+            stats->latency_p95_ms = percentile(0.95);
+            stats->latency_p99_ms = percentile(0.99);
+        }
+
+        // Profiles cover the active tier's graph
+        auto graph = Graph(active_tier_.load(std::memory_order_relaxed));
+        if (!config_.enable_profiling || !graph || !graph->profiler()) {
+            return;
+        }
+        std::vector<mediapipe::CalculatorProfile> profiles;
+        if (!graph->profiler()->GetCalculatorProfiles(&profiles).ok()) {
+            return;
+        }
+
+        // Bottlenecks first
+        std::sort(profiles.begin(), profiles.end(),
+                  [](const mediapipe::CalculatorProfile& a,
+                     const mediapipe::CalculatorProfile& b) {
+                      return a.process_runtime().total() > b.process_runtime().total();
+                  });
+        const int count = std::min(static_cast<int>(profiles.size()), MP_MAX_CALCULATOR_STATS);
+        for (int i = 0; i < count; ++i) {
+            const auto& runtime = profiles[i].process_runtime();
+            MPCalculatorStats& out = stats->calculators[i];
+            strncpy(out.name, profiles[i].name().c_str(), sizeof(out.name) - 1);
+            for (int bucket = 0; bucket < runtime.count_size(); ++bucket) {
+                out.invocations += runtime.count(bucket);
+            }
+            out.mean_ms = out.invocations > 0
+                ? runtime.total() / 1000.0f / out.invocations
+                : 0.0f;
+            out.p50_ms = HistogramPercentile(runtime, 0.50);
+            out.p95_ms = HistogramPercentile(runtime, 0.95);
+            out.p99_ms = HistogramPercentile(runtime, 0.99);
+        }
+        stats->calculator_count = count;
+    }
+
+    // A graph that reported an error never recovers
+    bool HasGraphError() {
+        std::lock_guard<std::mutex> lock(graphs_mutex_);
+        for (const auto& graph : graphs_) {
+            if (graph && graph->HasError()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+#ifdef MEDIAPIPE_GPU_ENABLED
+    // Process a caller-owned GL texture without a round trip through host
+    // memory and block until its results are available
+    bool ProcessTexture(GLuint texture, int width, int height, MPResultsBuffer* buffer) {
+        if (texture == 0 || width <= 0 || height <= 0 || !buffer) {
+            SetError(1, "Invalid arguments");
+            return false;
+        }
+
+        try {
+            memset(&buffer->results, 0, sizeof(MPResults));
+            auto start = std::chrono::high_resolution_clock::now();
+
+            // The caller keeps ownership; nothing to do when MediaPipe drops it
+            auto gpu_frame = WrapTexture(texture, width, height, [](mediapipe::GlSyncToken) {});
+
+            int64_t timestamp = 0;
+            if (!SendFrame(mediapipe::MakePacket<mediapipe::GpuBuffer>(std::move(gpu_frame)),
+                           0, /*sync=*/true, &timestamp)) {
+                return false;
+            }
+            return WaitAndFetch(timestamp, start, &buffer->results, buffer);
+
+        } catch (const std::exception& e) {
+            SetError(3, std::string("Processing error: ") + e.what());
+            return false;
+        }
+    }
+
+    // Import a single-plane DMA-BUF (e.g. from V4L2 or a compositor) as an
+    // EGLImage-backed texture and process it like ProcessTexture
+    bool ProcessDmaBuf(
+        int fd,
+        int width,
+        int height,
+        int stride,
+        uint32_t drm_fourcc,
+        MPResultsBuffer* buffer
+    ) {
+        if (fd < 0 || width <= 0 || height <= 0 || stride <= 0 || !buffer) {
+            SetError(1, "Invalid arguments");
+            return false;
+        }
+
+        auto create_image = reinterpret_cast<PFNEGLCREATEIMAGEKHRPROC>(
+            eglGetProcAddress("eglCreateImageKHR"));
+        auto destroy_image = reinterpret_cast<PFNEGLDESTROYIMAGEKHRPROC>(
+            eglGetProcAddress("eglDestroyImageKHR"));
+        auto image_target_texture = reinterpret_cast<PFNGLEGLIMAGETARGETTEXTURE2DOESPROC>(
+            eglGetProcAddress("glEGLImageTargetTexture2DOES"));
+        if (!create_image || !destroy_image || !image_target_texture) {
+            SetError(51, "EGL DMA-BUF import is not supported by this driver");
+            return false;
+        }
+
+        auto gl_context = gpu_resources_->gl_context();
+        EGLImageKHR image = EGL_NO_IMAGE_KHR;
+        GLuint texture = 0;
+        auto status = gl_context->Run([&]() -> absl::Status {
+            const EGLint attribs[] = {
+                EGL_WIDTH, width,
+                EGL_HEIGHT, height,
+                EGL_LINUX_DRM_FOURCC_EXT, static_cast<EGLint>(drm_fourcc),
+                EGL_DMA_BUF_PLANE0_FD_EXT, fd,
+                EGL_DMA_BUF_PLANE0_OFFSET_EXT, 0,
+                EGL_DMA_BUF_PLANE0_PITCH_EXT, stride,
+                EGL_NONE,
+            };
+            image = create_image(gl_context->egl_display(), EGL_NO_CONTEXT,
+                                 EGL_LINUX_DMA_BUF_EXT, nullptr, attribs);
+            if (image == EGL_NO_IMAGE_KHR) {
+                return absl::InternalError("eglCreateImageKHR failed");
+            }
+
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            image_target_texture(GL_TEXTURE_2D, image);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            return absl::OkStatus();
+        });
+        if (!status.ok()) {
+            SetError(52, "DMA-BUF import failed: " + std::string(status.message()));
+            return false;
+        }
+
+        try {
+            memset(&buffer->results, 0, sizeof(MPResults));
+            auto start = std::chrono::high_resolution_clock::now();
+
+            // The imported texture lives until the last GPU reader is done
+            auto gpu_frame = WrapTexture(texture, width, height,
+                [gl_context, texture, image, destroy_image](mediapipe::GlSyncToken sync_token) {
+                    gl_context->RunWithoutWaiting([=]() {
+                        if (sync_token) {
+                            sync_token->Wait();
+                        }
+                        glDeleteTextures(1, &texture);
+                        destroy_image(gl_context->egl_display(), image);
+                    });
+                });
+
+            int64_t timestamp = 0;
+            if (!SendFrame(mediapipe::MakePacket<mediapipe::GpuBuffer>(std::move(gpu_frame)),
+                           0, /*sync=*/true, &timestamp)) {
+                return false;
+            }
+            return WaitAndFetch(timestamp, start, &buffer->results, buffer);
+
+        } catch (const std::exception& e) {
+            SetError(3, std::string("Processing error: ") + e.what());
+            return false;
+        }
+    }
+#endif
+
+    // Deliver completed async frames to `callback` on the graph's output
+    // thread instead of the poll queue. Pass NULL to go back to polling.
+    void SetResultCallback(MP_ResultCallback callback, void* user_data) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback_ = callback;
+        callback_user_data_ = user_data;
+    }
+
+    // Pop the oldest completed async frame into `buffer`.
+    // Returns 1 on success, 0 if nothing completed within `timeout_ms`.
+    int Poll(MPResultsBuffer* buffer, uint64_t* user_tag, int timeout_ms) {
+        PendingFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto has_result = [this] { return !completed_.empty(); };
+            if (timeout_ms < 0) {
+                cv_.wait(lock, has_result);
+            } else if (!cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                     has_result)) {
+                return 0;
+            }
+            frame = std::move(completed_.front());
+            completed_.pop_front();
+        }
+
+        DeliverFrame(frame, &buffer->results, buffer);
+        if (user_tag) {
+            *user_tag = frame.user_tag;
+        }
+        return 1;
+    }
+
+private:
+    // Send a CPU ImageFrame packet, cropped and downscaled first when
+    // MPConfig::input_scaling (or `stream_roi`) asks for it. GPU graphs take
+    // GpuBuffer input, so in GPU builds the frame is uploaded to a texture.
+    bool SendImageFrame(
+        mediapipe::Packet image_packet,
+        uint64_t user_tag,
+        bool sync,
+        int64_t* out_timestamp,
+        int64_t capture_timestamp_us = kAutoTimestamp,
+        SteadyTime submit_time = SteadyTime(),
+        RoiTracker* stream_roi = nullptr
+    ) {
+        InputRegion region;
+        RoiTracker* roi = stream_roi ? stream_roi : roi_.get();
+        if (roi) {
+            image_packet = ScaleInput(std::move(image_packet), roi, &region);
+        }
+
+#ifdef MEDIAPIPE_GPU_ENABLED
+        bool sent = false;
+        auto status = gpu_helper_.RunInGlContext([&]() -> absl::Status {
+            auto texture = gpu_helper_.CreateSourceTexture(
+                image_packet.Get<mediapipe::ImageFrame>());
+            auto gpu_frame = texture.GetFrame<mediapipe::GpuBuffer>();
+            glFlush();
+            texture.Release();
+            sent = SendFrame(mediapipe::Adopt(gpu_frame.release()),
+                             user_tag, sync, out_timestamp, capture_timestamp_us,
+                             submit_time, region, roi);
+            return absl::OkStatus();
+        });
+        if (!status.ok()) {
+            SetError(2, "Failed to upload frame: " + std::string(status.message()));
+            return false;
+        }
+        return sent;
+#else
+        return SendFrame(std::move(image_packet), user_tag, sync, out_timestamp,
+                         capture_timestamp_us, submit_time, region, roi);
+#endif
+    }
+
+    // Resample a CPU frame into the region and size `roi` plans for it. A
+    // borrowed input is released as soon as this returns.
+    mediapipe::Packet ScaleInput(mediapipe::Packet packet, RoiTracker* roi, InputRegion* region) {
+        const auto& input = packet.Get<mediapipe::ImageFrame>();
+        *region = roi->Plan(input.Width(), input.Height());
+        if (!region->resampled()) {
+            return packet;
+        }
+
+        auto scaled = input_pool_->Acquire(region->scaled_width, region->scaled_height);
+        ScaleRgb(input.PixelData() + static_cast<size_t>(region->y) * input.WidthStep() +
+                     region->x * 3,
+                 input.WidthStep(), region->width, region->height,
+                 scaled->MutablePixelData(), scaled->WidthStep(),
+                 region->scaled_width, region->scaled_height);
+        if (region->cropped()) {
+            frames_cropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return mediapipe::Adopt(scaled.release());
+    }
+
+#ifdef MEDIAPIPE_GPU_ENABLED
+    // Present an existing RGBA texture to MediaPipe as a GpuBuffer
+    mediapipe::GpuBuffer WrapTexture(
+        GLuint texture,
+        int width,
+        int height,
+        mediapipe::GlTextureBuffer::DeletionCallback deletion_callback
+    ) {
+        auto texture_buffer = mediapipe::GlTextureBuffer::Wrap(
+            GL_TEXTURE_2D, texture, width, height,
+            mediapipe::GpuBufferFormat::kBGRA32, std::move(deletion_callback));
+        if (!texture_buffer) {
+            throw std::runtime_error("Failed to wrap texture");
+        }
+        return mediapipe::GpuBuffer(std::move(texture_buffer));
+    }
+#endif
+
+    // Wait for a synchronously sent frame and convert its results.
+    // `stream_filter` replaces the processor's own smoothing state.
+    bool WaitAndFetch(
+        int64_t timestamp,
+        std::chrono::high_resolution_clock::time_point start,
+        MPResults* results,
+        MPResultsBuffer* buffer,
+        LandmarkFilter* stream_filter = nullptr
+    ) {
+        PendingFrame frame;
+        if (!WaitForFrame(timestamp, &frame)) {
+            return false;
+        }
+
+        // Convert collected output packets
+        FetchResults(frame, results, buffer, stream_filter);
+
+        // Calculate processing time
+        auto end = std::chrono::high_resolution_clock::now();
+        results->processing_time_ms = 
+            std::chrono::duration<float, std::milli>(end - start).count();
+        results->timestamp_ms = timestamp / 1000;
+        results->timestamp_us = timestamp;
+        RecordLatency(results->processing_time_ms, frame.tier);
+
+        ClearError();
+        return true;
+    }
+
+    // Answer a frame the MotionGate skipped. The extrapolated landmarks take
+    // a timestamp as a sent frame would and go through the same smoothing,
+    // outputs and projection, but stay out of the latency window that
+    // drives the governor.
+    bool Predict(
+        int width,
+        int height,
+        int64_t capture_timestamp_us,
+        std::chrono::high_resolution_clock::time_point start,
+        MPResults* results,
+        MPResultsBuffer* buffer
+    ) {
+        PendingFrame frame;
+        {
+            std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+            if (!AssignTimestamp(capture_timestamp_us, &frame.timestamp)) {
+                return false;
+            }
+        }
+        frame.sync = true;
+        frame.submit_time = std::chrono::steady_clock::now();
+        frame.aspect = static_cast<float>(height) / width;
+        frame.tier = active_tier_.load(std::memory_order_relaxed);
+        frame.predicted = true;
+
+        auto prediction = std::make_unique<MPShmFrame>();
+        gate_->Predict(frame.timestamp, prediction.get());
+        const struct {
+            int stream;
+            const MPLandmark* landmarks;
+            int count;
+        } sets[] = {
+            {kFaceStream, prediction->face_landmarks, prediction->face_count},
+            {kLeftHandStream, prediction->left_hand_landmarks, prediction->left_hand_count},
+            {kRightHandStream, prediction->right_hand_landmarks, prediction->right_hand_count},
+            {kPoseStream, prediction->pose_landmarks, prediction->pose_count},
+        };
+        for (const auto& set : sets) {
+            if (set.count > 0) {
+                frame.packets[set.stream] = LandmarkPacket<mediapipe::NormalizedLandmarkList>(
+                    set.landmarks, set.count);
+            }
+        }
+        if (prediction->pose_world_count > 0) {
+            frame.packets[kPoseWorldStream] = LandmarkPacket<mediapipe::LandmarkList>(
+                prediction->pose_world_landmarks, prediction->pose_world_count);
+        }
+
+        FetchResults(frame, results, buffer);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        results->processing_time_ms =
+            std::chrono::duration<float, std::milli>(end - start).count();
+        results->timestamp_ms = frame.timestamp / 1000;
+        results->timestamp_us = frame.timestamp;
+        frames_predicted_.fetch_add(1, std::memory_order_relaxed);
+
+        ClearError();
+        return true;
+    }
+
+    // Assign the frame's timestamp, register the frame and push it into the
+    // graph. Timestamp assignment and submission are serialized so packets
+    // always enter the graph in timestamp order.
+    //
+    // Graph timestamps are microseconds: the caller's capture time, or with
+    // kAutoTimestamp the steady clock at submission, so smoothing and
+    // tracking calculators see the real interval between frames.
+    // `submit_time` (default: now) is when the caller handed over the frame;
+    // async latency is measured from it. `region` describes a packet that
+    // `roi` cropped or scaled.
+    bool SendFrame(
+        mediapipe::Packet image_packet,
+        uint64_t user_tag,
+        bool sync,
+        int64_t* out_timestamp,
+        int64_t capture_timestamp_us = kAutoTimestamp,
+        SteadyTime submit_time = SteadyTime(),
+        const InputRegion& region = InputRegion(),
+        RoiTracker* roi = nullptr
+    ) {
+        std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+        ApplyRequestedTier();
+        const int tier = active_tier_.load(std::memory_order_relaxed);
+        auto graph = Graph(tier);
+
+        int64_t timestamp = 0;
+        if (!AssignTimestamp(capture_timestamp_us, &timestamp)) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            PendingFrame& frame = in_flight_[timestamp];
+            frame.timestamp = timestamp;
+            frame.user_tag = user_tag;
+            frame.sync = sync;
+            frame.pending_streams = observed_streams_;
+            frame.aspect = region.frame_width > 0
+                ? static_cast<float>(region.frame_height) / region.frame_width
+                : InputAspect(image_packet);
+            frame.region = region;
+            frame.roi = roi;
+            frame.tier = tier;
+            frame.submit_time = submit_time == SteadyTime()
+                ? std::chrono::steady_clock::now()
+                : submit_time;
+        }
+
+        auto status = graph->AddPacketToInputStream(
+            "input_video", image_packet.At(mediapipe::Timestamp(timestamp)));
+        if (!status.ok()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            in_flight_.erase(timestamp);
+            SetError(2, "Failed to add packet: " + std::string(status.message()));
+            return false;
+        }
+
+        frames_submitted_.fetch_add(1, std::memory_order_relaxed);
+        if (out_timestamp) {
+            *out_timestamp = timestamp;
+        }
+        return true;
+    }
+
+    // Resolve `capture_timestamp_us` (or kAutoTimestamp / kNextTimestamp)
+    // to the next graph timestamp. Called under submit_mutex_.
+    bool AssignTimestamp(int64_t capture_timestamp_us, int64_t* timestamp) {
+        *timestamp = capture_timestamp_us;
+        if (capture_timestamp_us == kAutoTimestamp) {
+            const int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            *timestamp = std::max(now, last_timestamp_ + 1);
+        } else if (capture_timestamp_us == kNextTimestamp) {
+            *timestamp = last_timestamp_ + 1;
+        } else if (capture_timestamp_us <= last_timestamp_) {
+            SetError(5, "Capture timestamps must strictly increase");
+            return false;
+        }
+        last_timestamp_ = *timestamp;
+        return true;
+    }
+
+    // Height / width of a graph input packet
+    static float InputAspect(const mediapipe::Packet& packet) {
+#ifdef MEDIAPIPE_GPU_ENABLED
+        const auto& input = packet.Get<mediapipe::GpuBuffer>();
+        const int width = input.width();
+        const int height = input.height();
+#else
+        const auto& input = packet.Get<mediapipe::ImageFrame>();
+        const int width = input.Width();
+        const int height = input.Height();
+#endif
+        return width > 0 ? static_cast<float>(height) / width : 1.0f;
+    }
+
+    // Initialize and start the graph for `tiers_[tier]`, observing its
+    // outputs into the shared in-flight table. Throws on failure.
+    std::shared_ptr<mediapipe::CalculatorGraph> StartGraph(int tier) {
+        auto graph = std::make_shared<mediapipe::CalculatorGraph>();
+        absl::Status status;
+        if (executor_) {
+            status = graph->SetExecutor("", executor_);
+            if (!status.ok()) {
+                throw std::runtime_error(
+                    "Executor setup failed: " + std::string(status.message()));
+            }
+        }
+        status = graph->Initialize(*graph_config_);
+        if (!status.ok()) {
+            throw std::runtime_error(
+                "Graph initialization failed: " + std::string(status.message()));
+        }
+
+        // Models come from the process-wide mappings, at config_.precision
+        status = graph->SetServiceObject(mediapipe::kResourcesService, model_resources_);
+        if (!status.ok()) {
+            throw std::runtime_error(
+                "Model cache setup failed: " + std::string(status.message()));
+        }
+
+#ifdef MEDIAPIPE_GPU_ENABLED
+        status = graph->SetGpuResources(gpu_resources_);
+        if (!status.ok()) {
+            throw std::runtime_error(
+                "GPU setup failed: " + std::string(status.message()));
+        }
+#endif
+
+        for (int stream = 0; stream < kNumOutputStreams; ++stream) {
+            if (!(observed_streams_ & (1u << stream))) {
+                continue;
+            }
+            status = graph->ObserveOutputStream(
+                kOutputStreamNames[stream],
+                [this, tier, stream](const mediapipe::Packet& packet) {
+                    OnOutputPacket(tier, stream, packet);
+                    return absl::OkStatus();
+                },
+                /*observe_timestamp_bounds=*/true);
+            if (!status.ok()) {
+                throw std::runtime_error(
+                    "Failed to observe output stream: " + std::string(status.message()));
+            }
+        }
+
+        // Count frames the flow limiter lets through; the rest were dropped
+        if (flow_limited_) {
+            status = graph->ObserveOutputStream(
+                "throttled_input_video",
+                [this](const mediapipe::Packet&) {
+                    frames_admitted_.fetch_add(1, std::memory_order_relaxed);
+                    return absl::OkStatus();
+                });
+            if (!status.ok()) {
+                throw std::runtime_error(
+                    "Failed to observe output stream: " + std::string(status.message()));
+            }
+        }
+
+        MPConfig tier_config = config_;
+        tier_config.model_complexity = tiers_[tier].model_complexity;
+        tier_config.refine_face_landmarks = tiers_[tier].refine_face_landmarks;
+        status = graph->StartRun(BuildHolisticSidePackets(tier_config, *graph_config_));
+        if (!status.ok()) {
+            throw std::runtime_error(
+                "Failed to start graph: " + std::string(status.message()));
+        }
+        return graph;
+    }
+
+    // The running graph for `tier`, or null while it is not warm
+    std::shared_ptr<mediapipe::CalculatorGraph> Graph(int tier) {
+        std::lock_guard<std::mutex> lock(graphs_mutex_);
+        return graphs_[tier];
+    }
+
+    // Requires submit_mutex_. Send new frames to the governor's tier once
+    // its graph is running; frames already in the old graph finish there.
+    void ApplyRequestedTier() {
+        const int requested = requested_tier_.load(std::memory_order_relaxed);
+        if (requested == active_tier_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (Graph(requested)) {
+            active_tier_.store(requested, std::memory_order_relaxed);
+            tier_switches_.fetch_add(1, std::memory_order_relaxed);
+        }
+        RequestWarmup();
+    }
+
+    void RequestWarmup() {
+        {
+            std::lock_guard<std::mutex> lock(warm_mutex_);
+            warm_pending_ = true;
+        }
+        warm_cv_.notify_one();
+    }
+
+    // Warm worker: keep the active tier's neighbours running and close the
+    // graphs further away
+    void WarmLoop() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(warm_mutex_);
+                warm_cv_.wait(lock, [this] { return warm_stop_ || warm_pending_; });
+                if (warm_stop_) {
+                    return;
+                }
+                warm_pending_ = false;
+            }
+
+            const int active = active_tier_.load(std::memory_order_relaxed);
+            for (int tier = 0; tier < static_cast<int>(tiers_.size()); ++tier) {
+                const bool wanted = std::abs(tier - active) <= 1;
+                if (wanted && !warm_failed_[tier] && !Graph(tier)) {
+                    try {
+                        auto graph = StartGraph(tier);
+                        std::lock_guard<std::mutex> lock(graphs_mutex_);
+                        graphs_[tier] = std::move(graph);
+                    } catch (const std::exception&) {
+                        // Never switched to; the governor settles below it
+                        warm_failed_[tier] = true;
+                    }
+                } else if (!wanted) {
+                    RetireGraph(tier);
+                }
+            }
+        }
+    }
+
+    // Close the graph for `tier` unless it became active again or still
+    // has frames in flight
+    void RetireGraph(int tier) {
+        std::shared_ptr<mediapipe::CalculatorGraph> graph;
+        {
+            // No tier switch meanwhile
+            std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+            if (std::abs(tier - active_tier_.load(std::memory_order_relaxed)) <= 1) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (const auto& entry : in_flight_) {
+                    if (entry.second.tier == tier && entry.second.pending_streams != 0) {
+                        return;
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(graphs_mutex_);
+            graph = std::move(graphs_[tier]);
+        }
+        if (graph && graph->CloseAllInputStreams().ok()) {
+            graph->WaitUntilDone();
+        }
+    }
+
+    // A failed graph may never release its queued packets, so it is
+    // cancelled and drained
+    void CancelFailedGraphs() {
+        std::vector<std::shared_ptr<mediapipe::CalculatorGraph>> graphs;
+        {
+            std::lock_guard<std::mutex> lock(graphs_mutex_);
+            graphs = graphs_;
+        }
+        for (auto& graph : graphs) {
+            if (graph && graph->HasError()) {
+                graph->Cancel();
+                graph->WaitUntilDone();
+            }
+        }
+    }
+
+    // Publish `image_frame` as the newest realtime frame. Whatever frame the
+    // worker has not picked up yet is superseded and dropped.
+    void PostToMailbox(std::unique_ptr<mediapipe::ImageFrame> image_frame, uint64_t user_tag) {
+        auto* entry = new MailboxFrame{std::move(image_frame), user_tag,
+                                       std::chrono::steady_clock::now()};
+        if (MailboxFrame* stale = mailbox_.exchange(entry, std::memory_order_acq_rel)) {
+            frames_superseded_.fetch_add(1, std::memory_order_relaxed);
+            delete stale;
+        }
+        // The lock only orders the wakeup against the worker's check
+        { std::lock_guard<std::mutex> lock(mailbox_mutex_); }
+        mailbox_cv_.notify_one();
+    }
+
+    // Realtime worker: once the graph has room, send it the newest frame
+    void MailboxLoop() {
+        const size_t max_in_flight = std::max(config_.max_frames_in_flight, 1);
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mailbox_mutex_);
+                mailbox_cv_.wait(lock, [this] {
+                    return mailbox_stop_ || mailbox_.load(std::memory_order_acquire);
+                });
+                if (mailbox_stop_) {
+                    return;
+                }
+            }
+
+            // Wait for a free slot before taking the frame, so that frames
+            // arriving meanwhile still replace it
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] {
+                    return MailboxStopping() || in_flight_.size() < max_in_flight ||
+                           HasGraphError();
+                });
+            }
+            if (MailboxStopping()) {
+                return;
+            }
+
+            std::unique_ptr<MailboxFrame> entry(
+                mailbox_.exchange(nullptr, std::memory_order_acq_rel));
+            if (!entry) {
+                continue;
+            }
+            SendImageFrame(mediapipe::Adopt(entry->image.release()), entry->user_tag,
+                           /*sync=*/false, nullptr, kAutoTimestamp, entry->submit_time);
+        }
+    }
+
+    bool MailboxStopping() {
+        std::lock_guard<std::mutex> lock(mailbox_mutex_);
+        return mailbox_stop_;
+    }
+
+    // Feeds the stats window and, with MPConfig::adaptive_complexity, the
+    // governor; its decision takes effect with the next frame sent
+    void RecordLatency(float latency_ms, int tier) {
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            latencies_[latency_count_ % kLatencyWindow] = latency_ms;
+            ++latency_count_;
+        }
+        if (governor_) {
+            requested_tier_.store(governor_->Record(tier, latency_ms),
+                                  std::memory_order_relaxed);
+        }
+    }
+
+    // Block until the frame at `timestamp` has completed, then take it
+    bool WaitForFrame(int64_t timestamp, PendingFrame* out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            auto it = in_flight_.find(timestamp);
+            if (it != in_flight_.end() && it->second.pending_streams == 0) {
+                *out = std::move(it->second);
+                in_flight_.erase(it);
+                return true;
+            }
+            if (HasGraphError()) {
+                in_flight_.erase(timestamp);
+                SetError(4, "Graph error while waiting for results");
+                return false;
+            }
+            cv_.wait_for(lock, kSyncWaitSlice);
+        }
+    }
+
+    // Block until a borrowed input frame has been released by the graph. A
+    // failed graph may never release its queued packets, so it is cancelled
+    // and drained instead; the handle is unusable after a graph error anyway.
+    bool WaitForInputRelease(InputRelease& release) {
+        std::unique_lock<std::mutex> lock(release.mutex);
+        while (!release.released) {
+            if (HasGraphError()) {
+                lock.unlock();
+                CancelFailedGraphs();
+                lock.lock();
+                release.cv.wait(lock, [&release] { return release.released; });
+                SetError(4, "Graph error while waiting for results");
+                return false;
+            }
+            release.cv.wait_for(lock, kSyncWaitSlice);
+        }
+        return true;
+    }
+
+    // Output stream observer of the graph for `tier`. An empty packet
+    // reports a timestamp bound: the stream will produce nothing at or below
+    // its timestamp.
+    void OnOutputPacket(int tier, int stream, const mediapipe::Packet& packet) {
+        const uint32_t stream_bit = 1u << stream;
+        const int64_t timestamp = packet.Timestamp().Value();
+        bool retire = false;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            bool sync_ready = false;
+            bool async_ready = false;
+            bool tier_completed = false;
+            for (auto it = in_flight_.begin();
+                 it != in_flight_.end() && it->first <= timestamp; ++it) {
+                PendingFrame& frame = it->second;
+                if (frame.tier != tier || !(frame.pending_streams & stream_bit)) {
+                    continue;
+                }
+                if (!packet.IsEmpty() && it->first == timestamp) {
+                    frame.packets[stream] = packet;
+                }
+                frame.pending_streams &= ~stream_bit;
+                if (frame.pending_streams == 0) {
+                    frames_completed_.fetch_add(1, std::memory_order_relaxed);
+                    sync_ready |= frame.sync;
+                    tier_completed = true;
+                }
+            }
+
+            // RetireGraph skips a graph that still has frames in flight,
+            // so the last of them completing reschedules it
+            if (tier_completed &&
+                std::abs(tier - active_tier_.load(std::memory_order_relaxed)) > 1) {
+                retire = std::none_of(in_flight_.begin(), in_flight_.end(),
+                                      [tier](const std::pair<const int64_t, PendingFrame>& entry) {
+                                          return entry.second.tier == tier &&
+                                                 entry.second.pending_streams != 0;
+                                      });
+            }
+
+            // Hand out async frames in timestamp order. Right after a tier
+            // switch the old graph may still be finishing older frames,
+            // which then hold back newer ones from the new graph.
+            for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+                PendingFrame& frame = it->second;
+                if (frame.pending_streams != 0) {
+                    break;
+                }
+                if (frame.sync) {
+                    ++it;
+                    continue;
+                }
+                async_ready = true;
+                if (callback_) {
+                    delivery_queue_.push_back(std::move(frame));
+                } else {
+                    if (completed_.size() >= kMaxCompletedFrames) {
+                        completed_.pop_front();
+                    }
+                    completed_.push_back(std::move(frame));
+                }
+                it = in_flight_.erase(it);
+            }
+
+            // Completed frames also free a slot for the realtime mailbox
+            if (sync_ready || async_ready) {
+                cv_.notify_all();
+            }
+        }
+
+        if (retire) {
+            RequestWarmup();
+        }
+        DrainDeliveries();
+    }
+
+    // Hand queued frames to the result callback. Observers of different
+    // streams run concurrently, so whichever finds no delivery in progress
+    // drains the queue for all of them: callbacks never overlap and see
+    // frames in timestamp order. Callbacks run outside mutex_ so they may
+    // submit more frames.
+    void DrainDeliveries() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (delivering_) {
+            return;
+        }
+        delivering_ = true;
+        while (!delivery_queue_.empty()) {
+            PendingFrame frame = std::move(delivery_queue_.front());
+            delivery_queue_.pop_front();
+            const MP_ResultCallback callback = callback_;
+            void* callback_user_data = callback_user_data_;
+            if (!callback) {
+                // Callback removed meanwhile: back to polling
+                if (completed_.size() >= kMaxCompletedFrames) {
+                    completed_.pop_front();
+                }
+                completed_.push_back(std::move(frame));
+                cv_.notify_all();
+                continue;
+            }
+
+            lock.unlock();
+            DeliverFrame(frame, &callback_buffer_.results, &callback_buffer_);
+            callback(&callback_buffer_.results, frame.user_tag, callback_user_data);
+            lock.lock();
+        }
+        delivering_ = false;
+    }
+
+    // Convert a completed async frame and stamp its end-to-end latency
+    void DeliverFrame(
+        const PendingFrame& frame,
+        MPResults* results,
+        MPResultsBuffer* buffer
+    ) {
+        memset(results, 0, sizeof(MPResults));
+        FetchResults(frame, results, buffer);
+        results->processing_time_ms = std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - frame.submit_time).count();
+        results->timestamp_ms = frame.timestamp / 1000;
+        results->timestamp_us = frame.timestamp;
+        RecordLatency(results->processing_time_ms, frame.tier);
+    }
+
+    // Disabled outputs are never observed, so their packets stay empty and
+    // their counts stay zero. Landmarks are then mapped back from an ROI
+    // crop, smoothed, the face solved and, last, the output projected.
+    void FetchResults(
+        const PendingFrame& frame,
+        MPResults* results,
+        MPResultsBuffer* buffer,
+        LandmarkFilter* stream_filter = nullptr
+    ) {
+        const bool soa = config_.landmark_layout == MP_LAYOUT_SOA;
+        if (soa) {
+            AssignPlanes(buffer ? SoaBlock(buffer) : AllocateSoaBlock(), results);
+        }
+
+        // Face landmarks
+        const auto& face_packet = frame.packets[kFaceStream];
+        if (!face_packet.IsEmpty()) {
+            const auto& face_landmarks = 
+                face_packet.Get<mediapipe::NormalizedLandmarkList>();
+            results->face_landmarks = ConvertLandmarks(
+                face_landmarks,
+                soa ? &results->face_planes : nullptr,
+                buffer ? buffer->face_storage : nullptr,
+                MP_MAX_FACE_LANDMARKS,
+                &results->face_count);
+            results->face_detected = results->face_count > 0;
+        }
+
+        // Left hand landmarks
+        const auto& left_hand_packet = frame.packets[kLeftHandStream];
+        if (!left_hand_packet.IsEmpty()) {
+            const auto& left_hand_landmarks = 
+                left_hand_packet.Get<mediapipe::NormalizedLandmarkList>();
+            results->left_hand_landmarks = ConvertLandmarks(
+                left_hand_landmarks,
+                soa ? &results->left_hand_planes : nullptr,
+                buffer ? buffer->left_hand_storage : nullptr,
+                MP_MAX_HAND_LANDMARKS,
+                &results->left_hand_count);
+            results->hands_detected = true;
+        }
+
+        // Right hand landmarks
+        const auto& right_hand_packet = frame.packets[kRightHandStream];
+        if (!right_hand_packet.IsEmpty()) {
+            const auto& right_hand_landmarks = 
+                right_hand_packet.Get<mediapipe::NormalizedLandmarkList>();
+            results->right_hand_landmarks = ConvertLandmarks(
+                right_hand_landmarks,
+                soa ? &results->right_hand_planes : nullptr,
+                buffer ? buffer->right_hand_storage : nullptr,
+                MP_MAX_HAND_LANDMARKS,
+                &results->right_hand_count);
+            results->hands_detected = true;
+        }
+
+        // Pose landmarks
+        const auto& pose_packet = frame.packets[kPoseStream];
+        if (!pose_packet.IsEmpty()) {
+            const auto& pose_landmarks = 
+                pose_packet.Get<mediapipe::NormalizedLandmarkList>();
+            results->pose_landmarks = ConvertLandmarks(
+                pose_landmarks,
+                soa ? &results->pose_planes : nullptr,
+                buffer ? buffer->pose_storage : nullptr,
+                MP_MAX_POSE_LANDMARKS,
+                &results->pose_count);
+            results->pose_detected = results->pose_count > 0;
+        }
+
+        // Pose world landmarks (3D in meters)
+        const auto& pose_world_packet = frame.packets[kPoseWorldStream];
+        if (!pose_world_packet.IsEmpty()) {
+            const auto& pose_world_landmarks = 
+                pose_world_packet.Get<mediapipe::LandmarkList>();
+            results->pose_world_landmarks = ConvertLandmarks(
+                pose_world_landmarks,
+                soa ? &results->pose_world_planes : nullptr,
+                buffer ? buffer->pose_world_storage : nullptr,
+                MP_MAX_POSE_LANDMARKS,
+                &results->pose_world_count);
+        }
+
+        // Camera frame coordinates from here on, whatever was sent
+        if (frame.roi) {
+            frame.roi->Update(frame.region, results);
+        }
+        if (gate_ && !frame.predicted) {
+            gate_->Observe(*results, frame.timestamp);
+        }
+
+        if (stream_filter) {
+            stream_filter->Apply(results, frame.timestamp);
+        } else if (filter_) {
+            std::lock_guard<std::mutex> lock(filter_mutex_);
+            filter_->Apply(results, frame.timestamp);
+        }
+
+        // Solved from the smoothed landmarks, so it is smooth as well
+        SolveFace(results, frame.aspect);
+        results->model_complexity = tiers_[frame.tier].model_complexity;
+        results->refine_face_landmarks = tiers_[frame.tier].refine_face_landmarks;
+        results->predicted = frame.predicted;
+
+        // Readers and recordings get every landmark, whatever the
+        // projection keeps
+        const float latency_ms = std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - frame.submit_time).count();
+        if (shm_writer_) {
+            std::lock_guard<std::mutex> lock(shm_mutex_);
+            shm_writer_->Publish(*results, frame.timestamp, latency_ms);
+        }
+        {
+            std::lock_guard<std::mutex> lock(recorder_mutex_);
+            if (recorder_) {
+                recorder_->Append(*results, frame.timestamp, latency_ms);
+            }
+        }
+
+        if (projection_) {
+            // The full arrays are only needed up to here
+            if (buffer) {
+                projection_->Apply(results, buffer->compact_storage);
+            } else {
+                std::unique_ptr<uint8_t[]> storage(new uint8_t[MP_COMPACT_STORAGE_BYTES]);
+                projection_->Apply(results, storage.release());
+                ReleaseLandmarkArrays(results);
+            }
+            DetachLandmarkArrays(results);
+        }
+    }
+
+    MPConfig config_;
+    std::shared_ptr<const mediapipe::CalculatorGraphConfig> graph_config_;
+    std::shared_ptr<mediapipe::Executor> executor_;  // null: MediaPipe's default
+    ErrorSlot errors_;
+    std::shared_ptr<ModelResources> model_resources_;
+
+    // Complexity tiers, cheapest first, and one graph per warm tier. New
+    // frames go to the active tier; the governor (null without
+    // MPConfig::adaptive_complexity) requests switches.
+    std::vector<ComplexityTier> tiers_;
+    std::vector<std::shared_ptr<mediapipe::CalculatorGraph>> graphs_;  // guarded by graphs_mutex_
+    std::mutex graphs_mutex_;
+    std::atomic<int> active_tier_{0};  // changed under submit_mutex_
+    std::atomic<int> requested_tier_{0};
+    std::unique_ptr<ComplexityGovernor> governor_;
+    std::thread warm_worker_;
+    std::mutex warm_mutex_;
+    std::condition_variable warm_cv_;
+    bool warm_pending_ = false;  // guarded by warm_mutex_
+    bool warm_stop_ = false;     // guarded by warm_mutex_
+    std::vector<bool> warm_failed_;  // warm worker only
+    int64_t last_timestamp_;  // graph timestamp of the last frame sent, in us
+    uint32_t observed_streams_;  // bit per OutputStream in the graph
+    bool flow_limited_ = false;  // graph throttles through "throttled_input_video"
+
+    // Recycled pixel buffers for frames the bridge copies or converts
+    std::shared_ptr<FramePool> input_pool_;
+
+    // Bridge-side smoothing, null when MPConfig::smoothing is off. Frames
+    // complete in order but may be fetched on different threads.
+    std::unique_ptr<LandmarkFilter> filter_;
+    std::mutex filter_mutex_;
+
+    // Compact output, null when MPConfig::projection is zeroed
+    std::unique_ptr<LandmarkProjection> projection_;
+
+    // Results ring for other processes, null when MPConfig::shm_publish is
+    // zeroed. Frames may be fetched on several threads at once.
+    std::unique_ptr<ShmRingWriter> shm_writer_;
+    std::mutex shm_mutex_;
+
+    // MP_RecordStart session, null when not recording
+    std::shared_ptr<LandmarkRecorder> recorder_;  // guarded by recorder_mutex_
+    std::mutex recorder_mutex_;
+
+    // Input cropping / downscaling, null when MPConfig::input_scaling is off
+    std::unique_ptr<RoiTracker> roi_;
+
+    // Sync-frame skipping, null when MPConfig::motion_gating is off
+    std::unique_ptr<MotionGate> gate_;
+
+    // Realtime mode: single-slot mailbox holding the newest submitted frame
+    std::atomic<MailboxFrame*> mailbox_{nullptr};
+    std::thread mailbox_worker_;
+    std::mutex mailbox_mutex_;
+    std::condition_variable mailbox_cv_;
+    bool mailbox_stop_ = false;  // guarded by mailbox_mutex_
+
+    // MP_GetStats counters
+    std::atomic<uint64_t> frames_submitted_{0};
+    std::atomic<uint64_t> frames_superseded_{0};  // replaced in the mailbox
+    std::atomic<uint64_t> frames_cropped_{0};
+    std::atomic<uint64_t> frames_predicted_{0};
+    std::atomic<uint64_t> tier_switches_{0};
+    std::atomic<uint64_t> frames_completed_{0};
+    std::atomic<uint64_t> frames_admitted_{0};  // passed the flow limiter
+    std::mutex stats_mutex_;
+    std::array<float, kLatencyWindow> latencies_ = {};  // ring, guarded by stats_mutex_
+    size_t latency_count_ = 0;
+
+    // Serializes timestamp assignment with AddPacketToInputStream
+    std::mutex submit_mutex_;
+
+    // Guards everything below; shared with the output stream observers
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<int64_t, PendingFrame> in_flight_;
+    std::deque<PendingFrame> completed_;
+    MP_ResultCallback callback_ = nullptr;
+    void* callback_user_data_ = nullptr;
+    std::deque<PendingFrame> delivery_queue_;  // completed, awaiting callback_
+    bool delivering_ = false;  // a thread is in DrainDeliveries
+
+    // Only touched by the thread that set delivering_
+    MPResultsBuffer callback_buffer_ = {};
+
+#ifdef MEDIAPIPE_GPU_ENABLED
+    std::shared_ptr<mediapipe::GpuResources> gpu_resources_;
+    mediapipe::GlCalculatorHelper gpu_helper_;
+#endif
+};
+
+// ============================================================================
+// Processor Pool
+// ============================================================================
+
+// Frames queued per instance before MP_PoolSubmit rejects new ones
+constexpr size_t kMaxQueuedPerInstance = 4;
+
+// Copy a filled results buffer, pointing the copy at its own storage
+void CopyResultsBuffer(const MPResultsBuffer& src, MPResultsBuffer* dst) {
+    memcpy(dst, &src, sizeof(MPResultsBuffer));
+    MPResults& results = dst->results;
+    if (results.face_landmarks) results.face_landmarks = dst->face_storage;
+    if (results.left_hand_landmarks) results.left_hand_landmarks = dst->left_hand_storage;
+    if (results.right_hand_landmarks) results.right_hand_landmarks = dst->right_hand_storage;
+    if (results.pose_landmarks) results.pose_landmarks = dst->pose_storage;
+    if (results.pose_world_landmarks) results.pose_world_landmarks = dst->pose_world_storage;
+    if (results.compact_landmarks) results.compact_landmarks = dst->compact_storage;
+    if (results.face_planes.x) {
+        // The aligned block may sit at a different offset in `dst`
+        float* block = SoaBlock(dst);
+        memcpy(block, src.results.face_planes.x, kSoaBlockBytes);
+        AssignPlanes(block, &results);
+    }
+}
+
+// N independent graphs, each driven by one worker thread pinned to a core.
+//
+// A holistic graph carries tracking state from frame to frame, so a stream
+// that is being tracked stays bound to the instance that owns it. A stream
+// that is not (its first frames, or after its last frame found nobody) needs
+// a fresh detection anyway, so an idle worker may steal its queued frames
+// and become its new owner. Frames are converted to RGB at submission, and
+// each stream's results are delivered in submission order.
+class ProcessorPool {
+public:
+    ProcessorPool(const MPConfig* config, int n_instances)
+        : smoothing_(config->smoothing),
+          input_scaling_(config->input_scaling),
+          min_tracking_confidence_(config->min_tracking_confidence),
+          frame_pool_(FramePool::Create(
+              n_instances * static_cast<int>(kMaxQueuedPerInstance + 1))) {
+        // Instances may serve several streams, so smoothing and ROI tracking
+        // are done per stream here instead of per graph
+        MPConfig instance_config = *config;
+        instance_config.smoothing.filter = MP_SMOOTHING_NONE;
+        instance_config.input_scaling = MPInputScaling{};
+        for (int i = 0; i < n_instances; ++i) {
+            // Each instance runs its graph on its own slice of the cores, so
+            // N instances do not each spread a default-sized pool over all
+            // of them
+            const uint64_t cores =
+                AffinitySlice(config->threading.cpu_affinity, i, n_instances);
+            instance_config.threading.cpu_affinity = cores;
+            if (config->threading.inference_threads <= 0) {
+                instance_config.threading.inference_threads = CountAffinityCores(cores);
+            }
+
+            auto instance = std::make_unique<Instance>();
+            instance->processor = std::make_unique<MediaPipeProcessor>(&instance_config);
+            instance->cpu_affinity = cores;
+            instances_.push_back(std::move(instance));
+        }
+        for (int i = 0; i < n_instances; ++i) {
+            instances_[i]->worker = std::thread([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ~ProcessorPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& instance : instances_) {
+            if (instance->worker.joinable()) {
+                instance->worker.join();
+            }
+        }
+    }
+
+    ProcessorPool(const ProcessorPool&) = delete;
+    ProcessorPool& operator=(const ProcessorPool&) = delete;
+
+    bool Submit(uint32_t stream_id, const MPFrame& frame, uint64_t user_tag) {
+        if (!frame.pixels || frame.width <= 0 || frame.height <= 0) {
+            SetError(1, "Invalid arguments");
+            return false;
+        }
+
+        Task task;
+        task.stream_id = stream_id;
+        task.user_tag = user_tag;
+        try {
+            task.image = frame_pool_->Acquire(frame.width, frame.height);
+        } catch (const std::exception& e) {
+            SetError(3, std::string("Processing error: ") + e.what());
+            return false;
+        }
+        if (!ConvertFrameToRgb(frame, task.image->MutablePixelData(),
+                               task.image->WidthStep())) {
+            SetError(1, "Invalid frame description or undecodable MJPEG data");
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            StreamState& stream = streams_[stream_id];
+            if (stream.owner < 0 || !instances_[stream.owner]->healthy) {
+                stream.owner = LeastLoadedInstance();
+                stream.tracking = false;
+                if (stream.owner < 0) {
+                    SetError(62, "No healthy pool instance left");
+                    return false;
+                }
+            }
+            Instance& owner = *instances_[stream.owner];
+            if (owner.queue.size() >= kMaxQueuedPerInstance) {
+                SetError(61, "Pool instance queue is full");
+                return false;
+            }
+            owner.queue.push_back(std::move(task));
+        }
+
+        // Wake every worker: besides the owner, an idle one may steal it
+        work_cv_.notify_all();
+        ClearError();
+        return true;
+    }
+
+    void SetResultCallback(MP_PoolResultCallback callback, void* user_data) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback_ = callback;
+        callback_user_data_ = user_data;
+    }
+
+    int Poll(MPResultsBuffer* buffer, uint32_t* stream_id, uint64_t* user_tag, int timeout_ms) {
+        std::unique_ptr<Completed> completed;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto has_result = [this] { return !completed_.empty(); };
+            if (timeout_ms < 0) {
+                result_cv_.wait(lock, has_result);
+            } else if (!result_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                            has_result)) {
+                return 0;
+            }
+            completed = std::move(completed_.front());
+            completed_.pop_front();
+        }
+
+        CopyResultsBuffer(completed->buffer, buffer);
+        if (stream_id) {
+            *stream_id = completed->stream_id;
+        }
+        if (user_tag) {
+            *user_tag = completed->user_tag;
+        }
+        Recycle(std::move(completed));
+        ClearError();
+        return 1;
+    }
+
+private:
+    struct Task {
+        uint32_t stream_id = 0;
+        uint64_t user_tag = 0;
+        std::unique_ptr<mediapipe::ImageFrame> image;
+    };
+
+    struct Instance {
+        std::unique_ptr<MediaPipeProcessor> processor;
+        uint64_t cpu_affinity = 0;  // the instance's slice of the cores
+        std::thread worker;
+        std::deque<Task> queue;
+        bool busy = false;
+        bool healthy = true;
+    };
+
+    struct StreamState {
+        int owner = -1;         // instance holding the stream's tracking state
+        bool tracking = false;  // last result found someone, keep the owner
+        int active = 0;         // frames of this stream being processed
+        // Bridge-side smoothing (MPConfig::smoothing); only used by the one
+        // worker processing the stream's current frame
+        std::unique_ptr<LandmarkFilter> filter;
+        // MPConfig::input_scaling; the box is in frame coordinates, so it
+        // stays valid when the stream moves to another instance
+        std::unique_ptr<RoiTracker> roi;
+    };
+
+    struct Completed {
+        uint32_t stream_id = 0;
+        uint64_t user_tag = 0;
+        MPResultsBuffer buffer;
+    };
+
+    // Requires mutex_. Returns -1 when every instance has failed.
+    int LeastLoadedInstance() const {
+        int best = -1;
+        size_t best_load = 0;
+        for (int i = 0; i < static_cast<int>(instances_.size()); ++i) {
+            const Instance& instance = *instances_[i];
+            if (!instance.healthy) {
+                continue;
+            }
+            const size_t load = instance.queue.size() + (instance.busy ? 1 : 0);
+            if (best < 0 || load < best_load) {
+                best = i;
+                best_load = load;
+            }
+        }
+        return best;
+    }
+
+    // Requires mutex_. Moves every queued frame of one untracked, idle
+    // stream from a busy instance to `thief`. Returns false if none exists.
+    bool StealWork(int thief) {
+        for (int victim = 0; victim < static_cast<int>(instances_.size()); ++victim) {
+            Instance& instance = *instances_[victim];
+            if (victim == thief || !instance.busy) {
+                continue;
+            }
+            for (const Task& task : instance.queue) {
+                StreamState& stream = streams_[task.stream_id];
+                if (stream.tracking || stream.active > 0) {
+                    continue;
+                }
+                const uint32_t stream_id = task.stream_id;
+                stream.owner = thief;
+                auto& queue = instance.queue;
+                for (auto it = queue.begin(); it != queue.end();) {
+                    if (it->stream_id == stream_id) {
+                        instances_[thief]->queue.push_back(std::move(*it));
+                        it = queue.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Requires mutex_. Hand a failed instance's streams to healthy ones;
+    // they restart from detection there.
+    void Redistribute(int failed) {
+        auto queue = std::move(instances_[failed]->queue);
+        instances_[failed]->queue.clear();
+        for (auto& entry : streams_) {
+            if (entry.second.owner == failed) {
+                entry.second.owner = -1;
+                entry.second.tracking = false;
+            }
+        }
+        for (Task& task : queue) {
+            StreamState& stream = streams_[task.stream_id];
+            if (stream.owner < 0) {
+                stream.owner = LeastLoadedInstance();
+            }
+            if (stream.owner >= 0) {
+                instances_[stream.owner]->queue.push_back(std::move(task));
+            }
+        }
+    }
+
+    std::unique_ptr<Completed> TakeResultSlot() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_slots_.empty()) {
+            return std::make_unique<Completed>();
+        }
+        auto slot = std::move(free_slots_.back());
+        free_slots_.pop_back();
+        return slot;
+    }
+
+    void Recycle(std::unique_ptr<Completed> slot) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_slots_.push_back(std::move(slot));
+    }
+
+    void WorkerLoop(int index) {
+        Instance& self = *instances_[index];
+        // Input scaling runs here, next to the instance's graph threads
+        PinCurrentThread(self.cpu_affinity);
+
+        for (;;) {
+            Task task;
+            LandmarkFilter* filter = nullptr;
+            RoiTracker* roi = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_cv_.wait(lock, [&] {
+                    return stopping_ || !self.queue.empty() || StealWork(index);
+                });
+                if (stopping_) {
+                    return;
+                }
+                task = std::move(self.queue.front());
+                self.queue.pop_front();
+                self.busy = true;
+                StreamState& stream = streams_[task.stream_id];
+                ++stream.active;
+                if (!stream.filter && smoothing_.filter != MP_SMOOTHING_NONE) {
+                    stream.filter = std::make_unique<LandmarkFilter>(smoothing_);
+                }
+                filter = stream.filter.get();
+                if (!stream.roi && RoiTracker::Enabled(input_scaling_)) {
+                    stream.roi = std::make_unique<RoiTracker>(input_scaling_,
+                                                              min_tracking_confidence_);
+                }
+                roi = stream.roi.get();
+            }
+
+            auto completed = TakeResultSlot();
+            completed->stream_id = task.stream_id;
+            completed->user_tag = task.user_tag;
+            const bool ok = self.processor->ProcessImage(
+                std::move(task.image), &completed->buffer.results, &completed->buffer,
+                filter, roi);
+            const MPResults& results = completed->buffer.results;
+
+            MP_PoolResultCallback callback = nullptr;
+            void* callback_user_data = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                self.busy = false;
+                StreamState& stream = streams_[task.stream_id];
+                --stream.active;
+                stream.tracking = ok && (results.face_detected || results.pose_detected ||
+                                         results.hands_detected);
+
+                if (!ok && self.processor->HasGraphError()) {
+                    self.healthy = false;
+                    Redistribute(index);
+                }
+
+                callback = callback_;
+                callback_user_data = callback_user_data_;
+                if (ok && !callback) {
+                    if (completed_.size() >= kMaxCompletedFrames) {
+                        free_slots_.push_back(std::move(completed_.front()));
+                        completed_.pop_front();
+                    }
+                    completed_.push_back(std::move(completed));
+                    result_cv_.notify_all();
+                }
+            }
+            work_cv_.notify_all();
+
+            if (completed) {
+                if (ok && callback) {
+                    callback(&completed->buffer.results, completed->stream_id,
+                             completed->user_tag, callback_user_data);
+                }
+                Recycle(std::move(completed));
+            }
+            if (!self.healthy) {
+                return;
+            }
+        }
+    }
+
+    const MPSmoothingConfig smoothing_;
+    const MPInputScaling input_scaling_;
+    const float min_tracking_confidence_;
+    std::shared_ptr<FramePool> frame_pool_;
+    std::vector<std::unique_ptr<Instance>> instances_;
+
+    // Guards everything below and the queues and flags in instances_
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable result_cv_;
+    std::map<uint32_t, StreamState> streams_;
+    std::deque<std::unique_ptr<Completed>> completed_;
+    std::vector<std::unique_ptr<Completed>> free_slots_;
+    MP_PoolResultCallback callback_ = nullptr;
+    void* callback_user_data_ = nullptr;
+    bool stopping_ = false;
+};
+
+// ============================================================================
+// C API Implementation
+// ============================================================================
+
+namespace {
+
+// The slot MP_GetLastError(handle) reads
+ErrorSlot* HandleErrors(MPHandle handle) {
+    return handle ? static_cast<MediaPipeProcessor*>(handle)->errors() : nullptr;
+}
+
+} // anonymous namespace
+
+MPHandle MP_Create(const MPConfig* config) {
+    return MP_CreateFromGraph(config, nullptr, 0);
+}
+
+MPHandle MP_CreateFromGraph(const MPConfig* config, const void* graph, size_t graph_size) {
+    if (!config) {
+        SetError(10, "Config is null");
+        return nullptr;
+    }
+
+    if (config->enabled_outputs != 0 && (config->enabled_outputs & MP_OUTPUT_ALL) == 0) {
+        SetError(12, "enabled_outputs selects no known outputs");
+        return nullptr;
+    }
+    if (config->inference_backend < MP_BACKEND_DEFAULT ||
+        config->inference_backend > MP_BACKEND_NNAPI ||
+        !(MP_QueryBackends() & MP_BACKEND_BIT(config->inference_backend))) {
+        SetError(14, "inference_backend is not available in this build");
+        return nullptr;
+    }
+    if (config->precision < MP_PRECISION_DEFAULT || config->precision > MP_PRECISION_INT8) {
+        SetError(15, "Unknown precision");
+        return nullptr;
+    }
+
+    std::shared_ptr<const mediapipe::CalculatorGraphConfig> graph_config;
+    if (graph) {
+        auto loaded = LoadHolisticGraphConfig(*config, graph, graph_size);
+        if (!loaded.ok()) {
+            SetError(13, "Graph load failed: " + std::string(loaded.status().message()));
+            return nullptr;
+        }
+        graph_config = *loaded;
+    }
+
+    try {
+        auto* processor = new MediaPipeProcessor(config, std::move(graph_config));
+        ClearError();
+        return static_cast<MPHandle>(processor);
+    } catch (const std::exception& e) {
+        SetError(11, std::string("Creation failed: ") + e.what());
+        return nullptr;
+    }
+}
+
+bool MP_Process(
+    MPHandle handle,
+    const uint8_t* pixels,
+    int width,
+    int height,
+    MPResults* results,
+    MPError* error
+) {
+    ErrorScope scope(error, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->Process(pixels, width, height, results);
+}
+
+bool MP_ProcessInto(
+    MPHandle handle,
+    const uint8_t* pixels,
+    int width,
+    int height,
+    MPResultsBuffer* buffer,
+    MPError* error
+) {
+    ErrorScope scope(error, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+    if (!buffer) {
+        SetError(21, "Results buffer is null");
+        return false;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->Process(pixels, width, height, &buffer->results, buffer);
+}
+
+bool MP_ProcessEx(MPHandle handle, const MPFrame* frame, MPResultsBuffer* buffer,
+                  MPError* error) {
+    ErrorScope scope(error, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+    if (!buffer) {
+        SetError(21, "Results buffer is null");
+        return false;
+    }
+    if (!frame) {
+        SetError(1, "Invalid arguments");
+        return false;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->ProcessFrame(*frame, &buffer->results, buffer);
+}
+
+int MP_ProcessBatch(
+    MPHandle handle,
+    const MPFrame* frames,
+    int count,
+    const int64_t* capture_timestamps_us,
+    MPResultsBuffer* results,
+    MPError* error
+) {
+    ErrorScope scope(error, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return 0;
+    }
+    if (!results) {
+        SetError(21, "Results buffer is null");
+        return 0;
+    }
+    if (!frames || count < 0) {
+        SetError(1, "Invalid arguments");
+        return 0;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->ProcessBatch(frames, count, capture_timestamps_us, results);
+}
+
+bool MP_ProcessAt(
+    MPHandle handle,
+    const MPFrame* frame,
+    int64_t capture_timestamp_us,
+    MPResultsBuffer* buffer,
+    MPError* error
+) {
+    ErrorScope scope(error, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+    if (!buffer) {
+        SetError(21, "Results buffer is null");
+        return false;
+    }
+    if (!frame || capture_timestamp_us < 0) {
+        SetError(1, "Invalid arguments");
+        return false;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->ProcessFrame(*frame, &buffer->results, buffer, capture_timestamp_us);
+}
+
+bool MP_ProcessTexture(
+    MPHandle handle,
+    uint32_t gl_texture,
+    int width,
+    int height,
+    MPResultsBuffer* buffer,
+    MPError* error
+) {
+    ErrorScope scope(error, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+
+#ifdef MEDIAPIPE_GPU_ENABLED
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->ProcessTexture(gl_texture, width, height, buffer);
+#else
+    (void)gl_texture; (void)width; (void)height; (void)buffer;
+    SetError(50, "GPU support not compiled in");
+    return false;
+#endif
+}
+
+bool MP_ProcessDmaBuf(
+    MPHandle handle,
+    int fd,
+    int width,
+    int height,
+    int stride,
+    uint32_t drm_fourcc,
+    MPResultsBuffer* buffer,
+    MPError* error
+) {
+    ErrorScope scope(error, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+
+#ifdef MEDIAPIPE_GPU_ENABLED
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->ProcessDmaBuf(fd, width, height, stride, drm_fourcc, buffer);
+#else
+    (void)fd; (void)width; (void)height; (void)stride; (void)drm_fourcc; (void)buffer;
+    SetError(50, "GPU support not compiled in");
+    return false;
+#endif
+}
+
+bool MP_Warmup(MPHandle handle, int width, int height) {
+    ErrorScope scope(nullptr, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->Warmup(width, height);
+}
+
+bool MP_SubmitFrame(
+    MPHandle handle,
+    const uint8_t* pixels,
+    int width,
+    int height,
+    uint64_t user_tag,
+    MPError* error
+) {
+    ErrorScope scope(error, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->Submit(pixels, width, height, user_tag);
+}
+
+bool MP_SetResultCallback(
+    MPHandle handle,
+    MP_ResultCallback callback,
+    void* user_data
+) {
+    ErrorScope scope(nullptr, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    processor->SetResultCallback(callback, user_data);
+    ClearError();
+    return true;
+}
+
+int MP_PollResults(
+    MPHandle handle,
+    MPResultsBuffer* buffer,
+    uint64_t* user_tag,
+    int timeout_ms,
+    MPError* error
+) {
+    ErrorScope scope(error, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return -1;
+    }
+    if (!buffer) {
+        SetError(21, "Results buffer is null");
+        return -1;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    return processor->Poll(buffer, user_tag, timeout_ms);
+}
+
+void MP_ReleaseResults(MPResults* results) {
+    if (!results) return;
+
+    ReleaseLandmarkArrays(results);
+    delete[] static_cast<uint8_t*>(results->compact_landmarks);
+
+    memset(results, 0, sizeof(MPResults));
+}
+
+MPResultsBuffer* MP_CreateResultsBuffer(void) {
+    auto* buffer = new (std::nothrow) MPResultsBuffer;
+    if (!buffer) {
+        SetError(30, "Failed to allocate results buffer");
+        return nullptr;
+    }
+    memset(buffer, 0, sizeof(MPResultsBuffer));
+    return buffer;
+}
+
+void MP_DestroyResultsBuffer(MPResultsBuffer* buffer) {
+    delete buffer;
+}
+
+MPPoolHandle MP_CreatePool(const MPConfig* config, int n_instances) {
+    if (!config) {
+        SetError(10, "Config is null");
+        return nullptr;
+    }
+    if (n_instances <= 0) {
+        SetError(60, "n_instances must be positive");
+        return nullptr;
+    }
+    if (config->shm_publish.name) {
+        SetError(16, "shm_publish needs a single handle, not a pool");
+        return nullptr;
+    }
+    if (config->motion_gating.max_skip > 0) {
+        SetError(16, "motion_gating needs a single handle, not a pool");
+        return nullptr;
+    }
+    if (config->enabled_outputs != 0 && (config->enabled_outputs & MP_OUTPUT_ALL) == 0) {
+        SetError(12, "enabled_outputs selects no known outputs");
+        return nullptr;
+    }
+    if (config->inference_backend < MP_BACKEND_DEFAULT ||
+        config->inference_backend > MP_BACKEND_NNAPI ||
+        !(MP_QueryBackends() & MP_BACKEND_BIT(config->inference_backend))) {
+        SetError(14, "inference_backend is not available in this build");
+        return nullptr;
+    }
+    if (config->precision < MP_PRECISION_DEFAULT || config->precision > MP_PRECISION_INT8) {
+        SetError(15, "Unknown precision");
+        return nullptr;
+    }
+
+    try {
+        auto* pool = new ProcessorPool(config, n_instances);
+        ClearError();
+        return static_cast<MPPoolHandle>(pool);
+    } catch (const std::exception& e) {
+        SetError(11, std::string("Creation failed: ") + e.what());
+        return nullptr;
+    }
+}
+
+bool MP_PoolSubmit(
+    MPPoolHandle pool,
+    uint32_t stream_id,
+    const MPFrame* frame,
+    uint64_t user_tag,
+    MPError* error
+) {
+    ErrorScope scope(error, nullptr);
+    if (!pool) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+    if (!frame) {
+        SetError(1, "Invalid arguments");
+        return false;
+    }
+
+    return static_cast<ProcessorPool*>(pool)->Submit(stream_id, *frame, user_tag);
+}
+
+bool MP_PoolSetResultCallback(
+    MPPoolHandle pool,
+    MP_PoolResultCallback callback,
+    void* user_data
+) {
+    if (!pool) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+
+    static_cast<ProcessorPool*>(pool)->SetResultCallback(callback, user_data);
+    ClearError();
+    return true;
+}
+
+int MP_PoolPoll(
+    MPPoolHandle pool,
+    MPResultsBuffer* buffer,
+    uint32_t* stream_id,
+    uint64_t* user_tag,
+    int timeout_ms,
+    MPError* error
+) {
+    ErrorScope scope(error, nullptr);
+    if (!pool) {
+        SetError(20, "Invalid handle");
+        return -1;
+    }
+    if (!buffer) {
+        SetError(21, "Results buffer is null");
+        return -1;
+    }
+
+    return static_cast<ProcessorPool*>(pool)->Poll(buffer, stream_id, user_tag, timeout_ms);
+}
+
+MPShmReader* MP_ShmOpen(const char* name) {
+    if (!name) {
+        SetError(1, "Invalid arguments");
+        return nullptr;
+    }
+    int code = 0;
+    std::string message;
+    auto reader = ShmRingReader::Open(name, &code, &message);
+    if (!reader) {
+        SetError(code, message);
+        return nullptr;
+    }
+    ClearError();
+    return reinterpret_cast<MPShmReader*>(reader.release());
+}
+
+const MPShmFrame* MP_ShmNext(MPShmReader* reader, uint64_t* sequence) {
+    if (!reader || !sequence) {
+        SetError(1, "Invalid arguments");
+        return nullptr;
+    }
+    ClearError();
+    return reinterpret_cast<ShmRingReader*>(reader)->Next(/*latest=*/false, sequence);
+}
+
+const MPShmFrame* MP_ShmLatest(MPShmReader* reader, uint64_t* sequence) {
+    if (!reader || !sequence) {
+        SetError(1, "Invalid arguments");
+        return nullptr;
+    }
+    ClearError();
+    return reinterpret_cast<ShmRingReader*>(reader)->Next(/*latest=*/true, sequence);
+}
+
+bool MP_ShmValid(const MPShmReader* reader, const MPShmFrame* frame, uint64_t sequence) {
+    return reader && frame &&
+           reinterpret_cast<const ShmRingReader*>(reader)->Valid(frame, sequence);
+}
+
+bool MP_ShmRead(MPShmReader* reader, MPShmFrame* frame) {
+    if (!reader || !frame) {
+        SetError(1, "Invalid arguments");
+        return false;
+    }
+    ClearError();
+    auto* ring = reinterpret_cast<ShmRingReader*>(reader);
+    // A torn copy means the writer lapped this reader; the retry skips ahead
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        uint64_t sequence = 0;
+        const MPShmFrame* slot = ring->Next(/*latest=*/false, &sequence);
+        if (!slot) {
+            return false;
+        }
+        memcpy(frame, slot, sizeof(MPShmFrame));
+        if (ring->Valid(slot, sequence)) {
+            frame->sequence = sequence;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MP_ShmWriterClosed(const MPShmReader* reader) {
+    return !reader || reinterpret_cast<const ShmRingReader*>(reader)->WriterClosed();
+}
+
+void MP_ShmClose(MPShmReader* reader) {
+    delete reinterpret_cast<ShmRingReader*>(reader);
+}
+
+bool MP_RecordStart(MPHandle handle, const char* path) {
+    ErrorScope scope(nullptr, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+    if (!path) {
+        SetError(1, "Invalid arguments");
+        return false;
+    }
+    return static_cast<MediaPipeProcessor*>(handle)->StartRecording(path);
+}
+
+bool MP_RecordStop(MPHandle handle) {
+    ErrorScope scope(nullptr, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+    return static_cast<MediaPipeProcessor*>(handle)->StopRecording();
+}
+
+MPRecording* MP_RecordingOpen(const char* path) {
+    if (!path) {
+        SetError(1, "Invalid arguments");
+        return nullptr;
+    }
+    int code = 0;
+    std::string message;
+    auto recording = RecordingReader::Open(path, &code, &message);
+    if (!recording) {
+        SetError(code, message);
+        return nullptr;
+    }
+    ClearError();
+    return reinterpret_cast<MPRecording*>(recording.release());
+}
+
+bool MP_RecordingGetInfo(const MPRecording* recording, MPRecordingInfo* info) {
+    if (!recording || !info) {
+        SetError(1, "Invalid arguments");
+        return false;
+    }
+    reinterpret_cast<const RecordingReader*>(recording)->GetInfo(info);
+    ClearError();
+    return true;
+}
+
+int MP_RecordingNext(MPRecording* recording, MPResultsBuffer* buffer) {
+    if (!recording || !buffer) {
+        SetError(1, "Invalid arguments");
+        return -1;
+    }
+    const int decoded = reinterpret_cast<RecordingReader*>(recording)->Next(buffer);
+    if (decoded < 0) {
+        SetError(85, "Corrupt recording chunk");
+    } else {
+        ClearError();
+    }
+    return decoded;
+}
+
+bool MP_RecordingSeek(MPRecording* recording, int64_t timestamp_us) {
+    if (!recording) {
+        SetError(1, "Invalid arguments");
+        return false;
+    }
+    if (!reinterpret_cast<RecordingReader*>(recording)->Seek(timestamp_us)) {
+        SetError(85, "Corrupt recording chunk");
+        return false;
+    }
+    ClearError();
+    return true;
+}
+
+void MP_RecordingClose(MPRecording* recording) {
+    delete reinterpret_cast<RecordingReader*>(recording);
+}
+
+void MP_DestroyPool(MPPoolHandle pool) {
+    delete static_cast<ProcessorPool*>(pool);
+}
+
+bool MP_GetStats(MPHandle handle, MPStats* stats) {
+    ErrorScope scope(nullptr, HandleErrors(handle));
+    if (!handle) {
+        SetError(20, "Invalid handle");
+        return false;
+    }
+    if (!stats) {
+        SetError(1, "Invalid arguments");
+        return false;
+    }
+
+    auto* processor = static_cast<MediaPipeProcessor*>(handle);
+    processor->GetStats(stats);
+    ClearError();
+    return true;
+}
+
+MPError MP_GetLastError(MPHandle handle) {
+    return handle ? HandleErrors(handle)->Load() : g_last_error;
+}
+
+void MP_Destroy(MPHandle handle) {
+    if (handle) {
+        auto* processor = static_cast<MediaPipeProcessor*>(handle);
+        delete processor;
+    }
+}
+
+const char* MP_GetBlendshapeName(int index) {
+    return BlendshapeName(index);
+}
+
+const char* MP_GetVersion(void) {
+#if defined(MP_BUILD_PRECISION_INT8)
+    return "MediaPipe Bridge v1.0.0 (int8 models)";
+#elif defined(MP_BUILD_PRECISION_FP16)
+    return "MediaPipe Bridge v1.0.0 (fp16 models)";
+#else
+    return "MediaPipe Bridge v1.0.0";
+#endif
+}
+
+bool MP_IsGPUAvailable(void) {
 #ifdef MEDIAPIPE_GPU_ENABLED
     return true;
 #else
     return false;
 #endif
 }
+
+uint32_t MP_QueryBackends(void) {
+    // TFLite's CPU kernels and XNNPACK are part of every MediaPipe build
+    uint32_t backends = MP_BACKEND_BIT(MP_BACKEND_DEFAULT) |
+                        MP_BACKEND_BIT(MP_BACKEND_TFLITE_CPU) |
+                        MP_BACKEND_BIT(MP_BACKEND_XNNPACK);
+#ifdef MEDIAPIPE_GPU_ENABLED
+    backends |= MP_BACKEND_BIT(MP_BACKEND_GPU);
+#endif
+#ifdef __ANDROID__
+    backends |= MP_BACKEND_BIT(MP_BACKEND_NNAPI);
+#endif
+    return backends;
+}
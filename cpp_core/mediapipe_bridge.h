@@ -10,11 +10,178 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Opaque handle to processor instance
 typedef void* MPHandle;
 
+// Opaque handle to a pool of processor instances
+typedef void* MPPoolHandle;
+
+// Output selection bits for MPConfig::enabled_outputs
+// Subgraphs that no enabled output depends on are left out of the graph.
+// Hands are located from the pose, so either hand bit keeps pose tracking.
+#define MP_OUTPUT_FACE       (1u << 0)
+#define MP_OUTPUT_POSE       (1u << 1)
+#define MP_OUTPUT_POSE_WORLD (1u << 2)
+#define MP_OUTPUT_LEFT_HAND  (1u << 3)
+#define MP_OUTPUT_RIGHT_HAND (1u << 4)
+#define MP_OUTPUT_ALL        0x1Fu
+
+// Ownership of the pixels passed to MP_Process / MP_ProcessInto
+typedef enum {
+    // Pixels are copied once into a bridge-owned frame; the caller's buffer
+    // is free as soon as the call starts processing.
+    MP_INPUT_POOLED = 0,
+    // Pixels are handed to the graph without a copy. The call does not
+    // return until the graph has released the frame, so the buffer must stay
+    // valid and unmodified for the whole call.
+    MP_INPUT_BORROWED = 1,
+} MPInputOwnership;
+
+// Memory layout of the landmarks in MPResults
+typedef enum {
+    // One MPLandmark struct per point (face_landmarks, ...)
+    MP_LAYOUT_AOS = 0,
+    // One contiguous float plane per field (face_planes, ...), every plane
+    // 64-byte aligned inside a single block
+    MP_LAYOUT_SOA = 1,
+} MPLandmarkLayout;
+
+// Landmark smoothing applied by the bridge, after MediaPipe's own
+typedef enum {
+    MP_SMOOTHING_NONE = 0,
+    MP_SMOOTHING_ONE_EURO = 1,  // speed-adaptive low-pass
+    MP_SMOOTHING_KALMAN = 2,    // constant-velocity Kalman filter
+} MPSmoothingFilter;
+
+// Smoothing parameters; zero selects the default. Coordinates are in
+// landmark units (normalized image units, meters for world landmarks).
+typedef struct {
+    MPSmoothingFilter filter;
+    float min_cutoff;        // One-Euro: cutoff at rest in Hz (default 1.0)
+    float beta;              // One-Euro: cutoff increase per unit/s of speed (default 10)
+    float derivative_cutoff; // One-Euro: speed low-pass cutoff in Hz (default 1.0)
+    float process_noise;     // Kalman: acceleration noise density (default 0.01)
+    float measurement_noise; // Kalman: measurement variance (default 1e-5)
+} MPSmoothingConfig;
+
+// Value encoding of compact landmarks (MPOutputProjection)
+typedef enum {
+    MP_COMPACT_FLOAT32 = 0,
+    MP_COMPACT_INT16 = 1,  // value * MP_INT16_SCALE, rounded and saturated
+} MPCompactFormat;
+
+// int16 compact values cover [-2, 2) in steps of 1/16384
+#define MP_INT16_SCALE 16384.0f
+
+// Per-part index count: no landmarks at all (blendshapes and head pose are
+// still solved)
+#define MP_PROJECTION_NONE (-1)
+
+// Reduced landmark output. While any field is set, results carry only the
+// selected landmarks, packed into MPResults::compact_landmarks, and the
+// full *_landmarks / *_planes arrays are NULL.
+typedef struct {
+    const int* face_indices;  // face mesh indices to keep
+    int face_index_count;     // 0 = all, MP_PROJECTION_NONE = none
+    const int* hand_indices;  // hand indices, applied to both hands
+    int hand_index_count;
+    const int* pose_indices;  // pose indices, applied to pose and pose world
+    int pose_index_count;
+    bool drop_scores;         // omit visibility and presence
+    MPCompactFormat format;
+} MPOutputProjection;
+
+// Graph input downscaling and region-of-interest cropping (zeroed = whole
+// frames at native resolution). While someone is tracked, frames are
+// cropped to a padded box around the previous results' landmarks and sent
+// at up to `roi_size`; when the pose's tracking confidence falls below
+// min_tracking_confidence, frames go in whole, at up to `full_frame_size`,
+// until detection finds someone again. Landmarks are always reported in
+// full-frame coordinates. Applies to CPU frames, not MP_ProcessTexture or
+// MP_ProcessDmaBuf.
+typedef struct {
+    int full_frame_size;  // longest side of whole frames, pixels (0 = native)
+    int roi_size;         // longest side of crops, pixels (0 = never crop)
+    float roi_margin;     // box padding per side, fraction of the subject's extent (0 = 0.25)
+} MPInputScaling;
+
+// Latency-driven pipeline selection (zeroed = fixed pipeline). Tiers run
+// from min_model_complexity without face refinement up to MPConfig's own
+// model_complexity / refine_face_landmarks. When the rolling p90 latency
+// misses the target the bridge steps down a tier; after sustained headroom
+// it steps back up. The neighbouring tiers' graphs are kept running, so a
+// switch never waits for models to load (it does drop the new graph's
+// tracking state, so the next frame runs detection).
+typedef struct {
+    float target_latency_ms;   // per-frame budget, e.g. 16.6 to hold 60 fps (0 = off)
+    int min_model_complexity;  // cheapest model allowed (0 = Lite)
+    bool keep_refinement;      // never turn refine_face_landmarks off
+} MPAdaptiveComplexity;
+
+// Graph threading (zeroed = MediaPipe defaults). The executor runs the
+// calculators; each TFLite model runs on inference_threads threads of its
+// own, created from an executor thread. With several handles per host,
+// bounding both and sharing one executor avoids oversubscribing cores.
+typedef struct {
+    int executor_threads;   // calculator threads (0 = cores in cpu_affinity, else MediaPipe default)
+    int inference_threads;  // TFLite / XNNPACK threads per model (0 = MediaPipe default)
+    uint64_t cpu_affinity;  // bit per core for executor and inference threads (0 = any core)
+    bool shared;            // handles with equal threads and affinity share one executor
+} MPThreading;
+
+// How the models run, for MPConfig::inference_backend. MP_QueryBackends
+// reports which ones this build supports.
+typedef enum {
+    MP_BACKEND_DEFAULT = 0,     // each model's delegate from the graph (XNNPACK on CPU builds, GPU on GPU builds)
+    MP_BACKEND_TFLITE_CPU = 1,  // built-in TFLite CPU kernels, no delegate
+    MP_BACKEND_XNNPACK = 2,     // XNNPACK CPU delegate
+    MP_BACKEND_GPU = 3,         // TFLite GPU delegate (GPU builds)
+    MP_BACKEND_NNAPI = 4,       // Android NNAPI delegate (Android builds)
+} MPInferenceBackend;
+
+// Model weight precision, for MPConfig::precision. MediaPipe ships float
+// models; a lower precision loads "<model>_fp16.tflite" / "<model>_int8.tflite"
+// in place of each "<model>.tflite" that has such a variant installed next
+// to it or bundled into the build (bazel --define model_precision=fp16|int8,
+// from cpp_core/models). Models without a variant run as shipped; MPStats
+// counts both.
+typedef enum {
+    MP_PRECISION_DEFAULT = 0,  // the build's --define model_precision, else float
+    MP_PRECISION_FLOAT = 1,    // models as shipped
+    MP_PRECISION_FP16 = 2,
+    MP_PRECISION_INT8 = 3,
+} MPModelPrecision;
+
+// Bit of an MPInferenceBackend in the MP_QueryBackends mask
+#define MP_BACKEND_BIT(backend) (1u << (backend))
+
+// Shared-memory results ring for other local processes (see MP_ShmOpen)
+// Every frame's results are written to the POSIX shared memory object
+// `name` as they are fetched, including by MP_PollResults and the result
+// callback. The object is removed when the handle is destroyed.
+typedef struct {
+    const char* name;  // shm_open name such as "/miface" (NULL = off)
+    int slots;         // frames kept for readers (0 = 8)
+} MPShmConfig;
+
+// Inference skipping for near-still input (zeroed = off). MP_Process,
+// MP_ProcessInto, MP_ProcessEx and MP_ProcessAt compare each frame's
+// downsampled luma with the last frame that ran the graph; while the
+// difference stays under motion_threshold in every part of the image and
+// the landmarks of the last two inferred frames moved slower than
+// max_velocity, up to max_skip frames in a row skip the graph. Their
+// results are the last landmarks continued along that motion (for at most
+// 100 ms), with MPResults::predicted set. Other entry points always run
+// the graph.
+typedef struct {
+    int max_skip;            // consecutive frames answered without the graph (0 = off)
+    float motion_threshold;  // largest mean luma change of any image cell, 0-255 (0 = 4)
+    float max_velocity;      // fastest landmark, normalized units per second (0 = 0.5)
+} MPMotionGating;
+
 // Configuration options
 typedef struct {
     int model_complexity;           // 0=Lite, 1=Full, 2=Heavy
@@ -24,8 +191,57 @@ typedef struct {
     bool smooth_landmarks;          // temporal smoothing
     bool refine_face_landmarks;     // enable face mesh refinement
     bool enable_segmentation;       // enable person segmentation
+    int max_frames_in_flight;       // async pipelining depth (0 = 1)
+    uint32_t enabled_outputs;       // MP_OUTPUT_* mask (0 = MP_OUTPUT_ALL)
+    void* shared_gl_context;        // GPU builds: EGLContext to share textures with (NULL = own context)
+    MPInputOwnership input_ownership; // how MP_Process treats caller pixels
+    int input_pool_size;            // recycled input frames (0 = max_frames_in_flight + 2)
+    bool offline_mode;              // no frame dropping: keep tracking but process every frame
+    bool enable_profiling;          // collect per-calculator timing for MP_GetStats
+    bool realtime_mode;             // MP_SubmitFrame keeps only the newest waiting frame
+    MPLandmarkLayout landmark_layout; // AoS structs or SoA planes in MPResults
+    MPSmoothingConfig smoothing;    // bridge-side landmark filter (zeroed = off)
+    MPOutputProjection projection;  // compact landmark output (zeroed = full output)
+    MPInputScaling input_scaling;   // downscale / ROI-crop graph input (zeroed = off)
+    MPAdaptiveComplexity adaptive_complexity; // latency-driven tier switching (zeroed = off)
+    MPThreading threading;          // executor / inference threads and affinity (zeroed = defaults)
+    MPInferenceBackend inference_backend; // delegate for every model (MP_BACKEND_DEFAULT = graph's own)
+    MPModelPrecision precision;     // model variants to load (MP_PRECISION_DEFAULT = build default)
+    MPShmConfig shm_publish;        // results ring for other processes (zeroed = off)
+    MPMotionGating motion_gating;   // skip inference on near-still frames (zeroed = off)
 } MPConfig;
 
+// Input pixel layouts accepted by MP_ProcessEx
+// Planar formats store their planes back to back: the chroma plane(s)
+// start right after `height` rows of luma.
+typedef enum {
+    MP_PIXEL_RGB24 = 0,  // R, G, B
+    MP_PIXEL_BGR24 = 1,  // B, G, R (OpenCV default)
+    MP_PIXEL_RGBA = 2,   // R, G, B, A (alpha ignored)
+    MP_PIXEL_NV12 = 3,   // Y plane + interleaved UV plane at half resolution
+    MP_PIXEL_YUYV = 4,   // Y0, U, Y1, V per pixel pair (V4L2 YUYV / YUY2)
+    MP_PIXEL_I420 = 5,   // Y plane + U plane + V plane, chroma at half resolution
+    MP_PIXEL_MJPEG = 6,  // one compressed JPEG image of `data_size` bytes
+} MPPixelFormat;
+
+// Frame flags
+#define MP_FRAME_MIRROR (1u << 0)  // flip horizontally while converting
+
+// Input frame description
+// YUV formats are converted with BT.601 limited-range coefficients.
+typedef struct {
+    const uint8_t* pixels;  // first plane (or JPEG data)
+    int width;              // pixels
+    int height;             // pixels
+    int stride;             // bytes per luma/packed row (0 = tightly packed);
+                            // NV12 UV rows share it, so it is at least the
+                            // width rounded up to even; I420 chroma rows are
+                            // (stride + 1) / 2 bytes
+    MPPixelFormat format;
+    uint32_t flags;         // MP_FRAME_* bits
+    int data_size;          // bytes at `pixels` (required for MJPEG only)
+} MPFrame;
+
 // Single 3D landmark point
 typedef struct {
     float x;          // Normalized [0, 1]
@@ -35,6 +251,20 @@ typedef struct {
     float presence;   // [0, 1] - is landmark present
 } MPLandmark;
 
+// Structure-of-arrays view of one landmark set (MP_LAYOUT_SOA)
+// Each plane holds the set's count of values, padded to a multiple of 16
+// floats, and starts on a 64-byte boundary.
+typedef struct {
+    float* x;
+    float* y;
+    float* z;
+    float* visibility;
+    float* presence;
+} MPLandmarkPlanes;
+
+// ARKit-style blendshape coefficients per face, see MP_GetBlendshapeName
+#define MP_NUM_BLENDSHAPES 52
+
 // Processing results
 typedef struct {
     // Face mesh landmarks (468 or 478 with refinement)
@@ -58,56 +288,579 @@ typedef struct {
     int pose_world_count;
 
     // Processing metadata
-    int64_t timestamp_ms;
+    int64_t timestamp_ms;           // timestamp_us / 1000
+    int64_t timestamp_us;           // graph timestamp: capture time for MP_ProcessAt,
+                                    // otherwise the steady clock at submission
     float processing_time_ms;
     bool face_detected;
     bool hands_detected;
     bool pose_detected;
+
+    // MP_LAYOUT_SOA only: planes for the sets above, whose *_landmarks
+    // pointers are then NULL. The counts apply unchanged. All planes live in
+    // one block, which is set even for sets that were not detected.
+    MPLandmarkPlanes face_planes;
+    MPLandmarkPlanes left_hand_planes;
+    MPLandmarkPlanes right_hand_planes;
+    MPLandmarkPlanes pose_planes;
+    MPLandmarkPlanes pose_world_planes;
+
+    // Expression and head pose solved from the face landmarks; zero and
+    // identity when no face was detected
+    float blendshapes[MP_NUM_BLENDSHAPES]; // [0, 1], ARKit order
+    float head_rotation[4];     // unit quaternion x, y, z, w: face model to camera
+    float head_translation[3];  // meters; camera space, x right, y up, z toward
+                                // the viewer (assumes a 60 degree horizontal FOV)
+
+    // MPConfig::projection only: the selected landmarks of every set, back
+    // to back in the order above, `compact_stride` bytes each. Every
+    // landmark is x, y, z [, visibility, presence] in MPConfig's compact
+    // format. A detected set holds exactly its selected indices, in the
+    // order given (zeros for indices it lacks); *_count is 0 otherwise.
+    void* compact_landmarks;
+    int compact_stride;
+
+    // Pipeline that produced these results (see MPAdaptiveComplexity)
+    int model_complexity;
+    bool refine_face_landmarks;
+
+    // MPConfig::motion_gating skipped the graph: landmarks are extrapolated
+    bool predicted;
 } MPResults;
 
+// Fixed landmark capacities for caller-owned result buffers
+#define MP_MAX_FACE_LANDMARKS 478  // 468 + 10 iris points with refinement
+#define MP_MAX_HAND_LANDMARKS 21
+#define MP_MAX_POSE_LANDMARKS 33
+
+// MP_LAYOUT_SOA plane capacities: the limits above rounded up to whole
+// 64-byte cache lines
+#define MP_SOA_FACE_CAPACITY 480
+#define MP_SOA_HAND_CAPACITY 32
+#define MP_SOA_POSE_CAPACITY 48
+#define MP_SOA_BLOCK_FLOATS (5 * (MP_SOA_FACE_CAPACITY + 2 * MP_SOA_HAND_CAPACITY + \
+                                  2 * MP_SOA_POSE_CAPACITY))
+
+// Compact output of every landmark at the widest format
+#define MP_COMPACT_STORAGE_BYTES (5 * sizeof(float) * (MP_MAX_FACE_LANDMARKS + \
+                                  2 * MP_MAX_HAND_LANDMARKS + 2 * MP_MAX_POSE_LANDMARKS))
+
+// Preallocated result storage, filled in place by MP_ProcessInto.
+// The landmark pointers in `results` point into the storage arrays below,
+// so the buffer must not be copied by value while results are in use.
+typedef struct {
+    MPResults results;
+
+    MPLandmark face_storage[MP_MAX_FACE_LANDMARKS];
+    MPLandmark left_hand_storage[MP_MAX_HAND_LANDMARKS];
+    MPLandmark right_hand_storage[MP_MAX_HAND_LANDMARKS];
+    MPLandmark pose_storage[MP_MAX_POSE_LANDMARKS];
+    MPLandmark pose_world_storage[MP_MAX_POSE_LANDMARKS];
+
+    // MP_LAYOUT_SOA planes; the block starts at the first 64-byte boundary
+    // inside, so the buffer may live in any allocation
+    float soa_storage[MP_SOA_BLOCK_FLOATS + 16];
+
+    // MPConfig::projection output
+    uint8_t compact_storage[MP_COMPACT_STORAGE_BYTES];
+} MPResultsBuffer;
+
+// Shared-memory ring layout (MPConfig::shm_publish). The object holds an
+// MPShmHeader followed by `slot_count` slots, `slot_stride` bytes apart,
+// each starting with an MPShmFrame. Readers should use MP_ShmOpen and
+// friends rather than this layout; it only changes with MP_SHM_VERSION.
+#define MP_SHM_MAGIC 0x4853504Du  // "MPSH"
+#define MP_SHM_VERSION 1
+
+typedef struct {
+    uint32_t magic;           // MP_SHM_MAGIC
+    uint32_t version;         // MP_SHM_VERSION
+    uint32_t frame_size;      // sizeof(MPShmFrame)
+    uint32_t slot_stride;     // bytes from one slot to the next
+    uint32_t slot_count;
+    int32_t writer_pid;
+    uint64_t write_sequence;  // newest complete frame (0 = none yet)
+    uint32_t closed;          // nonzero once the writer has gone away
+    uint32_t reserved[7];
+} MPShmHeader;
+
+// One frame of results, without pointers. The layout follows MPResults;
+// landmarks are always full structs, whatever MPConfig::landmark_layout
+// and MPConfig::projection give the publishing handle itself.
+typedef struct {
+    uint64_t sequence;        // frame number from 1; changes while rewritten
+    int64_t timestamp_us;
+    float processing_time_ms;
+    uint8_t face_detected;
+    uint8_t hands_detected;
+    uint8_t pose_detected;
+    uint8_t refine_face_landmarks;
+    int32_t model_complexity;
+    int32_t face_count;
+    int32_t left_hand_count;
+    int32_t right_hand_count;
+    int32_t pose_count;
+    int32_t pose_world_count;
+    float blendshapes[MP_NUM_BLENDSHAPES];
+    float head_rotation[4];
+    float head_translation[3];
+    MPLandmark face_landmarks[MP_MAX_FACE_LANDMARKS];
+    MPLandmark left_hand_landmarks[MP_MAX_HAND_LANDMARKS];
+    MPLandmark right_hand_landmarks[MP_MAX_HAND_LANDMARKS];
+    MPLandmark pose_landmarks[MP_MAX_POSE_LANDMARKS];
+    MPLandmark pose_world_landmarks[MP_MAX_POSE_LANDMARKS];
+} MPShmFrame;
+
+// Opaque reader of a shared-memory results ring
+typedef struct MPShmReader MPShmReader;
+
+// Opaque reader of a file written by MP_RecordStart
+typedef struct MPRecording MPRecording;
+
+// Summary of a recording
+typedef struct {
+    int64_t frame_count;
+    int chunk_count;             // seek granularity: frames decode from a chunk start
+    int64_t first_timestamp_us;
+    int64_t last_timestamp_us;
+    bool complete;               // false if the recorder never finished (e.g. crashed);
+                                 // every whole chunk is still readable
+} MPRecordingInfo;
+
+// Completion callback for frames queued with MP_SubmitFrame
+// Runs on a MediaPipe graph thread; `results` is only valid for the
+// duration of the call. Calls for one handle never overlap and arrive in
+// submission order. Must not call MP_Destroy on the same handle.
+typedef void (*MP_ResultCallback)(
+    const MPResults* results,
+    uint64_t user_tag,
+    void* user_data
+);
+
+// Completion callback for frames queued with MP_PoolSubmit
+// Runs on a pool worker thread; results for different streams may be
+// delivered concurrently, results for one stream arrive in order.
+// `results` is only valid for the duration of the call.
+typedef void (*MP_PoolResultCallback)(
+    const MPResults* results,
+    uint32_t stream_id,
+    uint64_t user_tag,
+    void* user_data
+);
+
+// Timing of one graph node, from MediaPipe's graph profiler
+// Percentiles come from the profiler's histogram and are reported at the
+// upper edge of their 0.25 ms bucket.
+typedef struct {
+    char name[96];           // node name, e.g. "facelandmarkcpu__..."
+    uint64_t invocations;    // Process() calls
+    float mean_ms;
+    float p50_ms;
+    float p95_ms;
+    float p99_ms;
+} MPCalculatorStats;
+
+#define MP_MAX_CALCULATOR_STATS 64
+
+// Processor counters and latency statistics for MP_GetStats
+typedef struct {
+    uint64_t frames_submitted;  // frames that entered the graph
+    uint64_t frames_completed;  // frames whose outputs have all settled
+    uint64_t frames_dropped;    // frames discarded by the flow limiter
+    uint64_t frames_superseded; // realtime mode: replaced by a newer frame before entering the graph
+    uint64_t input_pool_misses; // input frames allocated outside the pool
+    uint64_t frames_cropped;    // input_scaling: frames sent as a region-of-interest crop
+    uint64_t tier_switches;     // adaptive_complexity: pipeline changes
+    int model_complexity;       // pipeline new frames are sent to
+    bool refine_face_landmarks;
+    int mapped_models;          // process-wide: model files mapped, shared by all handles
+    uint64_t mapped_model_bytes;
+    MPModelPrecision precision; // resolved MPConfig::precision
+    int variant_models;         // model loads served at `precision`
+    int fallback_models;        // model loads without a variant, run as shipped
+    uint64_t frames_recorded;   // MP_RecordStart: frames written to the current recording
+    uint64_t frames_record_dropped; // ... and dropped because the disk fell behind
+    uint64_t frames_predicted;  // motion_gating: frames answered without the graph
+    int frames_in_flight;       // submitted but not yet completed
+    int results_queued;         // completed async frames awaiting MP_PollResults
+
+    // End-to-end latency over the most recent frames
+    float latency_p50_ms;
+    float latency_p95_ms;
+    float latency_p99_ms;
+
+    // Per-node timing, most total time first (requires enable_profiling)
+    int calculator_count;
+    MPCalculatorStats calculators[MP_MAX_CALCULATOR_STATS];
+} MPStats;
+
 // Error handling
+// Frame calls take an `error` out-parameter (may be NULL) that receives
+// that call's outcome, so it is exact however many threads share a handle
+// and whichever thread the caller resumes on. Every failure is also kept
+// per handle and per calling thread for MP_GetLastError.
 typedef struct {
     int code;              // 0 = success, non-zero = error
     char message[256];     // Error message
 } MPError;
 
+// Thread safety: any number of threads may call into one MPHandle at once,
+// each with its own MPResultsBuffer / MPResults, except MP_Destroy, which
+// must come after every other call on the handle has returned. Frames of
+// concurrent calls enter the graph one at a time, in the order their
+// timestamps are assigned, and concurrent MP_ProcessAt callers must still
+// present increasing capture times in that order (error 5). Smoothing is
+// applied in completion order, so with MPConfig::smoothing a frame whose
+// results are fetched after a newer frame's passes through unsmoothed.
+
 // ============================================================================
 // API Functions
 // ============================================================================
 
 // Initialize MediaPipe processor
 // Returns handle on success, NULL on failure
-// Call MP_GetLastError() to get error details
+// Call MP_GetLastError(NULL) to get error details
 MPHandle MP_Create(const MPConfig* config);
 
+// Same as MP_Create, but runs a caller-supplied CalculatorGraphConfig
+// instead of the built-in holistic graph.
+// graph: with graph_size 0, a NUL-terminated path to a text (.pbtxt) or
+//        binary (.binarypb) graph file; otherwise graph_size bytes of
+//        either form. Binary graphs skip text parsing at startup.
+// The graph takes "input_video" (ImageFrame on CPU builds, GpuBuffer on
+// GPU builds), produces any of "face_landmarks", "pose_landmarks",
+// "pose_world_landmarks", "left_hand_landmarks" and "right_hand_landmarks",
+// and may declare the side packets the built-in graph takes (see
+// holistic_config.cc); config still selects outputs and sets those side
+// packets. A flow limiter whose output is "throttled_input_video" is
+// reported in MPStats::frames_dropped.
+// Returns NULL on failure (error 13: graph unreadable or not a graph)
+MPHandle MP_CreateFromGraph(const MPConfig* config, const void* graph, size_t graph_size);
+
+// Run a few blank frames of the given size through the graph so the first
+// real frame does not pay for kernel, arena and shader setup. Results are
+// discarded and smoothing, ROI, adaptive complexity and stats are left
+// untouched; with adaptive complexity only the active tier is warmed.
+// Warm-up frames take graph timestamps 0-2 on a new handle, so frames of
+// MP_ProcessAt must then start above 2.
+// Returns true on success, false on failure
+bool MP_Warmup(MPHandle handle, int width, int height);
+
 // Process RGB image frame
 // pixels: RGB24 byte array (width * height * 3)
 // width, height: image dimensions
 // results: output structure (caller must call MP_ReleaseResults after use)
+// error: receives this call's outcome (may be NULL)
+// The pixels are copied or borrowed according to MPConfig::input_ownership.
 // Returns true on success, false on failure
 bool MP_Process(
     MPHandle handle,
     const uint8_t* pixels,
     int width,
     int height,
-    MPResults* results
+    MPResults* results,
+    MPError* error
+);
+
+// Process a frame in any MPPixelFormat
+// Conversion to RGB (and mirroring) happens in one vectorized pass straight
+// into the graph's input frame, so the caller needn't convert first.
+// buffer: receives the results (see MP_ProcessInto)
+// Returns true on success, false on failure
+bool MP_ProcessEx(
+    MPHandle handle,
+    const MPFrame* frame,
+    MPResultsBuffer* buffer,
+    MPError* error
+);
+
+// Process a frame stamped with its camera capture time
+// capture_timestamp_us: capture time in microseconds, strictly increasing
+// per handle (e.g. the V4L2 buffer timestamp). It is used as the graph
+// timestamp, so smoothing and tracking see the real frame intervals, and
+// it is returned in buffer->results.timestamp_us. Frames sent without a
+// capture time are stamped with CLOCK_MONOTONIC, so do not mix the two on
+// one handle unless the capture clock is CLOCK_MONOTONIC as well.
+// Returns true on success, false on failure (error 5: timestamp not increasing)
+bool MP_ProcessAt(
+    MPHandle handle,
+    const MPFrame* frame,
+    int64_t capture_timestamp_us,
+    MPResultsBuffer* buffer,
+    MPError* error
+);
+
+// Process an RGBA GL texture without copying it to host memory
+// GPU builds only (libmediapipe_bridge_gpu.so); CPU builds return false.
+// gl_texture: GL_TEXTURE_2D name from MPConfig::shared_gl_context's share
+//             group; must stay valid and unmodified until the call returns
+// buffer: receives the results (see MP_ProcessInto)
+// Returns true on success, false on failure
+bool MP_ProcessTexture(
+    MPHandle handle,
+    uint32_t gl_texture,
+    int width,
+    int height,
+    MPResultsBuffer* buffer,
+    MPError* error
+);
+
+// Process a single-plane DMA-BUF frame (imported via EGL, zero-copy)
+// GPU builds only (libmediapipe_bridge_gpu.so); CPU builds return false.
+// fd: DMA-BUF file descriptor, still owned by the caller
+// stride: bytes per row
+// drm_fourcc: DRM_FORMAT_* code, e.g. DRM_FORMAT_ABGR8888
+// buffer: receives the results (see MP_ProcessInto)
+// Returns true on success, false on failure
+bool MP_ProcessDmaBuf(
+    MPHandle handle,
+    int fd,
+    int width,
+    int height,
+    int stride,
+    uint32_t drm_fourcc,
+    MPResultsBuffer* buffer,
+    MPError* error
+);
+
+// Process a span of frames in one call, e.g. recorded footage
+// Frames are pipelined through the graph; results[i] receives the results
+// of frames[i] (see MP_ProcessInto).
+// capture_timestamps_us: capture time of each frame, as for MP_ProcessAt,
+// strictly increasing (error 5 otherwise). Pass them for recorded footage
+// so smoothing and tracking see its real frame rate. NULL stamps each frame
+// with the steady clock as it is submitted.
+// Up to input_pool_size frames are kept in flight, so create the handle with
+// offline_mode set and a larger input_pool_size to keep the graph saturated;
+// otherwise at most max_frames_in_flight are, so the flow limiter drops none.
+// Returns the number of leading frames processed; less than `count` means
+// processing stopped at frames[return value] (see `error`)
+int MP_ProcessBatch(
+    MPHandle handle,
+    const MPFrame* frames,
+    int count,
+    const int64_t* capture_timestamps_us,
+    MPResultsBuffer* results,
+    MPError* error
+);
+
+// Queue RGB image frame for asynchronous processing
+// Returns as soon as the frame is in the graph; pixels are copied, so the
+// caller may reuse them immediately. Results are delivered in submission
+// order to the callback set with MP_SetResultCallback, or to the queue
+// drained by MP_PollResults if no callback is set.
+// With MPConfig::realtime_mode the frame instead waits in a single-slot
+// mailbox until the graph has room; a newer frame replaces it (counted in
+// MPStats::frames_superseded), so results are always for the freshest frame
+// and some tags never come back.
+// user_tag: opaque value handed back with the frame's results
+// Returns true on success, false on failure
+bool MP_SubmitFrame(
+    MPHandle handle,
+    const uint8_t* pixels,
+    int width,
+    int height,
+    uint64_t user_tag,
+    MPError* error
+);
+
+// Register completion callback for MP_SubmitFrame (NULL = use MP_PollResults)
+// Returns true on success, false on failure
+bool MP_SetResultCallback(
+    MPHandle handle,
+    MP_ResultCallback callback,
+    void* user_data
+);
+
+// Take the oldest completed frame queued with MP_SubmitFrame
+// buffer: receives the results (see MP_ProcessInto)
+// user_tag: receives the tag passed to MP_SubmitFrame (may be NULL)
+// timeout_ms: maximum wait, 0 = don't block, negative = wait forever
+// Returns 1 if a result was written, 0 on timeout, -1 on error
+int MP_PollResults(
+    MPHandle handle,
+    MPResultsBuffer* buffer,
+    uint64_t* user_tag,
+    int timeout_ms,
+    MPError* error
 );
 
 // Release memory allocated for results
 void MP_ReleaseResults(MPResults* results);
 
+// Allocate a result buffer once, up front, for use with MP_ProcessInto
+// Returns NULL on allocation failure
+MPResultsBuffer* MP_CreateResultsBuffer(void);
+
+// Free a buffer returned by MP_CreateResultsBuffer
+void MP_DestroyResultsBuffer(MPResultsBuffer* buffer);
+
+// Process RGB image frame without allocating
+// Same as MP_Process, but landmarks are written into `buffer` and
+// buffer->results is valid until the next call with the same buffer.
+// Do NOT call MP_ReleaseResults on buffer->results.
+// Returns true on success, false on failure
+bool MP_ProcessInto(
+    MPHandle handle,
+    const uint8_t* pixels,
+    int width,
+    int height,
+    MPResultsBuffer* buffer,
+    MPError* error
+);
+
+// Create `n_instances` processors sharing one configuration, each driven
+// by its own worker thread. MPThreading::cpu_affinity (0 = every core) is
+// split into one disjoint slice per instance; an instance's executor,
+// inference threads (inference_threads = 0: one per core of the slice) and
+// worker all run on its slice. Use one instance per camera stream for full
+// tracking; streams beyond that share instances.
+// MPConfig::smoothing state is kept per stream, not per instance.
+// Returns handle on success, NULL on failure: the MP_Create errors 10-15,
+// or 16 for MPConfig::shm_publish or motion_gating, which pools do not
+// support. Error 62 from MP_PoolSubmit means no healthy instance is left.
+MPPoolHandle MP_CreatePool(const MPConfig* config, int n_instances);
+
+// Queue a frame of camera stream `stream_id` (any caller-chosen id)
+// The frame is converted to RGB before returning, so the caller may reuse
+// its buffer immediately. A stream whose last result found someone stays on
+// the instance holding its tracking state; other streams go to whichever
+// instance is idle first.
+// Returns false with error 61 if the stream's instance is backlogged
+bool MP_PoolSubmit(
+    MPPoolHandle pool,
+    uint32_t stream_id,
+    const MPFrame* frame,
+    uint64_t user_tag,
+    MPError* error
+);
+
+// Register completion callback for MP_PoolSubmit (NULL = use MP_PoolPoll)
+// Returns true on success, false on failure
+bool MP_PoolSetResultCallback(
+    MPPoolHandle pool,
+    MP_PoolResultCallback callback,
+    void* user_data
+);
+
+// Take the oldest completed pool frame (see MP_PollResults)
+// stream_id, user_tag: receive the values passed to MP_PoolSubmit (may be NULL)
+// Returns 1 if a result was written, 0 on timeout, -1 on error
+int MP_PoolPoll(
+    MPPoolHandle pool,
+    MPResultsBuffer* buffer,
+    uint32_t* stream_id,
+    uint64_t* user_tag,
+    int timeout_ms,
+    MPError* error
+);
+
+// Stop the workers and destroy every instance; queued frames are dropped
+void MP_DestroyPool(MPPoolHandle pool);
+
+// Attach to the results ring a handle publishes as `name` (see
+// MPConfig::shm_publish). Readers never block or slow the writer; one that
+// falls more than the ring's slot count behind skips ahead.
+// Returns NULL with error 70 if there is no such ring, 71 if its layout is
+// from an incompatible version
+MPShmReader* MP_ShmOpen(const char* name);
+
+// Point at the oldest frame newer than the last one returned, without
+// copying. The slot may be rewritten at any time, so the frame is only
+// good if MP_ShmValid still holds for it after it was read.
+// sequence: receives the frame's number
+// Returns NULL if no new frame has been published, or with error 1 for
+// NULL arguments
+const MPShmFrame* MP_ShmNext(MPShmReader* reader, uint64_t* sequence);
+
+// Same as MP_ShmNext, but skip straight to the newest frame
+const MPShmFrame* MP_ShmLatest(MPShmReader* reader, uint64_t* sequence);
+
+// Whether `frame` still holds frame `sequence`, i.e. everything read from
+// it since MP_ShmNext / MP_ShmLatest returned it is consistent
+bool MP_ShmValid(const MPShmReader* reader, const MPShmFrame* frame, uint64_t sequence);
+
+// Copy the next frame (see MP_ShmNext) into `frame`, checked for
+// consistency. frame->sequence tells how many frames were skipped.
+// Returns true if a new frame was copied; false with error 1 for NULL
+// arguments
+bool MP_ShmRead(MPShmReader* reader, MPShmFrame* frame);
+
+// Whether the writer has destroyed its handle; the ring then stays
+// readable until MP_ShmClose but receives no more frames
+bool MP_ShmWriterClosed(const MPShmReader* reader);
+
+// Detach from the ring
+void MP_ShmClose(MPShmReader* reader);
+
+// Record every frame's results to `path` until MP_RecordStop or
+// MP_Destroy. Frames are snapshotted as they are fetched and written by a
+// background thread in a compact chunked format: landmarks quantized to
+// 1/16384 (scores to 1/1024) and delta-coded against the previous frame,
+// with a seek index at the end. MPResults::predicted is kept, so replay
+// tells extrapolated frames from inferred ones. Frames are dropped, never waited for, if
+// the disk falls behind (see MPStats::frames_record_dropped).
+// Returns false with error 80 if already recording, 81 if `path` cannot
+// be created
+bool MP_RecordStart(MPHandle handle, const char* path);
+
+// Finish the recording: queued frames, the last chunk and the index are
+// written before this returns.
+// Returns false with error 80 if not recording, 82 if a write failed
+bool MP_RecordStop(MPHandle handle);
+
+// Memory-map a recording for replay
+// Returns NULL with error 83 if it cannot be opened, 84 if it is not a
+// recording of this format version
+MPRecording* MP_RecordingOpen(const char* path);
+
+// Summarize the recording into `info`
+// Returns true on success, false on failure
+bool MP_RecordingGetInfo(const MPRecording* recording, MPRecordingInfo* info);
+
+// Decode the next frame into `buffer` as MP_ProcessInto would (full AoS
+// landmarks; processing_time_ms and timestamps as recorded)
+// Returns 1 if a frame was written, 0 at the end, -1 with error 85 for a
+// corrupt chunk
+int MP_RecordingNext(MPRecording* recording, MPResultsBuffer* buffer);
+
+// Make the next frame the first one recorded at or after `timestamp_us`
+// Returns false with error 85 for a corrupt chunk
+bool MP_RecordingSeek(MPRecording* recording, int64_t timestamp_us);
+
+// Unmap the recording
+void MP_RecordingClose(MPRecording* recording);
+
+// Snapshot the processor's counters and timing into `stats`
+// Calculator timing is only collected with MPConfig::enable_profiling.
+// Returns true on success, false on failure
+bool MP_GetStats(MPHandle handle, MPStats* stats);
+
 // Get last error details
+// handle: the most recent failure of any call on it, from any thread
+// (not reset by later successes); NULL: the outcome of this thread's last
+// call, including MP_Create and calls on pools, readers and recordings
 MPError MP_GetLastError(MPHandle handle);
 
 // Destroy processor and free resources
 void MP_Destroy(MPHandle handle);
 
-// Get library version info
+// ARKit name of MPResults::blendshapes[index] (e.g. "eyeBlinkLeft"), or
+// NULL if index is out of range
+const char* MP_GetBlendshapeName(int index);
+
+// Get library version info, including the build's default model precision
 const char* MP_GetVersion(void);
 
 // Check if GPU acceleration is available
 bool MP_IsGPUAvailable(void);
 
+// Inference backends compiled into this build, as MP_BACKEND_BIT() flags.
+// MP_Create fails (error 14) for an MPConfig::inference_backend not in it.
+// A backend that is compiled in may still fail to start on a machine
+// without the hardware; MP_Create then reports it as error 11.
+uint32_t MP_QueryBackends(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,194 @@
+// model_cache.cc
+// Process-wide cache of memory-mapped model files
+
+#include "model_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "mediapipe/framework/port/resource_util.h"
+
+namespace {
+
+// Where `bazel build --define model_precision=...` installs the variants
+// in cpp_core/models, relative to the runfiles root
+constexpr char kModelVariantDir[] = "cpp_core/models/";
+
+// Live FileMapping totals for GetModelCacheStats
+std::atomic<int> g_mapped_files{0};
+std::atomic<uint64_t> g_mapped_bytes{0};
+
+// One read-only mapping of a whole file
+class FileMapping {
+public:
+    // Map the file open as `fd`, `size` bytes long; the caller keeps `fd`
+    static absl::StatusOr<std::shared_ptr<FileMapping>> Map(
+        int fd, size_t size, const std::string& path
+    ) {
+        void* data = nullptr;
+        if (size > 0) {
+            data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED) {
+                return absl::ErrnoToStatus(errno, "Failed to map " + path);
+            }
+            // The interpreter verifies and reads the whole model right away
+            madvise(data, size, MADV_WILLNEED);
+        }
+        return std::shared_ptr<FileMapping>(new FileMapping(data, size));
+    }
+
+    ~FileMapping() {
+        if (data_) {
+            munmap(data_, size_);
+        }
+        g_mapped_files.fetch_sub(1, std::memory_order_relaxed);
+        g_mapped_bytes.fetch_sub(size_, std::memory_order_relaxed);
+    }
+
+    FileMapping(const FileMapping&) = delete;
+    FileMapping& operator=(const FileMapping&) = delete;
+
+    const void* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    FileMapping(void* data, size_t size) : data_(data), size_(size) {
+        g_mapped_files.fetch_add(1, std::memory_order_relaxed);
+        g_mapped_bytes.fetch_add(size_, std::memory_order_relaxed);
+    }
+
+    void* const data_;
+    const size_t size_;
+};
+
+class MappedModelResources : public mediapipe::Resources {
+public:
+    using mediapipe::Resources::Get;
+
+    absl::StatusOr<std::unique_ptr<mediapipe::Resource>> Get(
+        absl::string_view resource_id, const Options& options) const override {
+        (void)options;  // text and binary reads are the same bytes
+        auto path = mediapipe::PathToResourceAsFile(std::string(resource_id));
+        if (!path.ok()) {
+            return path.status();
+        }
+        auto mapping = Map(*path);
+        if (!mapping.ok()) {
+            return mapping.status();
+        }
+
+        // Each resource keeps the shared mapping alive
+        std::shared_ptr<FileMapping> shared = *mapping;
+        return mediapipe::MakeCleanupResource(shared->data(), shared->size(), [shared] {});
+    }
+
+private:
+    absl::StatusOr<std::shared_ptr<FileMapping>> Map(const std::string& path) const {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return absl::ErrnoToStatus(errno, "Failed to open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            const int error = errno;
+            close(fd);
+            return absl::ErrnoToStatus(error, "Failed to stat " + path);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::weak_ptr<FileMapping>& entry = mappings_[{info.st_dev, info.st_ino}];
+        auto mapping = entry.lock();
+        if (!mapping) {
+            auto mapped = FileMapping::Map(fd, static_cast<size_t>(info.st_size), path);
+            if (!mapped.ok()) {
+                close(fd);
+                return mapped.status();
+            }
+            mapping = *mapped;
+            entry = mapping;
+        }
+        // The mapping keeps the file referenced
+        close(fd);
+        return mapping;
+    }
+
+    // Keyed by file identity, so every path to a model shares one mapping
+    // and a model replaced on disk gets a fresh one
+    mutable std::mutex mutex_;
+    mutable std::map<std::pair<dev_t, ino_t>, std::weak_ptr<FileMapping>> mappings_;
+};
+
+} // anonymous namespace
+
+std::shared_ptr<mediapipe::Resources> SharedModelResources() {
+    static const std::shared_ptr<mediapipe::Resources> resources =
+        std::make_shared<MappedModelResources>();
+    return resources;
+}
+
+MPModelPrecision ResolveModelPrecision(MPModelPrecision precision) {
+    if (precision != MP_PRECISION_DEFAULT) {
+        return precision;
+    }
+#if defined(MP_BUILD_PRECISION_INT8)
+    return MP_PRECISION_INT8;
+#elif defined(MP_BUILD_PRECISION_FP16)
+    return MP_PRECISION_FP16;
+#else
+    return MP_PRECISION_FLOAT;
+#endif
+}
+
+ModelResources::ModelResources(MPModelPrecision precision)
+    : precision_(ResolveModelPrecision(precision)),
+      shared_(SharedModelResources()) {}
+
+absl::StatusOr<std::unique_ptr<mediapipe::Resource>> ModelResources::Get(
+    absl::string_view resource_id, const Options& options) const {
+    constexpr absl::string_view kModelExtension = ".tflite";
+    const char* suffix = precision_ == MP_PRECISION_INT8 ? "_int8"
+                       : precision_ == MP_PRECISION_FP16 ? "_fp16"
+                       : nullptr;
+    const bool is_model = resource_id.size() > kModelExtension.size() &&
+        resource_id.substr(resource_id.size() - kModelExtension.size()) == kModelExtension;
+    if (!suffix || !is_model) {
+        return shared_->Get(resource_id, options);
+    }
+
+    // Next to the shipped model first, then the bundled variants
+    const std::string stem(resource_id.substr(0, resource_id.size() - kModelExtension.size()));
+    const size_t slash = stem.rfind('/');
+    const std::string name = slash == std::string::npos ? stem : stem.substr(slash + 1);
+    const std::string candidates[] = {
+        stem + suffix + std::string(kModelExtension),
+        kModelVariantDir + name + suffix + std::string(kModelExtension),
+    };
+    for (const std::string& candidate : candidates) {
+        auto resource = shared_->Get(candidate, options);
+        if (resource.ok()) {
+            variant_models_.fetch_add(1, std::memory_order_relaxed);
+            return resource;
+        }
+    }
+    auto resource = shared_->Get(resource_id, options);
+    if (resource.ok()) {
+        fallback_models_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return resource;
+}
+
+ModelCacheStats GetModelCacheStats() {
+    ModelCacheStats stats;
+    stats.files = g_mapped_files.load(std::memory_order_relaxed);
+    stats.bytes = g_mapped_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
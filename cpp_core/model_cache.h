@@ -0,0 +1,61 @@
+// model_cache.h
+// Process-wide cache of memory-mapped model files
+
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "mediapipe_bridge.h"
+
+#include "mediapipe/framework/resources.h"
+
+// Resources that serve every file a graph loads (TFLite models, label maps)
+// from one read-only mapping per path, shared by all graphs in the process.
+// A file is mapped on first use and unmapped once no graph holds it, so
+// creating another handle finds its models already resident. The pages
+// belong to the page cache, which also shares them with other processes
+// running the same models. Register it on a graph through
+// mediapipe::kResourcesService before StartRun.
+std::shared_ptr<mediapipe::Resources> SharedModelResources();
+
+// Files SharedModelResources currently has mapped
+struct ModelCacheStats {
+    int files = 0;
+    uint64_t bytes = 0;
+};
+
+ModelCacheStats GetModelCacheStats();
+
+// MPConfig::precision with MP_PRECISION_DEFAULT replaced by the build's
+// default (--define model_precision=..., else MP_PRECISION_FLOAT)
+MPModelPrecision ResolveModelPrecision(MPModelPrecision precision);
+
+// One handle's view of SharedModelResources. Below float precision each
+// TFLite model "dir/name.tflite" is served as "dir/name_int8.tflite" (or
+// _fp16) when that variant exists there or in the bundled cpp_core/models,
+// and as shipped otherwise. Register it through kResourcesService.
+class ModelResources : public mediapipe::Resources {
+public:
+    explicit ModelResources(MPModelPrecision precision);
+
+    using mediapipe::Resources::Get;
+    absl::StatusOr<std::unique_ptr<mediapipe::Resource>> Get(
+        absl::string_view resource_id, const Options& options) const override;
+
+    MPModelPrecision precision() const { return precision_; }
+
+    // Models loaded so far at precision() / as shipped for lack of a variant
+    int variant_models() const { return variant_models_.load(std::memory_order_relaxed); }
+    int fallback_models() const { return fallback_models_.load(std::memory_order_relaxed); }
+
+private:
+    const MPModelPrecision precision_;
+    const std::shared_ptr<mediapipe::Resources> shared_;
+    mutable std::atomic<int> variant_models_{0};
+    mutable std::atomic<int> fallback_models_{0};
+};
+
+#endif // MODEL_CACHE_H
@@ -0,0 +1,167 @@
+// motion_gate.cc
+// Skips inference on near-still frames and extrapolates their landmarks
+
+#include "motion_gate.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "shm_ring.h"
+
+namespace {
+
+// Luma is compared per cell, so motion confined to a small area such as
+// the mouth still registers; each cell averages kCellSamples^2 pixels to
+// keep sensor noise well below the threshold
+constexpr int kGridWidth = 32;
+constexpr int kGridHeight = 24;
+constexpr int kCellSamples = 8;
+
+constexpr float kDefaultThreshold = 4.0f;    // luma levels, 0-255
+constexpr float kDefaultMaxVelocity = 0.5f;  // normalized units per second
+
+// Longest extrapolation; past it landmarks hold still
+constexpr int64_t kMaxExtrapolationUs = 100000;
+
+bool SameCounts(const MPShmFrame& a, const MPShmFrame& b) {
+    return a.face_count == b.face_count &&
+           a.left_hand_count == b.left_hand_count &&
+           a.right_hand_count == b.right_hand_count &&
+           a.pose_count == b.pose_count &&
+           a.pose_world_count == b.pose_world_count;
+}
+
+// Largest x/y displacement of any landmark of one set
+float MaxDisplacement(const MPLandmark* previous, const MPLandmark* latest, int count) {
+    float displacement = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        displacement = std::max({displacement,
+                                 std::fabs(latest[i].x - previous[i].x),
+                                 std::fabs(latest[i].y - previous[i].y)});
+    }
+    return displacement;
+}
+
+// Continue each landmark of `latest` along its motion since `previous`
+void Extrapolate(const MPLandmark* previous, MPLandmark* latest, int count, float factor) {
+    for (int i = 0; i < count; ++i) {
+        latest[i].x += (latest[i].x - previous[i].x) * factor;
+        latest[i].y += (latest[i].y - previous[i].y) * factor;
+        latest[i].z += (latest[i].z - previous[i].z) * factor;
+    }
+}
+
+} // anonymous namespace
+
+MotionGate::MotionGate(const MPMotionGating& config)
+    : config_(config),
+      threshold_(config.motion_threshold > 0.0f ? config.motion_threshold : kDefaultThreshold),
+      max_velocity_(config.max_velocity > 0.0f ? config.max_velocity : kDefaultMaxVelocity),
+      reference_(kGridWidth * kGridHeight),
+      current_(kGridWidth * kGridHeight) {}
+
+bool MotionGate::Enabled(const MPMotionGating& config) {
+    return config.max_skip > 0;
+}
+
+void MotionGate::Sample(const uint8_t* rgb, int width, int height, int stride,
+                        std::vector<float>* grid) const {
+    constexpr int kColumns = kGridWidth * kCellSamples;
+    constexpr int kRows = kGridHeight * kCellSamples;
+    int columns[kColumns];
+    for (int i = 0; i < kColumns; ++i) {
+        columns[i] = 3 * static_cast<int>((2 * i + 1) * static_cast<int64_t>(width) / (2 * kColumns));
+    }
+
+    std::fill(grid->begin(), grid->end(), 0.0f);
+    for (int j = 0; j < kRows; ++j) {
+        const int y = static_cast<int>((2 * j + 1) * static_cast<int64_t>(height) / (2 * kRows));
+        const uint8_t* row = rgb + static_cast<size_t>(y) * stride;
+        float* cells = grid->data() + (j / kCellSamples) * kGridWidth;
+        for (int i = 0; i < kColumns; ++i) {
+            const uint8_t* pixel = row + columns[i];
+            cells[i / kCellSamples] += (77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2]) >> 8;
+        }
+    }
+    for (float& cell : *grid) {
+        cell *= 1.0f / (kCellSamples * kCellSamples);
+    }
+}
+
+bool MotionGate::Skip(const uint8_t* rgb, int width, int height, int stride) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Sample(rgb, width, height, stride, &current_);
+
+    bool skip = observed_ > 0 && skipped_ < config_.max_skip &&
+                width == reference_width_ && height == reference_height_;
+    if (skip) {
+        float difference = 0.0f;
+        for (size_t i = 0; i < current_.size(); ++i) {
+            difference = std::max(difference, std::fabs(current_[i] - reference_[i]));
+        }
+        skip = difference < threshold_;
+    }
+    if (skip && observed_ == 2) {
+        const float speed = Speed();
+        skip = speed >= 0.0f && speed < max_velocity_;
+    }
+
+    if (skip) {
+        ++skipped_;
+    } else {
+        current_.swap(reference_);
+        reference_width_ = width;
+        reference_height_ = height;
+        skipped_ = 0;
+    }
+    return skip;
+}
+
+float MotionGate::Speed() const {
+    const MPShmFrame& previous = observations_[0];
+    const MPShmFrame& latest = observations_[1];
+    const int64_t elapsed_us = latest.timestamp_us - previous.timestamp_us;
+    if (elapsed_us <= 0 || !SameCounts(previous, latest)) {
+        return -1.0f;
+    }
+    const float displacement = std::max({
+        MaxDisplacement(previous.face_landmarks, latest.face_landmarks, latest.face_count),
+        MaxDisplacement(previous.left_hand_landmarks, latest.left_hand_landmarks,
+                        latest.left_hand_count),
+        MaxDisplacement(previous.right_hand_landmarks, latest.right_hand_landmarks,
+                        latest.right_hand_count),
+        MaxDisplacement(previous.pose_landmarks, latest.pose_landmarks, latest.pose_count),
+    });
+    return displacement * 1e6f / static_cast<float>(elapsed_us);
+}
+
+void MotionGate::Observe(const MPResults& results, int64_t timestamp_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    observations_[0] = observations_[1];
+    SnapshotResults(results, timestamp_us, 0.0f, &observations_[1]);
+    observed_ = std::min(observed_ + 1, 2);
+}
+
+void MotionGate::Predict(int64_t timestamp_us, MPShmFrame* frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const MPShmFrame& previous = observations_[0];
+    const MPShmFrame& latest = observations_[1];
+    *frame = latest;
+    frame->timestamp_us = timestamp_us;
+
+    const int64_t interval_us = latest.timestamp_us - previous.timestamp_us;
+    const int64_t ahead_us = std::min(timestamp_us - latest.timestamp_us, kMaxExtrapolationUs);
+    if (observed_ < 2 || interval_us <= 0 || ahead_us <= 0 || !SameCounts(previous, latest)) {
+        return;  // hold the latest landmarks
+    }
+
+    const float factor = static_cast<float>(ahead_us) / static_cast<float>(interval_us);
+    Extrapolate(previous.face_landmarks, frame->face_landmarks, frame->face_count, factor);
+    Extrapolate(previous.left_hand_landmarks, frame->left_hand_landmarks,
+                frame->left_hand_count, factor);
+    Extrapolate(previous.right_hand_landmarks, frame->right_hand_landmarks,
+                frame->right_hand_count, factor);
+    Extrapolate(previous.pose_landmarks, frame->pose_landmarks, frame->pose_count, factor);
+    Extrapolate(previous.pose_world_landmarks, frame->pose_world_landmarks,
+                frame->pose_world_count, factor);
+}
@@ -0,0 +1,59 @@
+// motion_gate.h
+// Skips inference on near-still frames and extrapolates their landmarks
+
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "mediapipe_bridge.h"
+
+// Decides per frame for MPConfig::motion_gating whether the graph can be
+// skipped. A frame is skipped when its downsampled luma barely differs from
+// the last frame that ran inference, the landmarks of the last two inferred
+// frames moved slowly, and fewer than max_skip frames in a row were skipped
+// already. Thread-safe.
+class MotionGate {
+public:
+    explicit MotionGate(const MPMotionGating& config);
+
+    // Whether `config` skips anything at all
+    static bool Enabled(const MPMotionGating& config);
+
+    // Whether the RGB24 frame may be answered by Predict instead of the
+    // graph. A frame that must run becomes the new luma reference.
+    bool Skip(const uint8_t* rgb, int width, int height, int stride);
+
+    // Raw landmarks (either layout, camera frame coordinates) of a frame
+    // that ran inference
+    void Observe(const MPResults& results, int64_t timestamp_us);
+
+    // Landmarks at `timestamp_us`, extrapolated from the last observations
+    void Predict(int64_t timestamp_us, MPShmFrame* frame);
+
+private:
+    // Luma cell means of a frame, kGridWidth x kGridHeight
+    void Sample(const uint8_t* rgb, int width, int height, int stride,
+                std::vector<float>* grid) const;
+
+    // Fastest image-space landmark speed between the two observations,
+    // normalized units per second; negative if they are not comparable
+    float Speed() const;
+
+    const MPMotionGating config_;
+    const float threshold_;
+    const float max_velocity_;
+
+    std::mutex mutex_;
+    std::vector<float> reference_;  // luma of the last inferred frame
+    int reference_width_ = 0;
+    int reference_height_ = 0;
+    std::vector<float> current_;
+    int skipped_ = 0;  // frames skipped since then
+    MPShmFrame observations_[2] = {};  // [1] is the latest
+    int observed_ = 0;  // valid entries, up to 2
+};
+
+#endif // MOTION_GATE_H
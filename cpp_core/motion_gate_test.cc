@@ -0,0 +1,200 @@
+// motion_gate_test.cc
+// Tests for MotionGate
+
+#include "motion_gate.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr int kWidth = 320;
+constexpr int kHeight = 240;
+constexpr int kMaxSkip = 3;
+constexpr int64_t kFrameUs = 33333;
+constexpr int64_t kMaxExtrapolationUs = 100000;
+
+MPMotionGating Gating() {
+    MPMotionGating config = {};
+    config.max_skip = kMaxSkip;
+    return config;
+}
+
+// A gray RGB24 frame, optionally with a brighter square in one corner
+struct Image {
+    explicit Image(int width = kWidth, int height = kHeight, int patch_delta = 0)
+        : width(width), height(height), pixels(static_cast<size_t>(width) * height * 3, 100) {
+        for (int y = 0; y < height / 8; ++y) {
+            for (int x = 0; x < width / 8; ++x) {
+                uint8_t* pixel = &pixels[(static_cast<size_t>(y) * width + x) * 3];
+                pixel[0] = pixel[1] = pixel[2] = static_cast<uint8_t>(100 + patch_delta);
+            }
+        }
+    }
+
+    bool SkippedBy(MotionGate* gate) const {
+        return gate->Skip(pixels.data(), width, height, width * 3);
+    }
+
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+};
+
+// Results with every pose landmark at (x, 0.5, z)
+struct Pose {
+    explicit Pose(float x, float z = 0.0f, int count = MP_MAX_POSE_LANDMARKS)
+        : landmarks(count, MPLandmark{x, 0.5f, z, 1.0f, 1.0f}) {
+        results.pose_landmarks = landmarks.data();
+        results.pose_count = count;
+        results.pose_detected = true;
+    }
+
+    std::vector<MPLandmark> landmarks;
+    MPResults results = {};
+};
+
+// Run the first frame through the graph and observe `x` for it
+void Start(MotionGate* gate, const Image& image, float x) {
+    ASSERT_FALSE(image.SkippedBy(gate));
+    Pose pose(x);
+    gate->Observe(pose.results, 0);
+}
+
+TEST(MotionGateTest, EnabledByMaxSkip) {
+    EXPECT_FALSE(MotionGate::Enabled(MPMotionGating{}));
+    EXPECT_TRUE(MotionGate::Enabled(Gating()));
+}
+
+// Nothing to extrapolate from until a frame has run the graph
+TEST(MotionGateTest, FirstFrameRuns) {
+    MotionGate gate(Gating());
+    const Image image;
+    EXPECT_FALSE(image.SkippedBy(&gate));
+    EXPECT_FALSE(image.SkippedBy(&gate));
+}
+
+TEST(MotionGateTest, SkipsStillFrame) {
+    MotionGate gate(Gating());
+    const Image image;
+    Start(&gate, image, 0.5f);
+    EXPECT_TRUE(image.SkippedBy(&gate));
+    // Sensor-level noise in one corner is under the default threshold of 4
+    EXPECT_TRUE(Image(kWidth, kHeight, 2).SkippedBy(&gate));
+}
+
+// Any single cell changing past the threshold counts, even if the frame
+// as a whole barely did
+TEST(MotionGateTest, LocalChangeRuns) {
+    MotionGate gate(Gating());
+    Start(&gate, Image(), 0.5f);
+    const Image changed(kWidth, kHeight, 10);
+    EXPECT_FALSE(changed.SkippedBy(&gate));
+    // The changed frame is the new reference
+    EXPECT_TRUE(changed.SkippedBy(&gate));
+}
+
+TEST(MotionGateTest, StopsAtMaxSkip) {
+    MotionGate gate(Gating());
+    const Image image;
+    Start(&gate, image, 0.5f);
+    for (int i = 0; i < kMaxSkip; ++i) {
+        EXPECT_TRUE(image.SkippedBy(&gate)) << "frame " << i;
+    }
+    EXPECT_FALSE(image.SkippedBy(&gate));
+    // The run restarts after an inferred frame
+    EXPECT_TRUE(image.SkippedBy(&gate));
+}
+
+TEST(MotionGateTest, SizeChangeRuns) {
+    MotionGate gate(Gating());
+    Start(&gate, Image(), 0.5f);
+    const Image larger(2 * kWidth, 2 * kHeight);
+    EXPECT_FALSE(larger.SkippedBy(&gate));
+    EXPECT_TRUE(larger.SkippedBy(&gate));
+}
+
+TEST(MotionGateTest, FastLandmarksRun) {
+    MotionGate gate(Gating());
+    const Image image;
+    Start(&gate, image, 0.5f);
+
+    // 0.05 per frame is 1.5 units per second, over the default 0.5
+    Pose fast(0.55f);
+    gate.Observe(fast.results, kFrameUs);
+    EXPECT_FALSE(image.SkippedBy(&gate));
+
+    // 0.005 per frame is 0.15 units per second
+    Pose slow(0.555f);
+    gate.Observe(slow.results, 2 * kFrameUs);
+    EXPECT_TRUE(image.SkippedBy(&gate));
+
+    // Observations with different landmark counts cannot be compared
+    Pose fewer(0.555f, 0.0f, 25);
+    gate.Observe(fewer.results, 3 * kFrameUs);
+    EXPECT_FALSE(image.SkippedBy(&gate));
+}
+
+TEST(MotionGateTest, PredictExtrapolatesLinearly) {
+    MotionGate gate(Gating());
+    Pose first(0.5f, -0.1f);
+    gate.Observe(first.results, 0);
+    Pose second(0.51f, -0.12f);
+    gate.Observe(second.results, kFrameUs);
+
+    MPShmFrame frame;
+    gate.Predict(2 * kFrameUs, &frame);
+    EXPECT_EQ(frame.timestamp_us, 2 * kFrameUs);
+    ASSERT_EQ(frame.pose_count, MP_MAX_POSE_LANDMARKS);
+    EXPECT_NEAR(frame.pose_landmarks[0].x, 0.52f, 1e-5f);
+    EXPECT_NEAR(frame.pose_landmarks[0].y, 0.5f, 1e-5f);
+    EXPECT_NEAR(frame.pose_landmarks[0].z, -0.14f, 1e-5f);
+    EXPECT_NEAR(frame.pose_landmarks[MP_MAX_POSE_LANDMARKS - 1].x, 0.52f, 1e-5f);
+
+    // Half a frame ahead goes half as far
+    gate.Predict(kFrameUs + kFrameUs / 2, &frame);
+    EXPECT_NEAR(frame.pose_landmarks[0].x, 0.515f, 1e-4f);
+}
+
+TEST(MotionGateTest, PredictHoldsPastMaxExtrapolation) {
+    MotionGate gate(Gating());
+    Pose first(0.5f);
+    gate.Observe(first.results, 0);
+    Pose second(0.51f);
+    gate.Observe(second.results, kFrameUs);
+
+    const float per_us = 0.01f / kFrameUs;
+    MPShmFrame frame;
+    gate.Predict(kFrameUs + kMaxExtrapolationUs, &frame);
+    const float limit = 0.51f + per_us * kMaxExtrapolationUs;
+    EXPECT_NEAR(frame.pose_landmarks[0].x, limit, 1e-4f);
+
+    gate.Predict(kFrameUs + 5 * kMaxExtrapolationUs, &frame);
+    EXPECT_EQ(frame.timestamp_us, kFrameUs + 5 * kMaxExtrapolationUs);
+    EXPECT_NEAR(frame.pose_landmarks[0].x, limit, 1e-4f);
+}
+
+// One observation, or two that cannot be compared, give the latest as is
+TEST(MotionGateTest, PredictHoldsWithoutMotion) {
+    MotionGate gate(Gating());
+    Pose first(0.5f);
+    gate.Observe(first.results, 0);
+    MPShmFrame frame;
+    gate.Predict(kFrameUs, &frame);
+    EXPECT_FLOAT_EQ(frame.pose_landmarks[0].x, 0.5f);
+
+    Pose fewer(0.6f, 0.0f, 25);
+    gate.Observe(fewer.results, kFrameUs);
+    gate.Predict(2 * kFrameUs, &frame);
+    EXPECT_EQ(frame.pose_count, 25);
+    EXPECT_FLOAT_EQ(frame.pose_landmarks[0].x, 0.6f);
+
+    // A timestamp at or before the latest observation is not extrapolated
+    Pose moved(0.61f, 0.0f, 25);
+    gate.Observe(moved.results, 2 * kFrameUs);
+    gate.Predict(2 * kFrameUs, &frame);
+    EXPECT_FLOAT_EQ(frame.pose_landmarks[0].x, 0.61f);
+}
+
+} // namespace
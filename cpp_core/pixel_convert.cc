@@ -0,0 +1,668 @@
+// pixel_convert.cc
+// Fused pixel format conversion into packed RGB24
+//
+// Every format is converted row by row in a single pass: the source is read
+// once and each RGB pixel is written once, directly at its (optionally
+// mirrored) destination. Row kernels process 16 pixels per iteration with
+// SSSE3 on x86 (selected at runtime) or NEON on ARM, and finish the row with
+// the scalar code, which is also the reference implementation.
+//
+// RGB24 output is shuffle-bound: 256-bit AVX2 shuffles only work within
+// 128-bit lanes, so they would not speed up the 3-byte interleave.
+
+#include "pixel_convert.h"
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define PIXEL_CONVERT_SSSE3 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXEL_CONVERT_NEON 1
+#endif
+
+namespace {
+
+// Pixels per SIMD iteration
+constexpr int kBlock = 16;
+
+// ============================================================================
+// Scalar reference
+// ============================================================================
+
+inline uint8_t Clamp255(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// BT.601 limited range in 6-bit fixed point. The SIMD kernels use 16-bit
+// saturating arithmetic which only saturates where this clamps anyway, so
+// both paths produce identical output.
+inline void YuvToRgb(int y, int u, int v, uint8_t* dst) {
+    const int c = (y - 16) * 74;
+    const int d = u - 128;
+    const int e = v - 128;
+    dst[0] = Clamp255((c + 102 * e + 32) >> 6);
+    dst[1] = Clamp255((c - 25 * d - 52 * e + 32) >> 6);
+    dst[2] = Clamp255((c + 129 * d + 32) >> 6);
+}
+
+// Destination of source pixel `x` in a row of `width` pixels
+inline uint8_t* DstPixel(uint8_t* dst, int x, int width, bool mirror) {
+    return dst + 3 * (mirror ? width - 1 - x : x);
+}
+
+void RgbRowScalar(const uint8_t* src, uint8_t* dst, int x, int width, bool mirror) {
+    for (; x < width; ++x) {
+        uint8_t* out = DstPixel(dst, x, width, mirror);
+        out[0] = src[3 * x + 0];
+        out[1] = src[3 * x + 1];
+        out[2] = src[3 * x + 2];
+    }
+}
+
+void BgrRowScalar(const uint8_t* src, uint8_t* dst, int x, int width, bool mirror) {
+    for (; x < width; ++x) {
+        uint8_t* out = DstPixel(dst, x, width, mirror);
+        out[0] = src[3 * x + 2];
+        out[1] = src[3 * x + 1];
+        out[2] = src[3 * x + 0];
+    }
+}
+
+void RgbaRowScalar(const uint8_t* src, uint8_t* dst, int x, int width, bool mirror) {
+    for (; x < width; ++x) {
+        uint8_t* out = DstPixel(dst, x, width, mirror);
+        out[0] = src[4 * x + 0];
+        out[1] = src[4 * x + 1];
+        out[2] = src[4 * x + 2];
+    }
+}
+
+void Nv12RowScalar(const uint8_t* y, const uint8_t* uv, uint8_t* dst,
+                   int x, int width, bool mirror) {
+    for (; x < width; ++x) {
+        const int c = x / 2;
+        YuvToRgb(y[x], uv[2 * c], uv[2 * c + 1], DstPixel(dst, x, width, mirror));
+    }
+}
+
+void I420RowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                   int x, int width, bool mirror) {
+    for (; x < width; ++x) {
+        YuvToRgb(y[x], u[x / 2], v[x / 2], DstPixel(dst, x, width, mirror));
+    }
+}
+
+void YuyvRowScalar(const uint8_t* src, uint8_t* dst, int x, int width, bool mirror) {
+    for (; x < width; ++x) {
+        const uint8_t* pair = src + 4 * (x / 2);
+        YuvToRgb(pair[(x & 1) ? 2 : 0], pair[1], pair[3], DstPixel(dst, x, width, mirror));
+    }
+}
+
+// ============================================================================
+// SSSE3 kernels
+// ============================================================================
+
+#if PIXEL_CONVERT_SSSE3
+
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+
+struct alignas(16) ShuffleMask {
+    int8_t lanes[16];
+};
+
+// pshufb mask gathering channel `channel` of 16 packed 3-byte pixels from
+// the 16-byte block `block` of the 48 source bytes (-1 = zero the lane)
+constexpr ShuffleMask DeinterleaveMask(int channel, int block) {
+    ShuffleMask mask = {};
+    for (int i = 0; i < 16; ++i) {
+        const int byte = 3 * i + channel - 16 * block;
+        mask.lanes[i] = static_cast<int8_t>(byte >= 0 && byte < 16 ? byte : -1);
+    }
+    return mask;
+}
+
+// pshufb mask placing channel `channel` lanes into output block `block` of
+// 16 packed 3-byte pixels
+constexpr ShuffleMask InterleaveMask(int channel, int block) {
+    ShuffleMask mask = {};
+    for (int j = 0; j < 16; ++j) {
+        const int byte = 16 * block + j;
+        mask.lanes[j] = static_cast<int8_t>(byte % 3 == channel ? byte / 3 : -1);
+    }
+    return mask;
+}
+
+constexpr ShuffleMask kDeinterleave[3][3] = {
+    {DeinterleaveMask(0, 0), DeinterleaveMask(0, 1), DeinterleaveMask(0, 2)},
+    {DeinterleaveMask(1, 0), DeinterleaveMask(1, 1), DeinterleaveMask(1, 2)},
+    {DeinterleaveMask(2, 0), DeinterleaveMask(2, 1), DeinterleaveMask(2, 2)},
+};
+
+constexpr ShuffleMask kInterleave[3][3] = {
+    {InterleaveMask(0, 0), InterleaveMask(0, 1), InterleaveMask(0, 2)},
+    {InterleaveMask(1, 0), InterleaveMask(1, 1), InterleaveMask(1, 2)},
+    {InterleaveMask(2, 0), InterleaveMask(2, 1), InterleaveMask(2, 2)},
+};
+
+constexpr ShuffleMask kReverse = {{15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0}};
+
+// RGBA (4 pixels) -> RRRR GGGG BBBB AAAA
+constexpr ShuffleMask kRgbaPlanar = {{0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15}};
+
+// Interleaved UV pairs -> UUUUUUUU VVVVVVVV
+constexpr ShuffleMask kUvPlanar = {{0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15}};
+
+// YUYV (8 pixels) -> Y x8, U x4, V x4
+constexpr ShuffleMask kYuyvPlanar = {{0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15}};
+
+// U0-3 V0-3 U4-7 V4-7 -> U0-7 V0-7
+constexpr ShuffleMask kYuyvChroma = {{0, 1, 2, 3, 8, 9, 10, 11, 4, 5, 6, 7, 12, 13, 14, 15}};
+
+SSSE3_TARGET inline __m128i Shuffle(__m128i v, const ShuffleMask& mask) {
+    return _mm_shuffle_epi8(v, _mm_load_si128(reinterpret_cast<const __m128i*>(mask.lanes)));
+}
+
+// 48 bytes of packed 3-channel pixels -> three planar channel vectors
+SSSE3_TARGET inline void Deinterleave3(const uint8_t* src, __m128i* c0, __m128i* c1, __m128i* c2) {
+    const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+    const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+    __m128i* out[3] = {c0, c1, c2};
+    for (int c = 0; c < 3; ++c) {
+        *out[c] = _mm_or_si128(
+            _mm_or_si128(Shuffle(v0, kDeinterleave[c][0]), Shuffle(v1, kDeinterleave[c][1])),
+            Shuffle(v2, kDeinterleave[c][2]));
+    }
+}
+
+// Store 16 RGB pixels, reversed in place when mirroring
+SSSE3_TARGET inline void StoreRgb(__m128i r, __m128i g, __m128i b,
+                                  uint8_t* dst, int x, int width, bool mirror) {
+    if (mirror) {
+        r = Shuffle(r, kReverse);
+        g = Shuffle(g, kReverse);
+        b = Shuffle(b, kReverse);
+        x = width - kBlock - x;
+    }
+    uint8_t* out = dst + 3 * x;
+    for (int block = 0; block < 3; ++block) {
+        const __m128i v = _mm_or_si128(
+            _mm_or_si128(Shuffle(r, kInterleave[0][block]), Shuffle(g, kInterleave[1][block])),
+            Shuffle(b, kInterleave[2][block]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * block), v);
+    }
+}
+
+// Convert 16 pixels of Y with 8 chroma samples (each shared by 2 pixels)
+SSSE3_TARGET inline void StoreYuv(__m128i y, __m128i u8, __m128i v8,
+                                  uint8_t* dst, int x, int width, bool mirror) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i u = _mm_unpacklo_epi8(u8, u8);
+    const __m128i v = _mm_unpacklo_epi8(v8, v8);
+
+    __m128i rgb[3][2];
+    for (int half = 0; half < 2; ++half) {
+        const __m128i yw = half ? _mm_unpackhi_epi8(y, zero) : _mm_unpacklo_epi8(y, zero);
+        const __m128i uw = _mm_sub_epi16(
+            half ? _mm_unpackhi_epi8(u, zero) : _mm_unpacklo_epi8(u, zero), _mm_set1_epi16(128));
+        const __m128i vw = _mm_sub_epi16(
+            half ? _mm_unpackhi_epi8(v, zero) : _mm_unpacklo_epi8(v, zero), _mm_set1_epi16(128));
+
+        const __m128i c = _mm_adds_epi16(
+            _mm_mullo_epi16(_mm_sub_epi16(yw, _mm_set1_epi16(16)), _mm_set1_epi16(74)),
+            _mm_set1_epi16(32));
+        const __m128i r = _mm_adds_epi16(c, _mm_mullo_epi16(vw, _mm_set1_epi16(102)));
+        const __m128i g = _mm_subs_epi16(
+            _mm_subs_epi16(c, _mm_mullo_epi16(uw, _mm_set1_epi16(25))),
+            _mm_mullo_epi16(vw, _mm_set1_epi16(52)));
+        const __m128i b = _mm_adds_epi16(c, _mm_mullo_epi16(uw, _mm_set1_epi16(129)));
+
+        rgb[0][half] = _mm_srai_epi16(r, 6);
+        rgb[1][half] = _mm_srai_epi16(g, 6);
+        rgb[2][half] = _mm_srai_epi16(b, 6);
+    }
+
+    StoreRgb(_mm_packus_epi16(rgb[0][0], rgb[0][1]),
+             _mm_packus_epi16(rgb[1][0], rgb[1][1]),
+             _mm_packus_epi16(rgb[2][0], rgb[2][1]),
+             dst, x, width, mirror);
+}
+
+SSSE3_TARGET int RgbRowSsse3(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        __m128i r, g, b;
+        Deinterleave3(src + 3 * x, &r, &g, &b);
+        StoreRgb(r, g, b, dst, x, width, mirror);
+    }
+    return x;
+}
+
+SSSE3_TARGET int BgrRowSsse3(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        __m128i r, g, b;
+        Deinterleave3(src + 3 * x, &b, &g, &r);
+        StoreRgb(r, g, b, dst, x, width, mirror);
+    }
+    return x;
+}
+
+SSSE3_TARGET int RgbaRowSsse3(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        const uint8_t* in = src + 4 * x;
+        __m128i s[4];
+        for (int i = 0; i < 4; ++i) {
+            s[i] = Shuffle(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i)),
+                           kRgbaPlanar);
+        }
+        const __m128i rg01 = _mm_unpacklo_epi32(s[0], s[1]);
+        const __m128i ba01 = _mm_unpackhi_epi32(s[0], s[1]);
+        const __m128i rg23 = _mm_unpacklo_epi32(s[2], s[3]);
+        const __m128i ba23 = _mm_unpackhi_epi32(s[2], s[3]);
+        StoreRgb(_mm_unpacklo_epi64(rg01, rg23),
+                 _mm_unpackhi_epi64(rg01, rg23),
+                 _mm_unpacklo_epi64(ba01, ba23),
+                 dst, x, width, mirror);
+    }
+    return x;
+}
+
+SSSE3_TARGET int Nv12RowSsse3(const uint8_t* y, const uint8_t* uv, uint8_t* dst,
+                              int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        const __m128i chroma = Shuffle(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x)), kUvPlanar);
+        StoreYuv(luma, chroma, _mm_srli_si128(chroma, 8), dst, x, width, mirror);
+    }
+    return x;
+}
+
+SSSE3_TARGET int I420RowSsse3(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                              uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        StoreYuv(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x)),
+                 _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)),
+                 _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)),
+                 dst, x, width, mirror);
+    }
+    return x;
+}
+
+SSSE3_TARGET int YuyvRowSsse3(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        const uint8_t* in = src + 2 * x;
+        const __m128i a = Shuffle(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)),
+                                  kYuyvPlanar);
+        const __m128i b = Shuffle(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16)),
+                                  kYuyvPlanar);
+        const __m128i chroma = Shuffle(_mm_unpackhi_epi64(a, b), kYuyvChroma);
+        StoreYuv(_mm_unpacklo_epi64(a, b), chroma, _mm_srli_si128(chroma, 8),
+                 dst, x, width, mirror);
+    }
+    return x;
+}
+
+bool HasSsse3() {
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+
+#endif // PIXEL_CONVERT_SSSE3
+
+// ============================================================================
+// NEON kernels
+// ============================================================================
+
+#if PIXEL_CONVERT_NEON
+
+inline uint8x16_t Reverse16(uint8x16_t v) {
+    const uint8x16_t r = vrev64q_u8(v);
+    return vcombine_u8(vget_high_u8(r), vget_low_u8(r));
+}
+
+inline void StoreRgb(uint8x16x3_t rgb, uint8_t* dst, int x, int width, bool mirror) {
+    if (mirror) {
+        for (int c = 0; c < 3; ++c) {
+            rgb.val[c] = Reverse16(rgb.val[c]);
+        }
+        x = width - kBlock - x;
+    }
+    vst3q_u8(dst + 3 * x, rgb);
+}
+
+inline uint8x8_t YuvChannel(int16x8_t c, int16x8_t d, int16_t cd, int16x8_t e, int16_t ce) {
+    int16x8_t value = vqaddq_s16(c, vmulq_n_s16(d, cd));
+    value = vqaddq_s16(value, vmulq_n_s16(e, ce));
+    return vqshrun_n_s16(value, 6);
+}
+
+// Convert 16 pixels of Y with 8 chroma samples (each shared by 2 pixels)
+inline void StoreYuv(uint8x16_t y, uint8x8_t u8, uint8x8_t v8,
+                     uint8_t* dst, int x, int width, bool mirror) {
+    const uint8x8x2_t u = vzip_u8(u8, u8);
+    const uint8x8x2_t v = vzip_u8(v8, v8);
+    const uint8x8_t halves_y[2] = {vget_low_u8(y), vget_high_u8(y)};
+
+    uint8x8_t rgb[3][2];
+    for (int half = 0; half < 2; ++half) {
+        const int16x8_t yw = vreinterpretq_s16_u16(vmovl_u8(halves_y[half]));
+        const int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u.val[half])),
+                                      vdupq_n_s16(128));
+        const int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v.val[half])),
+                                      vdupq_n_s16(128));
+        const int16x8_t c = vqaddq_s16(vmulq_n_s16(vsubq_s16(yw, vdupq_n_s16(16)), 74),
+                                       vdupq_n_s16(32));
+        rgb[0][half] = YuvChannel(c, d, 0, e, 102);
+        rgb[1][half] = YuvChannel(c, d, -25, e, -52);
+        rgb[2][half] = YuvChannel(c, d, 129, e, 0);
+    }
+
+    uint8x16x3_t out;
+    for (int ch = 0; ch < 3; ++ch) {
+        out.val[ch] = vcombine_u8(rgb[ch][0], rgb[ch][1]);
+    }
+    StoreRgb(out, dst, x, width, mirror);
+}
+
+int RgbRowNeon(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        StoreRgb(vld3q_u8(src + 3 * x), dst, x, width, mirror);
+    }
+    return x;
+}
+
+int BgrRowNeon(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        uint8x16x3_t bgr = vld3q_u8(src + 3 * x);
+        const uint8x16_t blue = bgr.val[0];
+        bgr.val[0] = bgr.val[2];
+        bgr.val[2] = blue;
+        StoreRgb(bgr, dst, x, width, mirror);
+    }
+    return x;
+}
+
+int RgbaRowNeon(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        const uint8x16x4_t rgba = vld4q_u8(src + 4 * x);
+        uint8x16x3_t rgb;
+        rgb.val[0] = rgba.val[0];
+        rgb.val[1] = rgba.val[1];
+        rgb.val[2] = rgba.val[2];
+        StoreRgb(rgb, dst, x, width, mirror);
+    }
+    return x;
+}
+
+int Nv12RowNeon(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        const uint8x8x2_t chroma = vld2_u8(uv + x);
+        StoreYuv(vld1q_u8(y + x), chroma.val[0], chroma.val[1], dst, x, width, mirror);
+    }
+    return x;
+}
+
+int I420RowNeon(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        StoreYuv(vld1q_u8(y + x), vld1_u8(u + x / 2), vld1_u8(v + x / 2),
+                 dst, x, width, mirror);
+    }
+    return x;
+}
+
+int YuyvRowNeon(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+    for (; x + kBlock <= width; x += kBlock) {
+        // Y0 (even pixels), U, Y1 (odd pixels), V
+        const uint8x8x4_t yuyv = vld4_u8(src + 2 * x);
+        const uint8x8x2_t luma = vzip_u8(yuyv.val[0], yuyv.val[2]);
+        StoreYuv(vcombine_u8(luma.val[0], luma.val[1]), yuyv.val[1], yuyv.val[3],
+                 dst, x, width, mirror);
+    }
+    return x;
+}
+
+#endif // PIXEL_CONVERT_NEON
+
+// ============================================================================
+// Row dispatch
+// ============================================================================
+
+// Cleared by SetSimdRowKernels(false)
+std::atomic<bool> simd_enabled{true};
+
+bool UseSimd() {
+    if (!simd_enabled.load(std::memory_order_relaxed)) {
+        return false;
+    }
+#if PIXEL_CONVERT_SSSE3
+    return HasSsse3();
+#elif PIXEL_CONVERT_NEON
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ConvertRgbRow(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    if (!mirror) {
+        memcpy(dst, src, static_cast<size_t>(width) * 3);
+        return;
+    }
+    int x = 0;
+#if PIXEL_CONVERT_SSSE3
+    if (UseSimd()) x = RgbRowSsse3(src, dst, width, mirror);
+#elif PIXEL_CONVERT_NEON
+    if (UseSimd()) x = RgbRowNeon(src, dst, width, mirror);
+#endif
+    RgbRowScalar(src, dst, x, width, mirror);
+}
+
+void ConvertBgrRow(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+#if PIXEL_CONVERT_SSSE3
+    if (UseSimd()) x = BgrRowSsse3(src, dst, width, mirror);
+#elif PIXEL_CONVERT_NEON
+    if (UseSimd()) x = BgrRowNeon(src, dst, width, mirror);
+#endif
+    BgrRowScalar(src, dst, x, width, mirror);
+}
+
+void ConvertRgbaRow(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+#if PIXEL_CONVERT_SSSE3
+    if (UseSimd()) x = RgbaRowSsse3(src, dst, width, mirror);
+#elif PIXEL_CONVERT_NEON
+    if (UseSimd()) x = RgbaRowNeon(src, dst, width, mirror);
+#endif
+    RgbaRowScalar(src, dst, x, width, mirror);
+}
+
+void ConvertNv12Row(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+#if PIXEL_CONVERT_SSSE3
+    if (UseSimd()) x = Nv12RowSsse3(y, uv, dst, width, mirror);
+#elif PIXEL_CONVERT_NEON
+    if (UseSimd()) x = Nv12RowNeon(y, uv, dst, width, mirror);
+#endif
+    Nv12RowScalar(y, uv, dst, x, width, mirror);
+}
+
+void ConvertI420Row(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                    uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+#if PIXEL_CONVERT_SSSE3
+    if (UseSimd()) x = I420RowSsse3(y, u, v, dst, width, mirror);
+#elif PIXEL_CONVERT_NEON
+    if (UseSimd()) x = I420RowNeon(y, u, v, dst, width, mirror);
+#endif
+    I420RowScalar(y, u, v, dst, x, width, mirror);
+}
+
+void ConvertYuyvRow(const uint8_t* src, uint8_t* dst, int width, bool mirror) {
+    int x = 0;
+#if PIXEL_CONVERT_SSSE3
+    if (UseSimd()) x = YuyvRowSsse3(src, dst, width, mirror);
+#elif PIXEL_CONVERT_NEON
+    if (UseSimd()) x = YuyvRowNeon(src, dst, width, mirror);
+#endif
+    YuyvRowScalar(src, dst, x, width, mirror);
+}
+
+// MJPEG frames are decoded by OpenCV into BGR, then converted like BGR24
+bool ConvertMjpeg(const MPFrame& frame, uint8_t* dst, int dst_stride, bool mirror) {
+    if (frame.data_size <= 0) {
+        return false;
+    }
+    const cv::Mat encoded(1, frame.data_size, CV_8UC1, const_cast<uint8_t*>(frame.pixels));
+    const cv::Mat bgr = cv::imdecode(encoded, cv::IMREAD_COLOR);
+    if (bgr.empty() || bgr.cols != frame.width || bgr.rows != frame.height) {
+        return false;
+    }
+    for (int row = 0; row < frame.height; ++row) {
+        ConvertBgrRow(bgr.ptr<uint8_t>(row), dst + static_cast<size_t>(row) * dst_stride,
+                      frame.width, mirror);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+bool SetSimdRowKernels(bool enabled) {
+    simd_enabled.store(enabled, std::memory_order_relaxed);
+    return UseSimd();
+}
+
+int MinFrameStride(MPPixelFormat format, int width) {
+    switch (format) {
+        case MP_PIXEL_RGB24:
+        case MP_PIXEL_BGR24:
+            return width * 3;
+        case MP_PIXEL_RGBA:
+            return width * 4;
+        case MP_PIXEL_NV12:
+            // The UV plane has the same stride and holds a U, V pair for
+            // every two pixels, rounded up
+            return (width + 1) & ~1;
+        case MP_PIXEL_I420:
+            return width;
+        case MP_PIXEL_YUYV:
+            return ((width + 1) / 2) * 4;
+        case MP_PIXEL_MJPEG:
+            return 0;
+    }
+    return 0;
+}
+
+bool ConvertFrameToRgb(const MPFrame& frame, uint8_t* dst, int dst_stride) {
+    if (!frame.pixels || !dst || frame.width <= 0 || frame.height <= 0 ||
+        dst_stride < frame.width * 3) {
+        return false;
+    }
+    if (frame.format < MP_PIXEL_RGB24 || frame.format > MP_PIXEL_MJPEG) {
+        return false;
+    }
+
+    const bool mirror = frame.flags & MP_FRAME_MIRROR;
+    if (frame.format == MP_PIXEL_MJPEG) {
+        return ConvertMjpeg(frame, dst, dst_stride, mirror);
+    }
+
+    const int min_stride = MinFrameStride(frame.format, frame.width);
+    const int stride = frame.stride == 0 ? min_stride : frame.stride;
+    if (stride < min_stride) {
+        return false;
+    }
+
+    const int width = frame.width;
+    const int height = frame.height;
+    const uint8_t* src = frame.pixels;
+    auto src_row = [&](const uint8_t* plane, int plane_stride, int row) {
+        return plane + static_cast<size_t>(row) * plane_stride;
+    };
+    auto dst_row = [&](int row) {
+        return dst + static_cast<size_t>(row) * dst_stride;
+    };
+
+    switch (frame.format) {
+        case MP_PIXEL_RGB24:
+            for (int row = 0; row < height; ++row) {
+                ConvertRgbRow(src_row(src, stride, row), dst_row(row), width, mirror);
+            }
+            break;
+
+        case MP_PIXEL_BGR24:
+            for (int row = 0; row < height; ++row) {
+                ConvertBgrRow(src_row(src, stride, row), dst_row(row), width, mirror);
+            }
+            break;
+
+        case MP_PIXEL_RGBA:
+            for (int row = 0; row < height; ++row) {
+                ConvertRgbaRow(src_row(src, stride, row), dst_row(row), width, mirror);
+            }
+            break;
+
+        case MP_PIXEL_YUYV:
+            for (int row = 0; row < height; ++row) {
+                ConvertYuyvRow(src_row(src, stride, row), dst_row(row), width, mirror);
+            }
+            break;
+
+        case MP_PIXEL_NV12: {
+            const uint8_t* uv = src + static_cast<size_t>(height) * stride;
+            for (int row = 0; row < height; ++row) {
+                ConvertNv12Row(src_row(src, stride, row), src_row(uv, stride, row / 2),
+                               dst_row(row), width, mirror);
+            }
+            break;
+        }
+
+        case MP_PIXEL_I420: {
+            const int chroma_stride = (stride + 1) / 2;
+            const int chroma_rows = (height + 1) / 2;
+            const uint8_t* u = src + static_cast<size_t>(height) * stride;
+            const uint8_t* v = u + static_cast<size_t>(chroma_rows) * chroma_stride;
+            for (int row = 0; row < height; ++row) {
+                ConvertI420Row(src_row(src, stride, row),
+                               src_row(u, chroma_stride, row / 2),
+                               src_row(v, chroma_stride, row / 2),
+                               dst_row(row), width, mirror);
+            }
+            break;
+        }
+
+        case MP_PIXEL_MJPEG:
+            break;
+    }
+    return true;
+}
+
+void ScaleRgb(const uint8_t* src, int src_stride, int width, int height,
+              uint8_t* dst, int dst_stride, int dst_width, int dst_height) {
+    const cv::Mat in(height, width, CV_8UC3, const_cast<uint8_t*>(src), src_stride);
+    cv::Mat out(dst_height, dst_width, CV_8UC3, dst, dst_stride);
+    const bool shrink = dst_width < width || dst_height < height;
+    cv::resize(in, out, out.size(), 0, 0, shrink ? cv::INTER_AREA : cv::INTER_LINEAR);
+}
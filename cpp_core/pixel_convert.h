@@ -0,0 +1,32 @@
+// pixel_convert.h
+// Fused conversion of camera pixel formats into packed RGB24
+
+#ifndef PIXEL_CONVERT_H
+#define PIXEL_CONVERT_H
+
+#include <cstdint>
+
+#include "mediapipe_bridge.h"
+
+// Smallest valid MPFrame::stride for `format` at `width` pixels.
+// Returns 0 for formats without rows (MP_PIXEL_MJPEG).
+int MinFrameStride(MPPixelFormat format, int width);
+
+// Convert `frame` into packed RGB24 rows at `dst` (`dst_stride` bytes per
+// row), applying MP_FRAME_MIRROR in the same pass. Uses SSSE3 or NEON row
+// kernels when available, with a scalar tail.
+// Returns false if the frame description is invalid or MJPEG decoding fails.
+bool ConvertFrameToRgb(const MPFrame& frame, uint8_t* dst, int dst_stride);
+
+// Allow (the default) or forbid the SIMD row kernels in later conversions,
+// so tests can check them against the scalar reference. Returns whether
+// SIMD kernels are now used: false if forbidden or the CPU has none.
+bool SetSimdRowKernels(bool enabled);
+
+// Resample the `width` x `height` RGB24 region at `src` into a
+// `dst_width` x `dst_height` one at `dst`, area-averaging when shrinking so
+// large downscales do not alias.
+void ScaleRgb(const uint8_t* src, int src_stride, int width, int height,
+              uint8_t* dst, int dst_stride, int dst_width, int dst_height);
+
+#endif // PIXEL_CONVERT_H
@@ -0,0 +1,211 @@
+// pixel_convert_test.cc
+// Tests for ConvertFrameToRgb and MinFrameStride
+
+#include "pixel_convert.h"
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr int kHeight = 3;  // odd, so the last chroma row covers one luma row
+constexpr int kWidths[] = {1, 15, 16, 17, 31, 33, 127};
+constexpr MPPixelFormat kFormats[] = {
+    MP_PIXEL_RGB24, MP_PIXEL_BGR24, MP_PIXEL_RGBA,
+    MP_PIXEL_NV12, MP_PIXEL_YUYV, MP_PIXEL_I420,
+};
+
+// Bytes a `height`-row frame occupies, with every plane `stride`-based
+size_t FrameBytes(MPPixelFormat format, int height, int stride) {
+    const size_t luma = static_cast<size_t>(height) * stride;
+    const size_t chroma_rows = (height + 1) / 2;
+    switch (format) {
+        case MP_PIXEL_NV12:
+            return luma + chroma_rows * stride;
+        case MP_PIXEL_I420:
+            return luma + 2 * chroma_rows * ((stride + 1) / 2);
+        default:
+            return luma;
+    }
+}
+
+// Exactly FrameBytes of noise, so kernels reading past the frame trip
+// AddressSanitizer
+std::vector<uint8_t> Noise(size_t size, uint32_t seed) {
+    std::vector<uint8_t> data(size);
+    for (uint8_t& value : data) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<uint8_t>(seed >> 24);
+    }
+    return data;
+}
+
+MPFrame Frame(const std::vector<uint8_t>& pixels, MPPixelFormat format, int width,
+              int stride, bool mirror, int height = kHeight) {
+    MPFrame frame = {};
+    frame.pixels = pixels.data();
+    frame.width = width;
+    frame.height = height;
+    frame.stride = stride;
+    frame.format = format;
+    frame.flags = mirror ? MP_FRAME_MIRROR : 0;
+    frame.data_size = static_cast<int>(pixels.size());
+    return frame;
+}
+
+// Packed RGB24 of `frame`, exactly width * 3 bytes per row
+std::vector<uint8_t> Convert(const MPFrame& frame) {
+    std::vector<uint8_t> rgb(static_cast<size_t>(frame.width) * 3 * frame.height);
+    EXPECT_TRUE(ConvertFrameToRgb(frame, rgb.data(), frame.width * 3));
+    return rgb;
+}
+
+class PixelConvertTest : public testing::Test {
+protected:
+    void TearDown() override { SetSimdRowKernels(true); }
+};
+
+// The SIMD kernels and their scalar tail must match the scalar reference
+// byte for byte, at widths around the 16-pixel block, for tight and padded
+// strides, mirrored or not
+TEST_F(PixelConvertTest, SimdMatchesScalar) {
+    if (!SetSimdRowKernels(true)) {
+        GTEST_SKIP() << "no SIMD row kernels on this CPU";
+    }
+    for (MPPixelFormat format : kFormats) {
+        for (int width : kWidths) {
+            const int min_stride = MinFrameStride(format, width);
+            for (int stride : {0, min_stride + 13}) {
+                const std::vector<uint8_t> pixels = Noise(
+                    FrameBytes(format, kHeight, stride ? stride : min_stride), width);
+                for (bool mirror : {false, true}) {
+                    const MPFrame frame = Frame(pixels, format, width, stride, mirror);
+                    SetSimdRowKernels(true);
+                    const std::vector<uint8_t> simd = Convert(frame);
+                    SetSimdRowKernels(false);
+                    const std::vector<uint8_t> scalar = Convert(frame);
+                    EXPECT_EQ(simd, scalar) << "format " << format << " width " << width
+                                            << " stride " << stride << " mirror " << mirror;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(PixelConvertTest, MirrorReversesRows) {
+    for (MPPixelFormat format : kFormats) {
+        for (int width : {17, 33}) {
+            const std::vector<uint8_t> pixels =
+                Noise(FrameBytes(format, kHeight, MinFrameStride(format, width)), 7);
+            const std::vector<uint8_t> plain = Convert(Frame(pixels, format, width, 0, false));
+            const std::vector<uint8_t> mirrored = Convert(Frame(pixels, format, width, 0, true));
+            for (int row = 0; row < kHeight; ++row) {
+                for (int x = 0; x < width; ++x) {
+                    const size_t from = (static_cast<size_t>(row) * width + x) * 3;
+                    const size_t to = (static_cast<size_t>(row) * width + width - 1 - x) * 3;
+                    ASSERT_EQ(memcmp(&plain[from], &mirrored[to], 3), 0)
+                        << "format " << format << " width " << width << " x " << x;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(PixelConvertTest, PackedChannelOrder) {
+    const std::vector<uint8_t> rgba = {10, 20, 30, 255, 40, 50, 60, 0};
+    EXPECT_EQ(Convert(Frame(rgba, MP_PIXEL_RGBA, 2, 0, false, 1)),
+              (std::vector<uint8_t>{10, 20, 30, 40, 50, 60}));
+    const std::vector<uint8_t> bgr = {10, 20, 30, 40, 50, 60};
+    EXPECT_EQ(Convert(Frame(bgr, MP_PIXEL_BGR24, 2, 0, false, 1)),
+              (std::vector<uint8_t>{30, 20, 10, 60, 50, 40}));
+}
+
+// The 6-bit fixed point maps limited-range white to 253; chroma extremes
+// saturate
+TEST_F(PixelConvertTest, YuvCoefficients) {
+    const std::vector<uint8_t> yuyv = {16, 128, 235, 128,  // black, white
+                                       235, 0, 235, 255};  // bright, U 0, V 255
+    EXPECT_EQ(Convert(Frame(yuyv, MP_PIXEL_YUYV, 4, 0, false, 1)),
+              (std::vector<uint8_t>{0, 0, 0, 253, 253, 253, 255, 200, 0, 255, 200, 0}));
+}
+
+// NV12 and I420 site each chroma sample on a 2 x 2 block of luma, so the
+// same planes convert identically in either layout
+TEST_F(PixelConvertTest, Nv12AndI420ShareChromaSiting) {
+    for (int width : kWidths) {
+        const int stride = MinFrameStride(MP_PIXEL_NV12, width);
+        const int chroma_width = (width + 1) / 2;
+        const int chroma_rows = (kHeight + 1) / 2;
+        const std::vector<uint8_t> nv12 =
+            Noise(FrameBytes(MP_PIXEL_NV12, kHeight, stride), 3);
+
+        // Same luma, UV pairs split into planes
+        const int chroma_stride = (stride + 1) / 2;
+        std::vector<uint8_t> i420(FrameBytes(MP_PIXEL_I420, kHeight, stride));
+        memcpy(i420.data(), nv12.data(), static_cast<size_t>(kHeight) * stride);
+        uint8_t* u = i420.data() + static_cast<size_t>(kHeight) * stride;
+        uint8_t* v = u + static_cast<size_t>(chroma_rows) * chroma_stride;
+        const uint8_t* uv = nv12.data() + static_cast<size_t>(kHeight) * stride;
+        for (int row = 0; row < chroma_rows; ++row) {
+            for (int c = 0; c < chroma_width; ++c) {
+                u[row * chroma_stride + c] = uv[row * stride + 2 * c];
+                v[row * chroma_stride + c] = uv[row * stride + 2 * c + 1];
+            }
+        }
+
+        for (bool mirror : {false, true}) {
+            EXPECT_EQ(Convert(Frame(nv12, MP_PIXEL_NV12, width, stride, mirror)),
+                      Convert(Frame(i420, MP_PIXEL_I420, width, stride, mirror)))
+                << "width " << width << " mirror " << mirror;
+        }
+    }
+
+    // Pixels (0, 0), (1, 0), (0, 1), (1, 1) share the first UV pair
+    const std::vector<uint8_t> block = {128, 128, 128, 128, 0, 255};
+    const std::vector<uint8_t> rgb = Convert(Frame(block, MP_PIXEL_NV12, 2, 0, false, 2));
+    for (int pixel = 1; pixel < 4; ++pixel) {
+        EXPECT_EQ(memcmp(&rgb[0], &rgb[3 * pixel], 3), 0) << "pixel " << pixel;
+    }
+}
+
+// The UV plane holds a whole U, V pair for the last pixel of an odd row
+TEST_F(PixelConvertTest, Nv12StrideRoundsWidthUpToEven) {
+    EXPECT_EQ(MinFrameStride(MP_PIXEL_NV12, 16), 16);
+    EXPECT_EQ(MinFrameStride(MP_PIXEL_NV12, 17), 18);
+    EXPECT_EQ(MinFrameStride(MP_PIXEL_NV12, 1), 2);
+    EXPECT_EQ(MinFrameStride(MP_PIXEL_I420, 17), 17);
+    EXPECT_EQ(MinFrameStride(MP_PIXEL_YUYV, 17), 36);
+    EXPECT_EQ(MinFrameStride(MP_PIXEL_MJPEG, 17), 0);
+
+    const std::vector<uint8_t> pixels = Noise(FrameBytes(MP_PIXEL_NV12, kHeight, 18), 5);
+    std::vector<uint8_t> rgb(17 * 3 * kHeight);
+    EXPECT_FALSE(ConvertFrameToRgb(Frame(pixels, MP_PIXEL_NV12, 17, 17, false),
+                                   rgb.data(), 17 * 3));
+    EXPECT_TRUE(ConvertFrameToRgb(Frame(pixels, MP_PIXEL_NV12, 17, 18, false),
+                                  rgb.data(), 17 * 3));
+    // Tightly packed (stride 0) means the rounded stride
+    EXPECT_EQ(Convert(Frame(pixels, MP_PIXEL_NV12, 17, 0, false)),
+              Convert(Frame(pixels, MP_PIXEL_NV12, 17, 18, false)));
+}
+
+TEST_F(PixelConvertTest, RejectsInvalidFrames) {
+    const std::vector<uint8_t> pixels(64 * 3);
+    std::vector<uint8_t> rgb(64 * 3);
+    const MPFrame frame = Frame(pixels, MP_PIXEL_RGB24, 16, 0, false, 1);
+    EXPECT_TRUE(ConvertFrameToRgb(frame, rgb.data(), 16 * 3));
+    EXPECT_FALSE(ConvertFrameToRgb(frame, rgb.data(), 16 * 3 - 1));
+
+    MPFrame narrow = frame;
+    narrow.stride = 16 * 3 - 1;
+    EXPECT_FALSE(ConvertFrameToRgb(narrow, rgb.data(), 16 * 3));
+    MPFrame empty = frame;
+    empty.width = 0;
+    EXPECT_FALSE(ConvertFrameToRgb(empty, rgb.data(), 16 * 3));
+    MPFrame unknown = frame;
+    unknown.format = static_cast<MPPixelFormat>(7);
+    EXPECT_FALSE(ConvertFrameToRgb(unknown, rgb.data(), 16 * 3));
+}
+
+} // namespace
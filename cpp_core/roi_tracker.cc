@@ -0,0 +1,182 @@
+// roi_tracker.cc
+// Region-of-interest cropping and input downscaling across frames
+
+#include "roi_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kDefaultMargin = 0.25f;
+
+// A crop covering more of the frame than this is not worth resampling
+constexpr float kMaxCropCoverage = 0.8f;
+
+// The box is re-fitted once the subject spans less than this fraction of
+// the extent it was fitted to (they moved away from the camera)
+constexpr float kMinFill = 0.5f;
+
+// Pose landmarks bounding the upper body, hands and hips (0-24); the head
+// and shoulders (0-12) give the tracking confidence
+constexpr int kBoxPoseLandmarks = 25;
+constexpr int kConfidencePoseLandmarks = 13;
+
+struct Box {
+    float x0 = 1.0f, y0 = 1.0f, x1 = 0.0f, y1 = 0.0f;
+
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+
+    void Add(float x, float y) {
+        x0 = std::min(x0, x);
+        y0 = std::min(y0, y);
+        x1 = std::max(x1, x);
+        y1 = std::max(y1, y);
+    }
+};
+
+// Map one landmark set from region-normalized to frame-normalized
+// coordinates. z shares the scale of x, so it follows the width.
+void MapSet(MPLandmark* aos, const MPLandmarkPlanes& planes, int count,
+            const InputRegion& region) {
+    const float sx = static_cast<float>(region.width) / region.frame_width;
+    const float sy = static_cast<float>(region.height) / region.frame_height;
+    const float ox = static_cast<float>(region.x) / region.frame_width;
+    const float oy = static_cast<float>(region.y) / region.frame_height;
+    for (int i = 0; i < count; ++i) {
+        float& x = aos ? aos[i].x : planes.x[i];
+        float& y = aos ? aos[i].y : planes.y[i];
+        float& z = aos ? aos[i].z : planes.z[i];
+        x = ox + x * sx;
+        y = oy + y * sy;
+        z *= sx;
+    }
+}
+
+void AddSet(const MPLandmark* aos, const MPLandmarkPlanes& planes, int count, Box* box) {
+    for (int i = 0; i < count; ++i) {
+        box->Add(aos ? aos[i].x : planes.x[i], aos ? aos[i].y : planes.y[i]);
+    }
+}
+
+} // anonymous namespace
+
+RoiTracker::RoiTracker(const MPInputScaling& config, float min_tracking_confidence)
+    : config_(config),
+      margin_(config.roi_margin > 0.0f ? config.roi_margin : kDefaultMargin),
+      min_confidence_(min_tracking_confidence) {}
+
+bool RoiTracker::Enabled(const MPInputScaling& config) {
+    return config.full_frame_size > 0 || config.roi_size > 0;
+}
+
+InputRegion RoiTracker::Plan(int width, int height) {
+    InputRegion region;
+    region.frame_width = width;
+    region.frame_height = height;
+    region.width = width;
+    region.height = height;
+    int limit = config_.full_frame_size;
+
+    if (config_.roi_size > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (tracking_) {
+            const int x0 = std::clamp(static_cast<int>(std::floor(box_[0] * width)), 0, width - 1);
+            const int y0 = std::clamp(static_cast<int>(std::floor(box_[1] * height)), 0, height - 1);
+            const int x1 = std::clamp(static_cast<int>(std::ceil(box_[2] * width)), x0 + 1, width);
+            const int y1 = std::clamp(static_cast<int>(std::ceil(box_[3] * height)), y0 + 1, height);
+            if (static_cast<float>(x1 - x0) * (y1 - y0) <
+                kMaxCropCoverage * static_cast<float>(width) * height) {
+                region.x = x0;
+                region.y = y0;
+                region.width = x1 - x0;
+                region.height = y1 - y0;
+                limit = config_.roi_size;
+            }
+        }
+    }
+
+    // Only ever shrink, keeping the aspect ratio
+    const int long_side = std::max(region.width, region.height);
+    region.scaled_width = region.width;
+    region.scaled_height = region.height;
+    if (limit > 0 && long_side > limit) {
+        const float scale = static_cast<float>(limit) / long_side;
+        region.scaled_width = std::max(1, static_cast<int>(std::lround(region.width * scale)));
+        region.scaled_height = std::max(1, static_cast<int>(std::lround(region.height * scale)));
+    }
+    return region;
+}
+
+void RoiTracker::Update(const InputRegion& region, MPResults* results) {
+    if (region.cropped()) {
+        MapSet(results->face_landmarks, results->face_planes, results->face_count, region);
+        MapSet(results->left_hand_landmarks, results->left_hand_planes,
+               results->left_hand_count, region);
+        MapSet(results->right_hand_landmarks, results->right_hand_planes,
+               results->right_hand_count, region);
+        MapSet(results->pose_landmarks, results->pose_planes, results->pose_count, region);
+    }
+    if (config_.roi_size <= 0) {
+        return;
+    }
+
+    // Holistic finds the face and hands from the pose, so the pose decides
+    float confidence = 0.0f;
+    const int confidence_count = std::min(results->pose_count, kConfidencePoseLandmarks);
+    if (results->pose_detected && confidence_count > 0) {
+        for (int i = 0; i < confidence_count; ++i) {
+            confidence += results->pose_landmarks ? results->pose_landmarks[i].visibility
+                                                  : results->pose_planes.visibility[i];
+        }
+        confidence /= confidence_count;
+    }
+
+    // Occluded or out-of-crop pose landmarks are still predicted, which lets
+    // the box grow towards a hand leaving it
+    Box subject;
+    AddSet(results->pose_landmarks, results->pose_planes,
+           std::min(results->pose_count, kBoxPoseLandmarks), &subject);
+    AddSet(results->face_landmarks, results->face_planes, results->face_count, &subject);
+    AddSet(results->left_hand_landmarks, results->left_hand_planes,
+           results->left_hand_count, &subject);
+    AddSet(results->right_hand_landmarks, results->right_hand_planes,
+           results->right_hand_count, &subject);
+    subject.x0 = std::max(subject.x0, 0.0f);
+    subject.y0 = std::max(subject.y0, 0.0f);
+    subject.x1 = std::min(subject.x1, 1.0f);
+    subject.y1 = std::min(subject.y1, 1.0f);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (confidence < min_confidence_ || subject.empty()) {
+        tracking_ = false;
+        return;
+    }
+
+    const float width = subject.x1 - subject.x0;
+    const float height = subject.y1 - subject.y0;
+    if (tracking_) {
+        // Keep the box while the subject stays inside its inner part, which
+        // leaves half of the margin as slack on every side not at the frame
+        // edge
+        const float box_width = box_[2] - box_[0];
+        const float box_height = box_[3] - box_[1];
+        const float slack = margin_ / (2.0f * (1.0f + 2.0f * margin_));
+        const bool inside =
+            (box_[0] <= 0.0f || subject.x0 >= box_[0] + slack * box_width) &&
+            (box_[1] <= 0.0f || subject.y0 >= box_[1] + slack * box_height) &&
+            (box_[2] >= 1.0f || subject.x1 <= box_[2] - slack * box_width) &&
+            (box_[3] >= 1.0f || subject.y1 <= box_[3] - slack * box_height);
+        const float fill = std::max(width / box_width, height / box_height) *
+                           (1.0f + 2.0f * margin_);
+        if (inside && fill >= kMinFill) {
+            return;
+        }
+    }
+
+    box_[0] = std::max(subject.x0 - margin_ * width, 0.0f);
+    box_[1] = std::max(subject.y0 - margin_ * height, 0.0f);
+    box_[2] = std::min(subject.x1 + margin_ * width, 1.0f);
+    box_[3] = std::min(subject.y1 + margin_ * height, 1.0f);
+    tracking_ = true;
+}
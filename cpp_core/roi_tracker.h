@@ -0,0 +1,58 @@
+// roi_tracker.h
+// Region-of-interest cropping and input downscaling across frames
+
+#ifndef ROI_TRACKER_H
+#define ROI_TRACKER_H
+
+#include <mutex>
+
+#include "mediapipe_bridge.h"
+
+// The part of a camera frame sent to the graph, and the size it was sent at
+struct InputRegion {
+    int frame_width = 0;   // camera frame, pixels
+    int frame_height = 0;
+    int x = 0;             // region in camera frame pixels
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    int scaled_width = 0;  // graph input, pixels
+    int scaled_height = 0;
+
+    bool cropped() const { return width != frame_width || height != frame_height; }
+    bool resampled() const {
+        return cropped() || scaled_width != width || scaled_height != height;
+    }
+};
+
+// Decides per frame what to send for MPConfig::input_scaling. While the
+// subject is tracked, frames are cropped to a padded box around the
+// previous results' landmarks; the box only moves once the landmarks leave
+// its inner part, so the graph sees a stable input between jumps. Once
+// tracking confidence drops below min_tracking_confidence, frames go in
+// whole (downscaled) until someone is found again. Thread-safe.
+class RoiTracker {
+public:
+    RoiTracker(const MPInputScaling& config, float min_tracking_confidence);
+
+    // Whether `config` changes the graph input at all
+    static bool Enabled(const MPInputScaling& config);
+
+    // Region and size to send for a `width` x `height` camera frame
+    InputRegion Plan(int width, int height);
+
+    // Map `results` of a frame sent as `region` back to camera frame
+    // coordinates (either landmark layout), then move the tracked box
+    void Update(const InputRegion& region, MPResults* results);
+
+private:
+    const MPInputScaling config_;
+    const float margin_;
+    const float min_confidence_;
+
+    std::mutex mutex_;
+    bool tracking_ = false;
+    float box_[4] = {0.0f, 0.0f, 1.0f, 1.0f};  // x0, y0, x1, y1, normalized
+};
+
+#endif // ROI_TRACKER_H
@@ -0,0 +1,167 @@
+// roi_tracker_test.cc
+// Tests for RoiTracker
+
+#include "roi_tracker.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr int kWidth = 640;
+constexpr int kHeight = 480;
+constexpr float kMinConfidence = 0.5f;
+
+MPInputScaling Scaling(int full_frame_size, int roi_size) {
+    MPInputScaling config = {};
+    config.full_frame_size = full_frame_size;
+    config.roi_size = roi_size;
+    return config;
+}
+
+// Results with an AoS pose spanning (x0, y0)-(x1, y1): landmark 0 at one
+// corner, 1 at the other, the rest in between
+struct Pose {
+    Pose(float x0, float y0, float x1, float y1, float visibility = 0.9f)
+        : landmarks(MP_MAX_POSE_LANDMARKS) {
+        for (MPLandmark& landmark : landmarks) {
+            landmark = {0.5f * (x0 + x1), 0.5f * (y0 + y1), 0.0f, visibility, 1.0f};
+        }
+        landmarks[0].x = x0;
+        landmarks[0].y = y0;
+        landmarks[1].x = x1;
+        landmarks[1].y = y1;
+        results.pose_landmarks = landmarks.data();
+        results.pose_count = MP_MAX_POSE_LANDMARKS;
+        results.pose_detected = true;
+    }
+
+    std::vector<MPLandmark> landmarks;
+    MPResults results = {};
+};
+
+// Feed a whole frame's results so the next Plan crops around them. The
+// subject spans (0.375, 0.25)-(0.625, 0.5), and the default margin pads it
+// to (0.3125, 0.1875)-(0.6875, 0.5625): pixels 200-440 by 90-270.
+void Track(RoiTracker* tracker) {
+    const InputRegion whole = tracker->Plan(kWidth, kHeight);
+    Pose pose(0.375f, 0.25f, 0.625f, 0.5f);
+    tracker->Update(whole, &pose.results);
+}
+
+TEST(RoiTrackerTest, DisabledSendsNativeFrames) {
+    EXPECT_FALSE(RoiTracker::Enabled(MPInputScaling{}));
+    RoiTracker tracker(MPInputScaling{}, kMinConfidence);
+    Track(&tracker);
+
+    const InputRegion region = tracker.Plan(kWidth, kHeight);
+    EXPECT_FALSE(region.resampled());
+    EXPECT_EQ(region.scaled_width, kWidth);
+    EXPECT_EQ(region.scaled_height, kHeight);
+}
+
+TEST(RoiTrackerTest, DownscalesWholeFrames) {
+    RoiTracker tracker(Scaling(320, 0), kMinConfidence);
+    const InputRegion region = tracker.Plan(kWidth, kHeight);
+    EXPECT_FALSE(region.cropped());
+    EXPECT_TRUE(region.resampled());
+    EXPECT_EQ(region.scaled_width, 320);
+    EXPECT_EQ(region.scaled_height, 240);
+
+    // Never upscales
+    RoiTracker large(Scaling(1280, 0), kMinConfidence);
+    EXPECT_FALSE(large.Plan(kWidth, kHeight).resampled());
+}
+
+TEST(RoiTrackerTest, CropsAroundTrackedSubject) {
+    RoiTracker tracker(Scaling(0, 128), kMinConfidence);
+    EXPECT_FALSE(tracker.Plan(kWidth, kHeight).cropped());
+    Track(&tracker);
+
+    const InputRegion region = tracker.Plan(kWidth, kHeight);
+    EXPECT_EQ(region.x, 200);
+    EXPECT_EQ(region.y, 90);
+    EXPECT_EQ(region.width, 240);
+    EXPECT_EQ(region.height, 180);
+    EXPECT_EQ(region.scaled_width, 128);
+    EXPECT_EQ(region.scaled_height, 96);
+}
+
+// Landmarks come back from the graph normalized to the crop and must be
+// reported in the camera frame, whichever layout holds them
+TEST(RoiTrackerTest, MapsCropResultsToFrame) {
+    RoiTracker tracker(Scaling(0, 128), kMinConfidence);
+    Track(&tracker);
+    const InputRegion region = tracker.Plan(kWidth, kHeight);
+    ASSERT_TRUE(region.cropped());
+
+    Pose pose(0.0f, 0.0f, 1.0f, 1.0f);
+    pose.landmarks[2] = {0.5f, 0.5f, 0.1f, 0.9f, 1.0f};
+    std::vector<float> face(5 * MP_MAX_FACE_LANDMARKS, 0.5f);
+    pose.results.face_planes = {&face[0], &face[MP_MAX_FACE_LANDMARKS],
+                                &face[2 * MP_MAX_FACE_LANDMARKS],
+                                &face[3 * MP_MAX_FACE_LANDMARKS],
+                                &face[4 * MP_MAX_FACE_LANDMARKS]};
+    pose.results.face_count = MP_MAX_FACE_LANDMARKS;
+    tracker.Update(region, &pose.results);
+
+    // Crop corners land on the region's corners
+    EXPECT_FLOAT_EQ(pose.landmarks[0].x, 200.0f / kWidth);
+    EXPECT_FLOAT_EQ(pose.landmarks[0].y, 90.0f / kHeight);
+    EXPECT_FLOAT_EQ(pose.landmarks[1].x, 440.0f / kWidth);
+    EXPECT_FLOAT_EQ(pose.landmarks[1].y, 270.0f / kHeight);
+    // The crop's center, with z scaled like x
+    EXPECT_FLOAT_EQ(pose.landmarks[2].x, 0.5f);
+    EXPECT_FLOAT_EQ(pose.landmarks[2].y, 0.375f);
+    EXPECT_FLOAT_EQ(pose.landmarks[2].z, 0.1f * 240.0f / kWidth);
+    // Scores are untouched
+    EXPECT_FLOAT_EQ(pose.landmarks[2].visibility, 0.9f);
+
+    EXPECT_FLOAT_EQ(face[0], 0.5f);
+    EXPECT_FLOAT_EQ(face[MP_MAX_FACE_LANDMARKS], 0.375f);
+    EXPECT_FLOAT_EQ(face[2 * MP_MAX_FACE_LANDMARKS], 0.5f * 240.0f / kWidth);
+    EXPECT_FLOAT_EQ(face[3 * MP_MAX_FACE_LANDMARKS], 0.5f);
+}
+
+// Small movements inside the box's inner part keep the crop still
+TEST(RoiTrackerTest, HoldsBoxUntilSubjectLeavesIt) {
+    RoiTracker tracker(Scaling(0, 128), kMinConfidence);
+    Track(&tracker);
+    const InputRegion tracked = tracker.Plan(kWidth, kHeight);
+
+    const InputRegion whole = {kWidth, kHeight, 0, 0, kWidth, kHeight, kWidth, kHeight};
+    Pose nudged(0.385f, 0.26f, 0.635f, 0.51f);
+    tracker.Update(whole, &nudged.results);
+    const InputRegion held = tracker.Plan(kWidth, kHeight);
+    EXPECT_EQ(held.x, tracked.x);
+    EXPECT_EQ(held.y, tracked.y);
+    EXPECT_EQ(held.width, tracked.width);
+
+    Pose moved(0.5f, 0.25f, 0.75f, 0.5f);
+    tracker.Update(whole, &moved.results);
+    const InputRegion refitted = tracker.Plan(kWidth, kHeight);
+    EXPECT_EQ(refitted.x, 280);  // 0.4375 of the width
+    EXPECT_EQ(refitted.width, 240);
+}
+
+TEST(RoiTrackerTest, LostSubjectSendsWholeFrames) {
+    RoiTracker tracker(Scaling(320, 128), kMinConfidence);
+    Track(&tracker);
+    ASSERT_TRUE(tracker.Plan(kWidth, kHeight).cropped());
+
+    const InputRegion whole = {kWidth, kHeight, 0, 0, kWidth, kHeight, kWidth, kHeight};
+    Pose unsure(0.375f, 0.25f, 0.625f, 0.5f, 0.2f);
+    tracker.Update(whole, &unsure.results);
+    const InputRegion region = tracker.Plan(kWidth, kHeight);
+    EXPECT_FALSE(region.cropped());
+    EXPECT_EQ(region.scaled_width, 320);
+
+    // Nobody found at all
+    Track(&tracker);
+    MPResults none = {};
+    tracker.Update(whole, &none);
+    EXPECT_FALSE(tracker.Plan(kWidth, kHeight).cropped());
+}
+
+} // namespace
@@ -0,0 +1,276 @@
+// shm_ring.cc
+// Results ring in POSIX shared memory: one writer, any number of readers
+
+#include "shm_ring.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr int kDefaultSlots = 8;
+constexpr int kMaxSlots = 1024;
+constexpr size_t kCacheLine = 64;
+
+static_assert(sizeof(MPShmHeader) == kCacheLine, "MPShmHeader fills one cache line");
+
+size_t SlotStride() {
+    return (sizeof(MPShmFrame) + kCacheLine - 1) / kCacheLine * kCacheLine;
+}
+
+// Whether process `pid` still exists
+bool ProcessAlive(int32_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+// Copy one landmark set from either layout
+void CopySet(const MPLandmark* aos, const MPLandmarkPlanes& planes, int count, int capacity,
+             MPLandmark* dst, int32_t* dst_count) {
+    count = std::min(count, capacity);
+    if (aos) {
+        memcpy(dst, aos, sizeof(MPLandmark) * std::max(count, 0));
+    } else if (planes.x) {
+        for (int i = 0; i < count; ++i) {
+            dst[i] = {planes.x[i], planes.y[i], planes.z[i],
+                      planes.visibility[i], planes.presence[i]};
+        }
+    } else {
+        count = 0;
+    }
+    *dst_count = std::max(count, 0);
+}
+
+// Open `name` exclusively, first removing a ring whose writer is gone
+int CreateObject(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd >= 0 || errno != EEXIST) {
+        return fd;
+    }
+
+    const int existing = shm_open(name.c_str(), O_RDONLY, 0);
+    if (existing >= 0) {
+        struct stat info;
+        if (fstat(existing, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(MPShmHeader)) {
+            void* base = mmap(nullptr, sizeof(MPShmHeader), PROT_READ, MAP_SHARED, existing, 0);
+            if (base != MAP_FAILED) {
+                const auto* header = static_cast<const MPShmHeader*>(base);
+                const bool live = header->magic == MP_SHM_MAGIC && !header->closed &&
+                                  ProcessAlive(header->writer_pid);
+                const int32_t pid = header->writer_pid;
+                munmap(base, sizeof(MPShmHeader));
+                if (live) {
+                    close(existing);
+                    throw std::runtime_error(
+                        "shm " + name + " is published by process " + std::to_string(pid));
+                }
+            }
+        }
+        close(existing);
+    }
+
+    shm_unlink(name.c_str());
+    return shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+}
+
+} // anonymous namespace
+
+std::unique_ptr<ShmRingWriter> ShmRingWriter::Create(const MPShmConfig& config) {
+    if (!config.name) {
+        return nullptr;
+    }
+    const std::string name = config.name;
+    if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos) {
+        throw std::runtime_error("shm name must be \"/name\" without further slashes");
+    }
+    if (config.slots < 0 || config.slots > kMaxSlots) {
+        throw std::runtime_error("shm slots must be 0 to " + std::to_string(kMaxSlots));
+    }
+    const int slots = config.slots > 0 ? config.slots : kDefaultSlots;
+    const size_t size = sizeof(MPShmHeader) + SlotStride() * slots;
+
+    const int fd = CreateObject(name);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open " + name + ": " + strerror(errno));
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        const int error = errno;
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Failed to size shm " + name + ": " + strerror(error));
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Failed to map shm " + name + ": " + strerror(error));
+    }
+
+    // Zero-filled by ftruncate; the magic goes last so readers never see
+    // a half-written header
+    auto* header = static_cast<MPShmHeader*>(base);
+    header->version = MP_SHM_VERSION;
+    header->frame_size = sizeof(MPShmFrame);
+    header->slot_stride = static_cast<uint32_t>(SlotStride());
+    header->slot_count = static_cast<uint32_t>(slots);
+    header->writer_pid = static_cast<int32_t>(getpid());
+    __atomic_store_n(&header->magic, MP_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    return std::unique_ptr<ShmRingWriter>(new ShmRingWriter(name, base, size));
+}
+
+ShmRingWriter::ShmRingWriter(std::string name, void* base, size_t size)
+    : name_(std::move(name)), base_(base), size_(size),
+      header_(static_cast<MPShmHeader*>(base)) {}
+
+ShmRingWriter::~ShmRingWriter() {
+    __atomic_store_n(&header_->closed, 1u, __ATOMIC_RELEASE);
+    munmap(base_, size_);
+    shm_unlink(name_.c_str());
+}
+
+MPShmFrame* ShmRingWriter::Slot(uint64_t sequence) const {
+    const size_t index = (sequence - 1) % header_->slot_count;
+    return reinterpret_cast<MPShmFrame*>(
+        static_cast<uint8_t*>(base_) + sizeof(MPShmHeader) + index * header_->slot_stride);
+}
+
+void ShmRingWriter::Publish(const MPResults& results, int64_t timestamp_us,
+                            float processing_time_ms) {
+    const uint64_t sequence = ++sequence_;
+    MPShmFrame* frame = Slot(sequence);
+
+    // Readers that see 0, or a sequence that changed across their copy,
+    // discard what they read
+    __atomic_store_n(&frame->sequence, uint64_t{0}, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    SnapshotResults(results, timestamp_us, processing_time_ms, frame);
+    __atomic_store_n(&frame->sequence, sequence, __ATOMIC_RELEASE);
+    __atomic_store_n(&header_->write_sequence, sequence, __ATOMIC_RELEASE);
+}
+
+void SnapshotResults(const MPResults& results, int64_t timestamp_us, float processing_time_ms,
+                     MPShmFrame* frame) {
+    frame->timestamp_us = timestamp_us;
+    frame->processing_time_ms = processing_time_ms;
+    frame->face_detected = results.face_detected;
+    frame->hands_detected = results.hands_detected;
+    frame->pose_detected = results.pose_detected;
+    frame->refine_face_landmarks = results.refine_face_landmarks;
+    frame->model_complexity = results.model_complexity;
+    memcpy(frame->blendshapes, results.blendshapes, sizeof(frame->blendshapes));
+    memcpy(frame->head_rotation, results.head_rotation, sizeof(frame->head_rotation));
+    memcpy(frame->head_translation, results.head_translation, sizeof(frame->head_translation));
+    CopySet(results.face_landmarks, results.face_planes, results.face_count,
+            MP_MAX_FACE_LANDMARKS, frame->face_landmarks, &frame->face_count);
+    CopySet(results.left_hand_landmarks, results.left_hand_planes, results.left_hand_count,
+            MP_MAX_HAND_LANDMARKS, frame->left_hand_landmarks, &frame->left_hand_count);
+    CopySet(results.right_hand_landmarks, results.right_hand_planes, results.right_hand_count,
+            MP_MAX_HAND_LANDMARKS, frame->right_hand_landmarks, &frame->right_hand_count);
+    CopySet(results.pose_landmarks, results.pose_planes, results.pose_count,
+            MP_MAX_POSE_LANDMARKS, frame->pose_landmarks, &frame->pose_count);
+    CopySet(results.pose_world_landmarks, results.pose_world_planes, results.pose_world_count,
+            MP_MAX_POSE_LANDMARKS, frame->pose_world_landmarks, &frame->pose_world_count);
+}
+
+std::unique_ptr<ShmRingReader> ShmRingReader::Open(const char* name, int* error,
+                                                   std::string* message) {
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        *error = 70;
+        *message = std::string("shm_open ") + name + ": " + strerror(errno);
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(MPShmHeader)) {
+        close(fd);
+        *error = 71;
+        *message = std::string("shm ") + name + " is not a results ring";
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        *error = 70;
+        *message = std::string("Failed to map shm ") + name + ": " + strerror(errno);
+        return nullptr;
+    }
+
+    const auto* header = static_cast<const MPShmHeader*>(base);
+    const bool compatible =
+        __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == MP_SHM_MAGIC &&
+        header->version == MP_SHM_VERSION &&
+        header->frame_size == sizeof(MPShmFrame) &&
+        header->slot_stride >= sizeof(MPShmFrame) &&
+        header->slot_count > 0 &&
+        size >= sizeof(MPShmHeader) + static_cast<size_t>(header->slot_stride) * header->slot_count;
+    if (!compatible) {
+        munmap(base, size);
+        *error = 71;
+        *message = std::string("shm ") + name + " has an incompatible layout";
+        return nullptr;
+    }
+    return std::unique_ptr<ShmRingReader>(new ShmRingReader(base, size));
+}
+
+ShmRingReader::ShmRingReader(const void* base, size_t size)
+    : base_(base), size_(size), header_(static_cast<const MPShmHeader*>(base)) {}
+
+ShmRingReader::~ShmRingReader() {
+    munmap(const_cast<void*>(base_), size_);
+}
+
+const MPShmFrame* ShmRingReader::Slot(uint64_t sequence) const {
+    const size_t index = (sequence - 1) % header_->slot_count;
+    return reinterpret_cast<const MPShmFrame*>(
+        static_cast<const uint8_t*>(base_) + sizeof(MPShmHeader) + index * header_->slot_stride);
+}
+
+const MPShmFrame* ShmRingReader::Next(bool latest, uint64_t* sequence) {
+    uint64_t newest = __atomic_load_n(&header_->write_sequence, __ATOMIC_ACQUIRE);
+    if (newest <= cursor_) {
+        return nullptr;
+    }
+
+    // The writer may already be rewriting the oldest slot, so a reader
+    // that fell behind resumes one past it
+    const uint64_t count = header_->slot_count;
+    const uint64_t oldest = newest >= count ? std::min(newest - count + 2, newest) : 1;
+    uint64_t wanted = latest ? newest : std::max(cursor_ + 1, oldest);
+
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        const MPShmFrame* frame = Slot(wanted);
+        if (__atomic_load_n(&frame->sequence, __ATOMIC_ACQUIRE) == wanted) {
+            cursor_ = wanted;
+            *sequence = wanted;
+            return frame;
+        }
+        // Overwritten since: take the newest instead
+        newest = __atomic_load_n(&header_->write_sequence, __ATOMIC_ACQUIRE);
+        if (newest == wanted) {
+            break;
+        }
+        wanted = newest;
+    }
+    return nullptr;
+}
+
+bool ShmRingReader::Valid(const MPShmFrame* frame, uint64_t sequence) const {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&frame->sequence, __ATOMIC_RELAXED) == sequence;
+}
+
+bool ShmRingReader::WriterClosed() const {
+    return __atomic_load_n(&header_->closed, __ATOMIC_ACQUIRE) != 0 ||
+           !ProcessAlive(header_->writer_pid);
+}
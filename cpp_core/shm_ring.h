@@ -0,0 +1,82 @@
+// shm_ring.h
+// Results ring in POSIX shared memory: one writer, any number of readers
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "mediapipe_bridge.h"
+
+// Copy `results` (either layout) into `frame`, all but `frame->sequence`
+void SnapshotResults(const MPResults& results, int64_t timestamp_us, float processing_time_ms,
+                     MPShmFrame* frame);
+
+// Publishes results into the MPShmHeader / MPShmFrame layout. Each slot is
+// a seqlock: its sequence is zeroed while the frame is rewritten, so
+// readers detect torn copies instead of waiting for the writer.
+class ShmRingWriter {
+public:
+    // Null when `config` has no name. Throws std::runtime_error if the
+    // object cannot be created or another live writer owns the name.
+    static std::unique_ptr<ShmRingWriter> Create(const MPShmConfig& config);
+
+    // Marks the ring closed and unlinks the name; readers keep their
+    // mappings
+    ~ShmRingWriter();
+
+    ShmRingWriter(const ShmRingWriter&) = delete;
+    ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+    // Write one frame of `results` (either layout) into the next slot.
+    // Callers serialize Publish.
+    void Publish(const MPResults& results, int64_t timestamp_us, float processing_time_ms);
+
+private:
+    ShmRingWriter(std::string name, void* base, size_t size);
+
+    MPShmFrame* Slot(uint64_t sequence) const;
+
+    const std::string name_;
+    void* const base_;
+    const size_t size_;
+    MPShmHeader* const header_;
+    uint64_t sequence_ = 0;
+};
+
+// Read side of the ring, mapped read-only
+class ShmRingReader {
+public:
+    // Null with `*error` set to 70 (no such ring) or 71 (incompatible
+    // layout), and `*message` describing it
+    static std::unique_ptr<ShmRingReader> Open(const char* name, int* error,
+                                               std::string* message);
+
+    ~ShmRingReader();
+
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    // The frame after the last one returned (`latest`: the newest), or
+    // null if none is newer
+    const MPShmFrame* Next(bool latest, uint64_t* sequence);
+
+    bool Valid(const MPShmFrame* frame, uint64_t sequence) const;
+
+    bool WriterClosed() const;
+
+private:
+    ShmRingReader(const void* base, size_t size);
+
+    const MPShmFrame* Slot(uint64_t sequence) const;
+
+    const void* const base_;
+    const size_t size_;
+    const MPShmHeader* const header_;
+    uint64_t cursor_ = 0;  // last sequence returned
+};
+
+#endif // SHM_RING_H
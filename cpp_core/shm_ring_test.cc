@@ -0,0 +1,289 @@
+// shm_ring_test.cc
+// Tests for ShmRingWriter and ShmRingReader
+
+#include "shm_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr int kSlots = 4;
+
+// Results whose only content is the frame number, in the timestamp
+struct Publisher {
+    explicit Publisher(ShmRingWriter* writer) : writer(writer) {}
+
+    void Publish(int count) {
+        for (int i = 0; i < count; ++i) {
+            ++published;
+            writer->Publish(results, published * 1000, 1.0f);
+        }
+    }
+
+    ShmRingWriter* writer;
+    MPResults results = {};
+    int64_t published = 0;
+};
+
+class ShmRingTest : public testing::Test {
+protected:
+    void SetUp() override {
+        // Unique per process and test, so parallel runs do not collide
+        name_ = "/miface_shm_test_" + std::to_string(getpid()) + "_" +
+                testing::UnitTest::GetInstance()->current_test_info()->name();
+    }
+
+    void TearDown() override { shm_unlink(name_.c_str()); }
+
+    std::unique_ptr<ShmRingWriter> CreateWriter(int slots = kSlots) {
+        MPShmConfig config = {};
+        config.name = name_.c_str();
+        config.slots = slots;
+        return ShmRingWriter::Create(config);
+    }
+
+    std::unique_ptr<ShmRingReader> OpenReader(int* error = nullptr) {
+        int code = 0;
+        std::string message;
+        auto reader = ShmRingReader::Open(name_.c_str(), &code, &message);
+        if (error) {
+            *error = code;
+        }
+        return reader;
+    }
+
+    // Leave an object at name_ holding `header` and `size` bytes in all, as
+    // a crashed or foreign writer would
+    void PlantObject(const MPShmHeader& header, size_t size) {
+        const int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(ftruncate(fd, static_cast<off_t>(size)), 0);
+        if (size >= sizeof(MPShmHeader)) {
+            void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ASSERT_NE(base, MAP_FAILED);
+            memcpy(base, &header, sizeof(header));
+            munmap(base, size);
+        }
+        close(fd);
+    }
+
+    // A header as a live writer of this build would leave it
+    MPShmHeader ValidHeader(int32_t writer_pid) const {
+        MPShmHeader header = {};
+        header.magic = MP_SHM_MAGIC;
+        header.version = MP_SHM_VERSION;
+        header.frame_size = sizeof(MPShmFrame);
+        header.slot_stride = (sizeof(MPShmFrame) + 63) / 64 * 64;
+        header.slot_count = kSlots;
+        header.writer_pid = writer_pid;
+        return header;
+    }
+
+    size_t RingBytes() const {
+        return sizeof(MPShmHeader) + ValidHeader(0).slot_stride * kSlots;
+    }
+
+    std::string name_;
+};
+
+// A process id that no longer exists
+int32_t DeadPid() {
+    const pid_t child = fork();
+    if (child == 0) {
+        _exit(0);
+    }
+    waitpid(child, nullptr, 0);
+    return static_cast<int32_t>(child);
+}
+
+TEST_F(ShmRingTest, RejectsBadConfig) {
+    EXPECT_EQ(ShmRingWriter::Create(MPShmConfig{}), nullptr);
+    MPShmConfig config = {};
+    config.name = "no_slash";
+    EXPECT_THROW(ShmRingWriter::Create(config), std::runtime_error);
+    config.name = "/nested/name";
+    EXPECT_THROW(ShmRingWriter::Create(config), std::runtime_error);
+    EXPECT_THROW(CreateWriter(-1), std::runtime_error);
+    EXPECT_THROW(CreateWriter(1025), std::runtime_error);
+}
+
+TEST_F(ShmRingTest, ReadsFramesInOrder) {
+    auto writer = CreateWriter();
+    ASSERT_NE(writer, nullptr);
+    auto reader = OpenReader();
+    ASSERT_NE(reader, nullptr);
+    uint64_t sequence = 0;
+    EXPECT_EQ(reader->Next(false, &sequence), nullptr);
+
+    Publisher publisher(writer.get());
+    publisher.results.face_detected = true;
+    publisher.Publish(3);
+    for (uint64_t expected = 1; expected <= 3; ++expected) {
+        const MPShmFrame* frame = reader->Next(false, &sequence);
+        ASSERT_NE(frame, nullptr);
+        EXPECT_EQ(sequence, expected);
+        EXPECT_EQ(frame->timestamp_us, static_cast<int64_t>(expected) * 1000);
+        EXPECT_TRUE(frame->face_detected);
+        EXPECT_TRUE(reader->Valid(frame, sequence));
+    }
+    EXPECT_EQ(reader->Next(false, &sequence), nullptr);
+    EXPECT_FALSE(reader->WriterClosed());
+}
+
+TEST_F(ShmRingTest, LatestSkipsAhead) {
+    auto writer = CreateWriter();
+    auto reader = OpenReader();
+    ASSERT_NE(reader, nullptr);
+    Publisher publisher(writer.get());
+    publisher.Publish(3);
+
+    uint64_t sequence = 0;
+    ASSERT_NE(reader->Next(true, &sequence), nullptr);
+    EXPECT_EQ(sequence, 3u);
+    EXPECT_EQ(reader->Next(false, &sequence), nullptr);
+}
+
+// The writer may be rewriting the oldest slot, so a lapped reader resumes
+// one past it
+TEST_F(ShmRingTest, LappedReaderResumesPastOldest) {
+    auto writer = CreateWriter();
+    auto reader = OpenReader();
+    ASSERT_NE(reader, nullptr);
+    Publisher publisher(writer.get());
+    publisher.Publish(10);
+
+    uint64_t sequence = 0;
+    for (uint64_t expected = 10 - kSlots + 2; expected <= 10; ++expected) {
+        const MPShmFrame* frame = reader->Next(false, &sequence);
+        ASSERT_NE(frame, nullptr);
+        EXPECT_EQ(sequence, expected);
+        EXPECT_EQ(frame->timestamp_us, static_cast<int64_t>(expected) * 1000);
+    }
+    EXPECT_EQ(reader->Next(false, &sequence), nullptr);
+}
+
+// A slot rewritten after Next returned it no longer validates, whether it
+// is mid-rewrite or already holds a newer frame
+TEST_F(ShmRingTest, ValidDetectsRewrittenSlot) {
+    auto writer = CreateWriter();
+    auto reader = OpenReader();
+    ASSERT_NE(reader, nullptr);
+    Publisher publisher(writer.get());
+    publisher.Publish(1);
+
+    uint64_t sequence = 0;
+    const MPShmFrame* frame = reader->Next(false, &sequence);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_TRUE(reader->Valid(frame, sequence));
+
+    publisher.Publish(kSlots);
+    EXPECT_FALSE(reader->Valid(frame, sequence));
+    EXPECT_EQ(frame->sequence, 1u + kSlots);
+
+    // Mid-rewrite the writer holds the slot's sequence at 0
+    ASSERT_TRUE(reader->Valid(frame, 1u + kSlots));
+    const int fd = shm_open(name_.c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    void* base = mmap(nullptr, RingBytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(base, MAP_FAILED);
+    auto* slot = reinterpret_cast<MPShmFrame*>(static_cast<uint8_t*>(base) +
+                                               sizeof(MPShmHeader));  // frames 1, 5, ...
+    slot->sequence = 0;
+    EXPECT_FALSE(reader->Valid(frame, 1u + kSlots));
+    munmap(base, RingBytes());
+}
+
+TEST_F(ShmRingTest, RefusesLiveWriter) {
+    auto writer = CreateWriter();
+    ASSERT_NE(writer, nullptr);
+    EXPECT_THROW(CreateWriter(), std::runtime_error);
+
+    // Another live process's ring is refused the same way
+    writer.reset();
+    PlantObject(ValidHeader(static_cast<int32_t>(getppid())), RingBytes());
+    EXPECT_THROW(CreateWriter(), std::runtime_error);
+}
+
+// A ring left behind by a crashed writer, a closed one or an unrelated
+// object is replaced
+TEST_F(ShmRingTest, TakesOverAbandonedObject) {
+    PlantObject(ValidHeader(DeadPid()), RingBytes());
+    EXPECT_NE(CreateWriter(), nullptr);
+
+    MPShmHeader closed = ValidHeader(static_cast<int32_t>(getpid()));
+    closed.closed = 1;
+    PlantObject(closed, RingBytes());
+    EXPECT_NE(CreateWriter(), nullptr);
+
+    PlantObject(MPShmHeader{}, 16);
+    auto writer = CreateWriter();
+    ASSERT_NE(writer, nullptr);
+    Publisher publisher(writer.get());
+    publisher.Publish(1);
+    auto reader = OpenReader();
+    ASSERT_NE(reader, nullptr);
+    uint64_t sequence = 0;
+    EXPECT_NE(reader->Next(false, &sequence), nullptr);
+}
+
+TEST_F(ShmRingTest, ReaderOutlivesWriter) {
+    auto writer = CreateWriter();
+    auto reader = OpenReader();
+    ASSERT_NE(reader, nullptr);
+    Publisher publisher(writer.get());
+    publisher.Publish(2);
+    writer.reset();
+
+    EXPECT_TRUE(reader->WriterClosed());
+    uint64_t sequence = 0;
+    EXPECT_NE(reader->Next(false, &sequence), nullptr);
+    // The name is gone with the writer
+    int error = 0;
+    EXPECT_EQ(OpenReader(&error), nullptr);
+    EXPECT_EQ(error, 70);
+}
+
+TEST_F(ShmRingTest, RejectsIncompatibleLayout) {
+    int error = 0;
+    EXPECT_EQ(OpenReader(&error), nullptr);
+    EXPECT_EQ(error, 70);
+
+    const int32_t pid = static_cast<int32_t>(getpid());
+    MPShmHeader version = ValidHeader(pid);
+    version.version = MP_SHM_VERSION + 1;
+    MPShmHeader frame_size = ValidHeader(pid);
+    frame_size.frame_size = sizeof(MPShmFrame) - 8;
+    MPShmHeader magic = ValidHeader(pid);
+    magic.magic = 0;
+    MPShmHeader slots = ValidHeader(pid);
+    slots.slot_count = 0;
+    for (const MPShmHeader& header : {version, frame_size, magic, slots}) {
+        PlantObject(header, RingBytes());
+        error = 0;
+        EXPECT_EQ(OpenReader(&error), nullptr);
+        EXPECT_EQ(error, 71);
+    }
+
+    // Slots that do not fit the object, and an object too small for a header
+    PlantObject(ValidHeader(pid), RingBytes() - 1);
+    EXPECT_EQ(OpenReader(&error), nullptr);
+    EXPECT_EQ(error, 71);
+    PlantObject(MPShmHeader{}, 16);
+    EXPECT_EQ(OpenReader(&error), nullptr);
+    EXPECT_EQ(error, 71);
+
+    PlantObject(ValidHeader(pid), RingBytes());
+    EXPECT_NE(OpenReader(), nullptr);
+}
+
+} // namespace
@@ -0,0 +1,165 @@
+package mediapipe
+
+/*
+#include "../../cpp_core/mediapipe_bridge.h"
+*/
+import "C"
+import (
+	"fmt"
+	"runtime"
+	"sync"
+	"time"
+	"unsafe"
+)
+
+// Pool runs several MediaPipe graphs side by side for multi-camera hosts.
+// Frames are tagged with a stream ID; a stream that is being tracked stays
+// on the graph holding its tracking state, while idle graphs pick up
+// streams that need a fresh detection. Submit and Poll are safe to call
+// from multiple goroutines.
+type Pool struct {
+	handle C.MPPoolHandle
+	mu     sync.RWMutex // Write-locked by Close
+	closed bool
+
+	pollBuffer *C.MPResultsBuffer // Result storage for Poll
+	pollMu     sync.Mutex
+}
+
+// NewPool creates a pool of `instances` graphs sharing one configuration.
+// One instance per camera gives every stream its own tracking state.
+func NewPool(config Config, instances int) (*Pool, error) {
+	cConfig := C.MPConfig{
+		model_complexity:         C.int(config.ModelComplexity),
+		min_detection_confidence: C.float(config.MinDetectionConfidence),
+		min_tracking_confidence:  C.float(config.MinTrackingConfidence),
+		static_image_mode:        C.bool(config.StaticImageMode),
+		smooth_landmarks:         C.bool(config.SmoothLandmarks),
+		refine_face_landmarks:    C.bool(config.RefineFaceLandmarks),
+		enable_segmentation:      C.bool(config.EnableSegmentation),
+		max_frames_in_flight:     C.int(config.MaxFramesInFlight),
+		enabled_outputs:          C.uint32_t(config.EnabledOutputs),
+		input_pool_size:          C.int(config.InputPoolSize),
+		smoothing:                config.Smoothing.toC(),
+		input_scaling:            config.InputScaling.toC(),
+		adaptive_complexity:      config.Adaptive.toC(),
+		threading:                config.Threading.toC(),
+		inference_backend:        C.MPInferenceBackend(config.InferenceBackend),
+		precision:                C.MPModelPrecision(config.Precision),
+		motion_gating:            config.MotionGating.toC(),
+	}
+	if config.SoALandmarks {
+		cConfig.landmark_layout = C.MP_LAYOUT_SOA
+	}
+
+	projection, freeProjection := config.Projection.toC()
+	defer freeProjection()
+	cConfig.projection = projection
+	shm, freeShm := config.ShmPublish.toC()
+	defer freeShm()
+	cConfig.shm_publish = shm
+
+	p := &Pool{}
+	if err := callLocked(func() bool {
+		p.handle = C.MP_CreatePool(&cConfig, C.int(instances))
+		return p.handle != nil
+	}); err != nil {
+		return nil, fmt.Errorf("mediapipe pool init failed: %s", C.GoString(&err.message[0]))
+	}
+
+	p.pollBuffer = C.MP_CreateResultsBuffer()
+	if p.pollBuffer == nil {
+		C.MP_DestroyPool(p.handle)
+		return nil, fmt.Errorf("mediapipe pool init failed: cannot allocate results buffer")
+	}
+
+	return p, nil
+}
+
+// Submit queues a raw frame of the given stream (see ProcessRaw for the
+// frame arguments). The frame is converted before Submit returns, so the
+// pixels may be reused immediately. Results come back from Poll.
+func (p *Pool) Submit(streamID uint32, tag uint64, pixels []byte, width, height, stride int, format PixelFormat, mirror bool) error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	if p.closed {
+		return fmt.Errorf("pool is closed")
+	}
+
+	if len(pixels) == 0 {
+		return fmt.Errorf("empty frame")
+	}
+
+	var pinner runtime.Pinner
+	pinner.Pin(&pixels[0])
+	defer pinner.Unpin()
+
+	cFrame := C.MPFrame{
+		pixels:    (*C.uint8_t)(unsafe.Pointer(&pixels[0])),
+		width:     C.int(width),
+		height:    C.int(height),
+		stride:    C.int(stride),
+		format:    C.MPPixelFormat(format),
+		data_size: C.int(len(pixels)),
+	}
+	if mirror {
+		cFrame.flags = C.MP_FRAME_MIRROR
+	}
+
+	var cErr C.MPError
+	if !C.MP_PoolSubmit(p.handle, C.uint32_t(streamID), &cFrame, C.uint64_t(tag), &cErr) {
+		return fmt.Errorf("mediapipe pool submit failed: %s", C.GoString(&cErr.message[0]))
+	}
+
+	return nil
+}
+
+// Poll waits up to timeout for the next completed frame of any stream.
+// It returns ok=false if none completed in time. A negative timeout waits
+// indefinitely.
+func (p *Pool) Poll(timeout time.Duration) (data *TrackingData, streamID uint32, tag uint64, ok bool, err error) {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	if p.closed {
+		return nil, 0, 0, false, fmt.Errorf("pool is closed")
+	}
+
+	p.pollMu.Lock()
+	defer p.pollMu.Unlock()
+
+	timeoutMs := -1
+	if timeout >= 0 {
+		timeoutMs = int(timeout / time.Millisecond)
+	}
+
+	var cStream C.uint32_t
+	var cTag C.uint64_t
+	var cErr C.MPError
+	switch C.MP_PoolPoll(p.handle, p.pollBuffer, &cStream, &cTag, C.int(timeoutMs), &cErr) {
+	case 1:
+		return convertResult(&p.pollBuffer.results), uint32(cStream), uint64(cTag), true, nil
+	case 0:
+		return nil, 0, 0, false, nil
+	default:
+		return nil, 0, 0, false, fmt.Errorf("mediapipe pool poll failed: %s", C.GoString(&cErr.message[0]))
+	}
+}
+
+// Close stops the pool and releases every graph. Queued frames are dropped.
+func (p *Pool) Close() error {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	if p.closed {
+		return nil
+	}
+
+	C.MP_DestroyPool(p.handle)
+	p.handle = nil
+	C.MP_DestroyResultsBuffer(p.pollBuffer)
+	p.pollBuffer = nil
+	p.closed = true
+	return nil
+}
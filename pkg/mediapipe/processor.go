@@ -11,7 +11,9 @@ package mediapipe
 import "C"
 import (
 	"fmt"
+	"runtime"
 	"sync"
+	"time"
 	"unsafe"
 
 	"gocv.io/x/gocv"
@@ -29,6 +31,98 @@ const (
 	ComplexityHeavy ModelComplexity = 2
 )
 
+// Output selects landmark sets computed by the graph. Subgraphs that no
+// enabled output needs are not instantiated; either hand keeps the pose
+// tracker running because hands are located from the pose.
+type Output uint32
+
+const (
+	// OutputFace enables the 468/478-point face mesh.
+	OutputFace Output = 1 << iota
+	// OutputPose enables the 33 normalized pose landmarks.
+	OutputPose
+	// OutputPoseWorld enables the 33 pose landmarks in meters.
+	OutputPoseWorld
+	// OutputLeftHand enables the 21 left hand landmarks.
+	OutputLeftHand
+	// OutputRightHand enables the 21 right hand landmarks.
+	OutputRightHand
+
+	// OutputAll enables every landmark set.
+	OutputAll = OutputFace | OutputPose | OutputPoseWorld | OutputLeftHand | OutputRightHand
+)
+
+// PixelFormat identifies the layout of raw frames passed to ProcessRaw.
+// The bridge converts them to RGB in a single pass, so camera frames can be
+// handed over without a Go or OpenCV conversion step.
+type PixelFormat int
+
+const (
+	// PixelRGB24 is packed 8-bit R, G, B.
+	PixelRGB24 PixelFormat = C.MP_PIXEL_RGB24
+	// PixelBGR24 is packed 8-bit B, G, R (OpenCV default).
+	PixelBGR24 PixelFormat = C.MP_PIXEL_BGR24
+	// PixelRGBA is packed 8-bit R, G, B, A.
+	PixelRGBA PixelFormat = C.MP_PIXEL_RGBA
+	// PixelNV12 is a Y plane followed by an interleaved UV plane.
+	PixelNV12 PixelFormat = C.MP_PIXEL_NV12
+	// PixelYUYV is packed 4:2:2 (Y0 U Y1 V), the common V4L2 webcam format.
+	PixelYUYV PixelFormat = C.MP_PIXEL_YUYV
+	// PixelI420 is Y, U and V planes with 2x2 subsampled chroma.
+	PixelI420 PixelFormat = C.MP_PIXEL_I420
+	// PixelMJPEG is one compressed JPEG frame.
+	PixelMJPEG PixelFormat = C.MP_PIXEL_MJPEG
+)
+
+// InferenceBackend selects how the models run.
+type InferenceBackend int
+
+const (
+	// BackendDefault keeps each model's delegate from the graph: XNNPACK
+	// on CPU builds, the GPU delegate on GPU builds.
+	BackendDefault InferenceBackend = C.MP_BACKEND_DEFAULT
+	// BackendTFLiteCPU uses TFLite's built-in CPU kernels without a delegate.
+	BackendTFLiteCPU InferenceBackend = C.MP_BACKEND_TFLITE_CPU
+	// BackendXNNPACK uses the XNNPACK CPU delegate.
+	BackendXNNPACK InferenceBackend = C.MP_BACKEND_XNNPACK
+	// BackendGPU uses the TFLite GPU delegate (GPU builds only).
+	BackendGPU InferenceBackend = C.MP_BACKEND_GPU
+	// BackendNNAPI uses the Android NNAPI delegate (Android builds only).
+	BackendNNAPI InferenceBackend = C.MP_BACKEND_NNAPI
+)
+
+// QueryBackends lists the inference backends compiled into the linked
+// bridge library. One may still fail to start on a machine without the
+// hardware, which NewMediaPipeProcessor then reports.
+func QueryBackends() []InferenceBackend {
+	mask := uint32(C.MP_QueryBackends())
+	var backends []InferenceBackend
+	for b := BackendDefault; b <= BackendNNAPI; b++ {
+		if mask&(1<<uint(b)) != 0 {
+			backends = append(backends, b)
+		}
+	}
+	return backends
+}
+
+// Precision selects the numeric format of the models the graph loads.
+// MediaPipe ships float models only: reduced variants are found as
+// <model>_fp16.tflite or <model>_int8.tflite next to each model or in
+// cpp_core/models, and a model without its variant loads as float.
+type Precision int
+
+const (
+	// PrecisionDefault uses the bridge build's default (float unless built
+	// with --define model_precision=...).
+	PrecisionDefault Precision = C.MP_PRECISION_DEFAULT
+	// PrecisionFloat uses the shipped float32 models.
+	PrecisionFloat Precision = C.MP_PRECISION_FLOAT
+	// PrecisionFP16 uses float16-weight variants.
+	PrecisionFP16 Precision = C.MP_PRECISION_FP16
+	// PrecisionINT8 uses int8-quantized variants.
+	PrecisionINT8 Precision = C.MP_PRECISION_INT8
+)
+
 // Config holds MediaPipe Holistic configuration.
 type Config struct {
 	// ModelComplexity controls the trade-off between speed and accuracy.
@@ -41,6 +135,264 @@ type Config struct {
 	StaticImageMode bool
 	// SmoothLandmarks applies temporal smoothing (only when StaticImageMode=false).
 	SmoothLandmarks bool
+	// RefineFaceLandmarks adds the 10 iris landmarks (478 instead of 468 points).
+	RefineFaceLandmarks bool
+	// EnableSegmentation makes the pose model also compute a person mask.
+	EnableSegmentation bool
+	// EnabledOutputs selects which landmark sets to compute (0 = OutputAll).
+	EnabledOutputs Output
+	// MaxFramesInFlight is how many submitted frames may be inside the graph
+	// at once (0 = 1). Values above 1 let consecutive frames overlap stages.
+	MaxFramesInFlight int
+	// BorrowInput lets Process hand the frame's pixels to the graph without
+	// copying them. Process then blocks until the graph has released the
+	// frame; the default copies the pixels once instead.
+	BorrowInput bool
+	// InputPoolSize is how many input frame buffers the bridge recycles
+	// (0 = MaxFramesInFlight + 2).
+	InputPoolSize int
+	// OfflineMode removes the flow limiter so no frame is ever dropped, for
+	// processing recorded footage with ProcessBatch.
+	OfflineMode bool
+	// EnableProfiling collects per-calculator timing for Stats at a small
+	// per-frame cost.
+	EnableProfiling bool
+	// Realtime makes Submit keep only the newest frame waiting for the
+	// graph: a frame that has not started processing when the next one
+	// arrives is dropped, bounding latency under load.
+	Realtime bool
+	// SoALandmarks has the bridge write landmarks as one 64-byte aligned
+	// float plane per field instead of per-point structs, for vectorized
+	// post-processing of the C results.
+	SoALandmarks bool
+	// Smoothing filters landmarks inside the bridge, after MediaPipe's own
+	// smoothing, so results arrive already smoothed.
+	Smoothing SmoothingConfig
+	// Projection limits the landmarks copied per frame, e.g. to the few a
+	// VMC sender needs besides blendshapes and head pose.
+	Projection ProjectionConfig
+	// InputScaling shrinks high-resolution camera frames before inference,
+	// cropping to the tracked subject when ROISize is set.
+	InputScaling InputScaling
+	// Adaptive lets the bridge trade ModelComplexity and
+	// RefineFaceLandmarks (the upper bounds) for latency on slower machines.
+	Adaptive AdaptiveComplexity
+	// Threading bounds and pins the graph's threads, e.g. to run several
+	// processors per host without oversubscribing cores.
+	Threading Threading
+	// InferenceBackend runs every model on one backend; see QueryBackends.
+	InferenceBackend InferenceBackend
+	// Precision picks float, fp16 or int8 model variants; see
+	// Stats.VariantModels for how many were found.
+	Precision Precision
+	// ShmPublish mirrors every frame's results into a shared-memory ring
+	// that other local processes read through the C MP_Shm* API.
+	ShmPublish ShmPublish
+	// MotionGating answers near-still Process / ProcessRaw / ProcessRawAt
+	// frames with extrapolated landmarks instead of running the graph.
+	MotionGating MotionGating
+}
+
+// ShmPublish names the POSIX shared memory object results are published
+// to. The zero value publishes nothing; pools do not support it.
+type ShmPublish struct {
+	// Name is the shm_open name, such as "/miface".
+	Name string
+	// Slots is how many frames the ring keeps for readers (0 = 8).
+	Slots int
+}
+
+func (s ShmPublish) toC() (C.MPShmConfig, func()) {
+	if s.Name == "" {
+		return C.MPShmConfig{}, func() {}
+	}
+	name := C.CString(s.Name)
+	return C.MPShmConfig{name: name, slots: C.int(s.Slots)},
+		func() { C.free(unsafe.Pointer(name)) }
+}
+
+// Threading controls the threads a graph runs on. Calculators run on the
+// executor; every TFLite model runs on InferenceThreads threads of its
+// own. The zero value keeps MediaPipe's defaults.
+type Threading struct {
+	// ExecutorThreads is the calculator thread count (0 = the cores in
+	// CPUAffinity, else MediaPipe's default).
+	ExecutorThreads int
+	// InferenceThreads is the TFLite / XNNPACK thread count per model.
+	InferenceThreads int
+	// CPUAffinity pins executor and inference threads to cores, bit i
+	// for core i (0 = any core).
+	CPUAffinity uint64
+	// Shared makes processors with equal ExecutorThreads and CPUAffinity
+	// share one executor, trading per-stream latency for throughput.
+	Shared bool
+}
+
+func (t Threading) toC() C.MPThreading {
+	return C.MPThreading{
+		executor_threads:  C.int(t.ExecutorThreads),
+		inference_threads: C.int(t.InferenceThreads),
+		cpu_affinity:      C.uint64_t(t.CPUAffinity),
+		shared:            C.bool(t.Shared),
+	}
+}
+
+// AdaptiveComplexity switches between pipelines from MinModelComplexity
+// without face refinement up to the configured ones, dropping a tier when
+// the rolling p90 latency misses TargetLatency and returning once there is
+// headroom. Neighbouring pipelines are kept loaded so switching does not
+// stall. The zero value keeps the configured pipeline.
+type AdaptiveComplexity struct {
+	// TargetLatency is the per-frame budget, e.g. 16.6ms to hold 60 fps.
+	TargetLatency time.Duration
+	// MinModelComplexity is the cheapest model allowed (0 = Lite).
+	MinModelComplexity int
+	// KeepRefinement never turns RefineFaceLandmarks off.
+	KeepRefinement bool
+}
+
+func (a AdaptiveComplexity) toC() C.MPAdaptiveComplexity {
+	return C.MPAdaptiveComplexity{
+		target_latency_ms:    C.float(float64(a.TargetLatency) / float64(time.Millisecond)),
+		min_model_complexity: C.int(a.MinModelComplexity),
+		keep_refinement:      C.bool(a.KeepRefinement),
+	}
+}
+
+// InputScaling downscales and crops the frames fed to the graph. While
+// someone is tracked, frames are cropped around the previous landmarks;
+// below MinTrackingConfidence whole frames are sent for re-detection.
+// Landmarks are always relative to the whole frame. Zero values keep
+// whole frames at native resolution.
+type InputScaling struct {
+	// FullFrameSize is the longest side of whole frames, in pixels.
+	FullFrameSize int
+	// ROISize is the longest side of crops, in pixels (0 = never crop).
+	ROISize int
+	// ROIMargin pads the crop per side, as a fraction of the subject's
+	// extent (0 = 0.25).
+	ROIMargin float32
+}
+
+func (s InputScaling) toC() C.MPInputScaling {
+	return C.MPInputScaling{
+		full_frame_size: C.int(s.FullFrameSize),
+		roi_size:        C.int(s.ROISize),
+		roi_margin:      C.float(s.ROIMargin),
+	}
+}
+
+// MotionGating skips the graph for synchronously processed frames that
+// barely differ from the last inferred one while the landmarks move
+// slowly; TrackingData.Predicted marks their extrapolated results. The
+// zero value always runs the graph; pools do not support it.
+type MotionGating struct {
+	// MaxSkip is the most consecutive frames answered without the graph.
+	MaxSkip int
+	// MotionThreshold is the largest mean luma change of any image cell,
+	// 0-255, that still counts as still (0 = 4).
+	MotionThreshold float32
+	// MaxVelocity is the fastest landmark speed, in normalized units per
+	// second, that still counts as still (0 = 0.5).
+	MaxVelocity float32
+}
+
+func (g MotionGating) toC() C.MPMotionGating {
+	return C.MPMotionGating{
+		max_skip:         C.int(g.MaxSkip),
+		motion_threshold: C.float(g.MotionThreshold),
+		max_velocity:     C.float(g.MaxVelocity),
+	}
+}
+
+// ProjectionConfig reduces the landmarks copied out of the bridge. For
+// each part, nil keeps every landmark and an empty non-nil slice keeps
+// none; blendshapes and head pose are solved either way. Selected
+// landmarks are returned in the order given.
+type ProjectionConfig struct {
+	FaceIndices []int // face mesh indices
+	HandIndices []int // hand indices, for both hands
+	PoseIndices []int // pose indices
+	// DropScores skips visibility and presence (reported as 1).
+	DropScores bool
+	// Quantize transfers coordinates as int16 (1/16384 resolution).
+	Quantize bool
+}
+
+// toC returns the C projection and a function freeing its index arrays,
+// which the bridge copies during creation.
+func (p ProjectionConfig) toC() (C.MPOutputProjection, func()) {
+	var cProjection C.MPOutputProjection
+	var allocations []unsafe.Pointer
+
+	indices := func(values []int) (*C.int, C.int) {
+		switch {
+		case values == nil:
+			return nil, 0
+		case len(values) == 0:
+			return nil, C.MP_PROJECTION_NONE
+		}
+		array := C.malloc(C.size_t(len(values)) * C.size_t(unsafe.Sizeof(C.int(0))))
+		allocations = append(allocations, array)
+		cValues := unsafe.Slice((*C.int)(array), len(values))
+		for i, v := range values {
+			cValues[i] = C.int(v)
+		}
+		return (*C.int)(array), C.int(len(values))
+	}
+
+	cProjection.face_indices, cProjection.face_index_count = indices(p.FaceIndices)
+	cProjection.hand_indices, cProjection.hand_index_count = indices(p.HandIndices)
+	cProjection.pose_indices, cProjection.pose_index_count = indices(p.PoseIndices)
+	cProjection.drop_scores = C.bool(p.DropScores)
+	if p.Quantize {
+		cProjection.format = C.MP_COMPACT_INT16
+	}
+
+	return cProjection, func() {
+		for _, array := range allocations {
+			C.free(array)
+		}
+	}
+}
+
+// SmoothingFilter selects the bridge-side landmark filter.
+type SmoothingFilter int
+
+const (
+	// SmoothingNone leaves landmarks as MediaPipe produced them.
+	SmoothingNone SmoothingFilter = C.MP_SMOOTHING_NONE
+	// SmoothingOneEuro is a speed-adaptive low-pass filter.
+	SmoothingOneEuro SmoothingFilter = C.MP_SMOOTHING_ONE_EURO
+	// SmoothingKalman is a constant-velocity Kalman filter.
+	SmoothingKalman SmoothingFilter = C.MP_SMOOTHING_KALMAN
+)
+
+// SmoothingConfig holds bridge-side smoothing parameters. Zero values
+// select the defaults documented in mediapipe_bridge.h.
+type SmoothingConfig struct {
+	Filter SmoothingFilter
+	// MinCutoff is the One-Euro cutoff at rest in Hz.
+	MinCutoff float32
+	// Beta is how fast the One-Euro cutoff rises with speed.
+	Beta float32
+	// DerivativeCutoff is the One-Euro speed low-pass cutoff in Hz.
+	DerivativeCutoff float32
+	// ProcessNoise is the Kalman acceleration noise density.
+	ProcessNoise float32
+	// MeasurementNoise is the Kalman measurement variance.
+	MeasurementNoise float32
+}
+
+func (s SmoothingConfig) toC() C.MPSmoothingConfig {
+	return C.MPSmoothingConfig{
+		filter:            C.MPSmoothingFilter(s.Filter),
+		min_cutoff:        C.float(s.MinCutoff),
+		beta:              C.float(s.Beta),
+		derivative_cutoff: C.float(s.DerivativeCutoff),
+		process_noise:     C.float(s.ProcessNoise),
+		measurement_noise: C.float(s.MeasurementNoise),
+	}
 }
 
 // DefaultConfig returns a recommended configuration for real-time VTubing.
@@ -54,18 +406,82 @@ func DefaultConfig() Config {
 	}
 }
 
+// maxIdleBuffers bounds the result buffers a processor keeps between calls.
+const maxIdleBuffers = 8
+
 // MediaPipeProcessor implements the Processor interface using MediaPipe Holistic.
+// It is safe for concurrent use: calls from several goroutines, such as a
+// capture loop submitting while another goroutine polls or processes, run
+// in the bridge at the same time.
 type MediaPipeProcessor struct {
 	config Config
-	handle C.MPHandle // Opaque C++ object handle
-	mu     sync.Mutex
+	handle C.MPHandle   // Opaque C++ object handle
+	mu     sync.RWMutex // Read-locked by every call, write-locked by Close
 	closed bool
+
+	// Idle result storage; each call takes its own buffer and returns it
+	// once the results are converted
+	buffers chan *C.MPResultsBuffer
+
+	// C arrays for ProcessBatch, grown on demand and reused
+	batchMu         sync.Mutex
+	batchFrames     *C.MPFrame
+	batchResults    *C.MPResultsBuffer
+	batchTimestamps *C.int64_t
+	batchCap        int
+}
+
+// RawFrame describes one frame for ProcessBatch (see ProcessRaw).
+type RawFrame struct {
+	Pixels []byte
+	Width  int
+	Height int
+	Stride int
+	Format PixelFormat
+	Mirror bool
+	// CaptureTimestampUs is the capture time in microseconds (see
+	// ProcessRawAt). Set it on every frame of a batch, strictly increasing,
+	// so smoothing sees the footage's real frame rate; leave it zero on all
+	// frames to stamp them as they are submitted.
+	CaptureTimestampUs int64
 }
 
 // NewMediaPipeProcessor creates a new MediaPipe processor instance.
 func NewMediaPipeProcessor(config Config) (*MediaPipeProcessor, error) {
+	return newProcessor(config, func(cConfig *C.MPConfig) C.MPHandle {
+		return C.MP_Create(cConfig)
+	})
+}
+
+// NewMediaPipeProcessorFromGraph creates a processor that runs graph, a
+// text or binary CalculatorGraphConfig, instead of the built-in holistic
+// graph. Binary graphs skip text parsing at startup. See
+// MP_CreateFromGraph for the streams and side packets the graph may use.
+func NewMediaPipeProcessorFromGraph(config Config, graph []byte) (*MediaPipeProcessor, error) {
+	if len(graph) == 0 {
+		return nil, fmt.Errorf("empty graph config")
+	}
+	return newProcessor(config, func(cConfig *C.MPConfig) C.MPHandle {
+		// The bridge copies the bytes before returning
+		return C.MP_CreateFromGraph(cConfig, unsafe.Pointer(&graph[0]), C.size_t(len(graph)))
+	})
+}
+
+// NewMediaPipeProcessorFromGraphFile is NewMediaPipeProcessorFromGraph
+// with the graph read from a .pbtxt or .binarypb file.
+func NewMediaPipeProcessorFromGraphFile(config Config, path string) (*MediaPipeProcessor, error) {
+	return newProcessor(config, func(cConfig *C.MPConfig) C.MPHandle {
+		cPath := C.CString(path)
+		defer C.free(unsafe.Pointer(cPath))
+		return C.MP_CreateFromGraph(cConfig, unsafe.Pointer(cPath), 0)
+	})
+}
+
+// newProcessor converts config and creates the bridge handle with create.
+func newProcessor(config Config, create func(*C.MPConfig) C.MPHandle) (*MediaPipeProcessor, error) {
 	p := &MediaPipeProcessor{
-		config: config,
+		config:  config,
+		buffers: make(chan *C.MPResultsBuffer, maxIdleBuffers),
 	}
 
 	// Initialize the C++ bridge
@@ -75,24 +491,152 @@ func NewMediaPipeProcessor(config Config) (*MediaPipeProcessor, error) {
 		min_tracking_confidence:  C.float(config.MinTrackingConfidence),
 		static_image_mode:        C.bool(config.StaticImageMode),
 		smooth_landmarks:         C.bool(config.SmoothLandmarks),
-		refine_face_landmarks:    C.bool(false), // Not exposed in Go config yet
-		enable_segmentation:      C.bool(false), // Not exposed in Go config yet
+		refine_face_landmarks:    C.bool(config.RefineFaceLandmarks),
+		enable_segmentation:      C.bool(config.EnableSegmentation),
+		max_frames_in_flight:     C.int(config.MaxFramesInFlight),
+		enabled_outputs:          C.uint32_t(config.EnabledOutputs),
+		input_pool_size:          C.int(config.InputPoolSize),
+		offline_mode:             C.bool(config.OfflineMode),
+		enable_profiling:         C.bool(config.EnableProfiling),
+		realtime_mode:            C.bool(config.Realtime),
+		smoothing:                config.Smoothing.toC(),
+		input_scaling:            config.InputScaling.toC(),
+		adaptive_complexity:      config.Adaptive.toC(),
+		threading:                config.Threading.toC(),
+		inference_backend:        C.MPInferenceBackend(config.InferenceBackend),
+		precision:                C.MPModelPrecision(config.Precision),
+		motion_gating:            config.MotionGating.toC(),
+	}
+	if config.BorrowInput {
+		cConfig.input_ownership = C.MP_INPUT_BORROWED
 	}
+	if config.SoALandmarks {
+		cConfig.landmark_layout = C.MP_LAYOUT_SOA
+	}
+	projection, freeProjection := config.Projection.toC()
+	defer freeProjection()
+	cConfig.projection = projection
+	shm, freeShm := config.ShmPublish.toC()
+	defer freeShm()
+	cConfig.shm_publish = shm
 
-	p.handle = C.MP_Create(&cConfig)
-	if p.handle == nil {
-		err := C.MP_GetLastError(p.handle)
+	if err := callLocked(func() bool {
+		p.handle = create(&cConfig)
+		return p.handle != nil
+	}); err != nil {
 		return nil, fmt.Errorf("mediapipe init failed: %s", C.GoString(&err.message[0]))
 	}
 
+	buffer := C.MP_CreateResultsBuffer()
+	if buffer == nil {
+		p.destroy()
+		return nil, fmt.Errorf("mediapipe init failed: cannot allocate results buffer")
+	}
+	p.buffers <- buffer
+
 	return p, nil
 }
 
+// callLocked runs a bridge call that has no MPError out-parameter with the
+// goroutine held on its OS thread, so the per-thread error read afterwards
+// is that call's. It returns nil if call reports success.
+func callLocked(call func() bool) *C.MPError {
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+
+	if call() {
+		return nil
+	}
+	err := C.MP_GetLastError(nil)
+	return &err
+}
+
+// acquireBuffer takes an idle result buffer, or allocates one if every
+// buffer is in use by another call.
+func (p *MediaPipeProcessor) acquireBuffer() (*C.MPResultsBuffer, error) {
+	select {
+	case buffer := <-p.buffers:
+		return buffer, nil
+	default:
+	}
+
+	buffer := C.MP_CreateResultsBuffer()
+	if buffer == nil {
+		return nil, fmt.Errorf("cannot allocate results buffer")
+	}
+	return buffer, nil
+}
+
+// releaseBuffer keeps buffer for a later call, or frees it if enough are
+// idle already.
+func (p *MediaPipeProcessor) releaseBuffer(buffer *C.MPResultsBuffer) {
+	select {
+	case p.buffers <- buffer:
+	default:
+		C.MP_DestroyResultsBuffer(buffer)
+	}
+}
+
+// Warmup runs a few blank width x height frames through the graph so the
+// first real frame does not pay for one-time setup. Their results are
+// discarded. Call it before the first frame; it uses the lowest graph
+// timestamps, so ProcessRawAt timestamps must then start above 2.
+func (p *MediaPipeProcessor) Warmup(width, height int) error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	if p.closed {
+		return fmt.Errorf("processor is closed")
+	}
+
+	if err := callLocked(func() bool {
+		return bool(C.MP_Warmup(p.handle, C.int(width), C.int(height)))
+	}); err != nil {
+		return fmt.Errorf("mediapipe warm-up failed: %s", C.GoString(&err.message[0]))
+	}
+	return nil
+}
+
+// RecordStart records every frame's results to path until RecordStop or
+// Close, in the bridge's compact binary format (see OpenRecording). Frames
+// are written by a background thread and dropped rather than waited for
+// if the disk falls behind.
+func (p *MediaPipeProcessor) RecordStart(path string) error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	if p.closed {
+		return fmt.Errorf("processor is closed")
+	}
+
+	cPath := C.CString(path)
+	defer C.free(unsafe.Pointer(cPath))
+	if err := callLocked(func() bool { return bool(C.MP_RecordStart(p.handle, cPath)) }); err != nil {
+		return fmt.Errorf("mediapipe record start failed: %s", C.GoString(&err.message[0]))
+	}
+	return nil
+}
+
+// RecordStop finishes the recording started by RecordStart.
+func (p *MediaPipeProcessor) RecordStop() error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	if p.closed {
+		return fmt.Errorf("processor is closed")
+	}
+
+	if err := callLocked(func() bool { return bool(C.MP_RecordStop(p.handle)) }); err != nil {
+		return fmt.Errorf("mediapipe record stop failed: %s", C.GoString(&err.message[0]))
+	}
+	return nil
+}
+
 // Process processes a single frame and returns tracking data.
 // The input frame must be in RGB format (gocv.MatTypeCV8UC3).
 func (p *MediaPipeProcessor) Process(frame gocv.Mat) (*TrackingData, error) {
-	p.mu.Lock()
-	defer p.mu.Unlock()
+	p.mu.RLock()
+	defer p.mu.RUnlock()
 
 	if p.closed {
 		return nil, fmt.Errorf("processor is closed")
@@ -113,109 +657,423 @@ func (p *MediaPipeProcessor) Process(frame gocv.Mat) (*TrackingData, error) {
 	// Get raw pixel data pointer
 	pixels, _ := frame.DataPtrUint8()
 
-	// Call C++ bridge to process frame
-	var result C.MPResults
-	success := C.MP_Process(
+	buffer, err := p.acquireBuffer()
+	if err != nil {
+		return nil, err
+	}
+	defer p.releaseBuffer(buffer)
+
+	// Call C++ bridge to process frame into this call's buffer
+	var cErr C.MPError
+	success := C.MP_ProcessInto(
 		p.handle,
 		(*C.uint8_t)(unsafe.Pointer(&pixels[0])),
 		C.int(width),
 		C.int(height),
-		&result,
+		buffer,
+		&cErr,
 	)
 
 	if !success {
-		err := C.MP_GetLastError(p.handle)
-		return nil, fmt.Errorf("mediapipe processing failed: %s", C.GoString(&err.message[0]))
+		return nil, fmt.Errorf("mediapipe processing failed: %s", C.GoString(&cErr.message[0]))
+	}
+
+	// Convert C result to Go TrackingData (the buffer owns the landmark memory)
+	return convertResult(&buffer.results), nil
+}
+
+// ProcessRaw processes a frame in any supported PixelFormat and returns
+// tracking data. stride is the number of bytes per row of the first plane
+// (0 for tightly packed rows) and is ignored for PixelMJPEG. With mirror set,
+// the frame is flipped horizontally during conversion.
+func (p *MediaPipeProcessor) ProcessRaw(pixels []byte, width, height, stride int, format PixelFormat, mirror bool) (*TrackingData, error) {
+	return p.processRaw(pixels, width, height, stride, format, mirror, -1)
+}
+
+// ProcessRawAt is ProcessRaw for a frame captured at captureTimestampUs
+// (microseconds, strictly increasing, e.g. the V4L2 buffer timestamp).
+// The capture time drives the graph's smoothing and tracking intervals and
+// is returned as TrackingData.TimestampUs, so latency can be measured from
+// exposure and dropped frames show up as gaps.
+func (p *MediaPipeProcessor) ProcessRawAt(pixels []byte, width, height, stride int, format PixelFormat, mirror bool, captureTimestampUs int64) (*TrackingData, error) {
+	if captureTimestampUs < 0 {
+		return nil, fmt.Errorf("negative capture timestamp")
 	}
+	return p.processRaw(pixels, width, height, stride, format, mirror, captureTimestampUs)
+}
 
-	// Convert C result to Go TrackingData
-	data := p.convertResult(&result)
+// processRaw implements ProcessRaw and ProcessRawAt; a negative
+// captureTimestampUs lets the bridge stamp the frame.
+func (p *MediaPipeProcessor) processRaw(pixels []byte, width, height, stride int, format PixelFormat, mirror bool, captureTimestampUs int64) (*TrackingData, error) {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
 
-	// Free C++ allocated memory
-	C.MP_ReleaseResults(&result)
+	if p.closed {
+		return nil, fmt.Errorf("processor is closed")
+	}
+
+	if len(pixels) == 0 {
+		return nil, fmt.Errorf("empty frame")
+	}
+
+	// The frame descriptor lives in Go memory, so the pixels it points to
+	// must be pinned for the duration of the call
+	var pinner runtime.Pinner
+	pinner.Pin(&pixels[0])
+	defer pinner.Unpin()
+
+	cFrame := C.MPFrame{
+		pixels:    (*C.uint8_t)(unsafe.Pointer(&pixels[0])),
+		width:     C.int(width),
+		height:    C.int(height),
+		stride:    C.int(stride),
+		format:    C.MPPixelFormat(format),
+		data_size: C.int(len(pixels)),
+	}
+	if mirror {
+		cFrame.flags = C.MP_FRAME_MIRROR
+	}
+
+	buffer, err := p.acquireBuffer()
+	if err != nil {
+		return nil, err
+	}
+	defer p.releaseBuffer(buffer)
+
+	var success C.bool
+	var cErr C.MPError
+	if captureTimestampUs < 0 {
+		success = C.MP_ProcessEx(p.handle, &cFrame, buffer, &cErr)
+	} else {
+		success = C.MP_ProcessAt(p.handle, &cFrame, C.int64_t(captureTimestampUs), buffer, &cErr)
+	}
+	if !success {
+		return nil, fmt.Errorf("mediapipe processing failed: %s", C.GoString(&cErr.message[0]))
+	}
+
+	return convertResult(&buffer.results), nil
+}
+
+// ProcessBatch processes a span of frames in a single bridge call and
+// returns their tracking data in order. Frames are pipelined through the
+// graph; create the processor with OfflineMode set (and a larger
+// InputPoolSize) for maximum throughput. On failure the data for the
+// frames processed before the failing one is returned with the error.
+// Batches share their C arrays, so concurrent batches run one at a time.
+func (p *MediaPipeProcessor) ProcessBatch(frames []RawFrame) ([]*TrackingData, error) {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	if p.closed {
+		return nil, fmt.Errorf("processor is closed")
+	}
+
+	if len(frames) == 0 {
+		return nil, nil
+	}
+
+	p.batchMu.Lock()
+	defer p.batchMu.Unlock()
+
+	if err := p.reserveBatch(len(frames)); err != nil {
+		return nil, err
+	}
+
+	var pinner runtime.Pinner
+	defer pinner.Unpin()
+
+	cFrames := unsafe.Slice(p.batchFrames, len(frames))
+	cTimestamps := unsafe.Slice(p.batchTimestamps, len(frames))
+	var timestamps *C.int64_t
+	for i, frame := range frames {
+		if len(frame.Pixels) == 0 {
+			return nil, fmt.Errorf("empty frame at index %d", i)
+		}
+		pinner.Pin(&frame.Pixels[0])
+		cFrames[i] = C.MPFrame{
+			pixels:    (*C.uint8_t)(unsafe.Pointer(&frame.Pixels[0])),
+			width:     C.int(frame.Width),
+			height:    C.int(frame.Height),
+			stride:    C.int(frame.Stride),
+			format:    C.MPPixelFormat(frame.Format),
+			data_size: C.int(len(frame.Pixels)),
+		}
+		if frame.Mirror {
+			cFrames[i].flags = C.MP_FRAME_MIRROR
+		}
+		cTimestamps[i] = C.int64_t(frame.CaptureTimestampUs)
+		if frame.CaptureTimestampUs != 0 {
+			timestamps = p.batchTimestamps
+		}
+	}
+
+	var cErr C.MPError
+	done := int(C.MP_ProcessBatch(p.handle, p.batchFrames, C.int(len(frames)), timestamps, p.batchResults, &cErr))
+
+	cResults := unsafe.Slice(p.batchResults, len(frames))
+	data := make([]*TrackingData, done)
+	for i := range data {
+		data[i] = convertResult(&cResults[i].results)
+	}
+
+	if done < len(frames) {
+		return data, fmt.Errorf("mediapipe batch stopped at frame %d: %s", done, C.GoString(&cErr.message[0]))
+	}
 
 	return data, nil
 }
 
+// reserveBatch makes the batch arrays hold at least n frames.
+func (p *MediaPipeProcessor) reserveBatch(n int) error {
+	if n <= p.batchCap {
+		return nil
+	}
+
+	p.freeBatch()
+	p.batchFrames = (*C.MPFrame)(C.calloc(C.size_t(n), C.size_t(unsafe.Sizeof(C.MPFrame{}))))
+	p.batchResults = (*C.MPResultsBuffer)(C.calloc(C.size_t(n), C.size_t(unsafe.Sizeof(C.MPResultsBuffer{}))))
+	p.batchTimestamps = (*C.int64_t)(C.calloc(C.size_t(n), C.size_t(unsafe.Sizeof(C.int64_t(0)))))
+	if p.batchFrames == nil || p.batchResults == nil || p.batchTimestamps == nil {
+		p.freeBatch()
+		return fmt.Errorf("cannot allocate batch buffers for %d frames", n)
+	}
+	p.batchCap = n
+	return nil
+}
+
+// freeBatch releases the batch arrays.
+func (p *MediaPipeProcessor) freeBatch() {
+	C.free(unsafe.Pointer(p.batchFrames))
+	C.free(unsafe.Pointer(p.batchResults))
+	C.free(unsafe.Pointer(p.batchTimestamps))
+	p.batchFrames = nil
+	p.batchResults = nil
+	p.batchTimestamps = nil
+	p.batchCap = 0
+}
+
+// Submit queues a frame for asynchronous processing and returns without
+// waiting for inference. The pixels are copied by the bridge, so the frame
+// may be reused or closed as soon as Submit returns. Results come back in
+// submission order from Poll, carrying the same tag.
+// The input frame must be in RGB format (gocv.MatTypeCV8UC3).
+func (p *MediaPipeProcessor) Submit(frame gocv.Mat, tag uint64) error {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	if p.closed {
+		return fmt.Errorf("processor is closed")
+	}
+
+	if frame.Empty() {
+		return fmt.Errorf("empty frame")
+	}
+
+	if frame.Type() != gocv.MatTypeCV8UC3 {
+		return fmt.Errorf("frame must be RGB (CV_8UC3), got type %d", frame.Type())
+	}
+
+	pixels, _ := frame.DataPtrUint8()
+
+	var cErr C.MPError
+	success := C.MP_SubmitFrame(
+		p.handle,
+		(*C.uint8_t)(unsafe.Pointer(&pixels[0])),
+		C.int(frame.Cols()),
+		C.int(frame.Rows()),
+		C.uint64_t(tag),
+		&cErr,
+	)
+
+	if !success {
+		return fmt.Errorf("mediapipe submit failed: %s", C.GoString(&cErr.message[0]))
+	}
+
+	return nil
+}
+
+// Poll waits up to timeout for the next frame queued with Submit to finish.
+// It returns the tracking data and the frame's tag, or ok=false if no frame
+// completed in time. A negative timeout waits indefinitely.
+func (p *MediaPipeProcessor) Poll(timeout time.Duration) (data *TrackingData, tag uint64, ok bool, err error) {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	if p.closed {
+		return nil, 0, false, fmt.Errorf("processor is closed")
+	}
+
+	buffer, err := p.acquireBuffer()
+	if err != nil {
+		return nil, 0, false, err
+	}
+	defer p.releaseBuffer(buffer)
+
+	timeoutMs := -1
+	if timeout >= 0 {
+		timeoutMs = int(timeout / time.Millisecond)
+	}
+
+	var cTag C.uint64_t
+	var cErr C.MPError
+	switch C.MP_PollResults(p.handle, buffer, &cTag, C.int(timeoutMs), &cErr) {
+	case 1:
+		return convertResult(&buffer.results), uint64(cTag), true, nil
+	case 0:
+		return nil, 0, false, nil
+	default:
+		return nil, 0, false, fmt.Errorf("mediapipe poll failed: %s", C.GoString(&cErr.message[0]))
+	}
+}
+
 // convertResult converts MediaPipe C++ results to Go TrackingData structure.
-func (p *MediaPipeProcessor) convertResult(result *C.MPResults) *TrackingData {
+func convertResult(result *C.MPResults) *TrackingData {
 	data := &TrackingData{
-		Timestamp: 0, // TODO: Get actual timestamp from MediaPipe
+		Timestamp:           int64(result.timestamp_ms),
+		TimestampUs:         int64(result.timestamp_us),
+		ModelComplexity:     int(result.model_complexity),
+		RefineFaceLandmarks: bool(result.refine_face_landmarks),
+		Predicted:           bool(result.predicted),
 	}
 
-	// Convert face landmarks (468 or 478 points with refinement)
-	if result.face_count > 0 {
-		data.Face = &FaceData{
-			Landmarks:    make([]Landmark, result.face_count),
-			BlendShapes:  make(map[string]float32),
-			HeadRotation: Quaternion{X: 0, Y: 0, Z: 0, W: 1}, // Identity, will be computed later
-			HeadPosition: Point3D{X: 0, Y: 0, Z: 0},          // Will be computed later
+	// Sets are read in MPResults order, which is also the order of the
+	// compact block
+	compact := newCompactReader(result)
+	landmarks := func(aos *C.MPLandmark, planes *C.MPLandmarkPlanes, count C.int) []Landmark {
+		if compact != nil {
+			return compact.read(int(count))
 		}
+		return convertLandmarks(aos, planes, int(count))
+	}
 
-		// Copy landmarks from C array
-		landmarks := (*[1 << 16]C.MPLandmark)(unsafe.Pointer(result.face_landmarks))[:result.face_count:result.face_count]
-		for i, lm := range landmarks {
-			data.Face.Landmarks[i] = Landmark{
-				Point: Point3D{
-					X: float64(lm.x),
-					Y: float64(lm.y),
-					Z: float64(lm.z),
-				},
-				Visibility: float32(lm.visibility),
-				Presence:   float32(lm.presence),
-			}
+	// Convert face landmarks (468 or 478 points with refinement), with the
+	// expression and head pose solved by the bridge. A projection may keep
+	// the face without any landmarks.
+	faceLandmarks := landmarks(result.face_landmarks, &result.face_planes, result.face_count)
+	if result.face_detected {
+		names := blendshapeNames()
+		blendShapes := make(map[string]float32, len(names))
+		for i, name := range names {
+			blendShapes[name] = float32(result.blendshapes[i])
+		}
+
+		data.Face = &FaceData{
+			Landmarks:   faceLandmarks,
+			BlendShapes: blendShapes,
+			HeadRotation: Quaternion{
+				X: float64(result.head_rotation[0]),
+				Y: float64(result.head_rotation[1]),
+				Z: float64(result.head_rotation[2]),
+				W: float64(result.head_rotation[3]),
+			},
+			HeadPosition: Point3D{
+				X: float64(result.head_translation[0]),
+				Y: float64(result.head_translation[1]),
+				Z: float64(result.head_translation[2]),
+			},
 		}
 	}
 
 	// Convert left hand landmarks (21 points)
 	if result.left_hand_count > 0 {
 		data.LeftHand = &HandData{
-			Landmarks: make([]Landmark, result.left_hand_count),
-		}
-
-		landmarks := (*[21]C.MPLandmark)(unsafe.Pointer(result.left_hand_landmarks))[:result.left_hand_count:result.left_hand_count]
-		for i, lm := range landmarks {
-			data.LeftHand.Landmarks[i] = Landmark{
-				Point: Point3D{
-					X: float64(lm.x),
-					Y: float64(lm.y),
-					Z: float64(lm.z),
-				},
-				Visibility: float32(lm.visibility),
-				Presence:   float32(lm.presence),
-			}
+			Landmarks: landmarks(result.left_hand_landmarks, &result.left_hand_planes, result.left_hand_count),
 		}
 	}
 
 	// Convert right hand landmarks (21 points)
 	if result.right_hand_count > 0 {
 		data.RightHand = &HandData{
-			Landmarks: make([]Landmark, result.right_hand_count),
-		}
-
-		landmarks := (*[21]C.MPLandmark)(unsafe.Pointer(result.right_hand_landmarks))[:result.right_hand_count:result.right_hand_count]
-		for i, lm := range landmarks {
-			data.RightHand.Landmarks[i] = Landmark{
-				Point: Point3D{
-					X: float64(lm.x),
-					Y: float64(lm.y),
-					Z: float64(lm.z),
-				},
-				Visibility: float32(lm.visibility),
-				Presence:   float32(lm.presence),
-			}
+			Landmarks: landmarks(result.right_hand_landmarks, &result.right_hand_planes, result.right_hand_count),
 		}
 	}
 
 	// Convert pose landmarks (33 points, but we focus on upper body 0-16)
 	if result.pose_count > 0 {
 		data.Pose = &PoseData{
-			Landmarks: make([]Landmark, result.pose_count),
+			Landmarks: landmarks(result.pose_landmarks, &result.pose_planes, result.pose_count),
 		}
+	}
+
+	return data
+}
+
+// compactReader decodes MPResults.compact_landmarks set by set.
+type compactReader struct {
+	data      unsafe.Pointer
+	stride    int
+	quantized bool // int16 values
+	scores    bool // visibility and presence included
+	offset    int
+}
+
+func newCompactReader(result *C.MPResults) *compactReader {
+	if result.compact_landmarks == nil {
+		return nil
+	}
+	r := &compactReader{data: result.compact_landmarks, stride: int(result.compact_stride)}
+	// The stride tells the format: 3 or 5 values of 2 or 4 bytes
+	switch r.stride {
+	case 6:
+		r.quantized = true
+	case 10:
+		r.quantized, r.scores = true, true
+	case 20:
+		r.scores = true
+	}
+	return r
+}
+
+// read decodes the next `count` landmarks.
+func (r *compactReader) read(count int) []Landmark {
+	out := make([]Landmark, count)
+	for i := range out {
+		base := unsafe.Add(r.data, r.offset+i*r.stride)
+		value := func(k int) float32 {
+			if r.quantized {
+				return float32(*(*int16)(unsafe.Add(base, 2*k))) / C.MP_INT16_SCALE
+			}
+			return *(*float32)(unsafe.Add(base, 4*k))
+		}
+
+		out[i] = Landmark{
+			Point:      Point3D{X: float64(value(0)), Y: float64(value(1)), Z: float64(value(2))},
+			Visibility: 1,
+			Presence:   1,
+		}
+		if r.scores {
+			out[i].Visibility = value(3)
+			out[i].Presence = value(4)
+		}
+	}
+	r.offset += count * r.stride
+	return out
+}
+
+var (
+	blendshapeNamesOnce sync.Once
+	blendshapeNameList  []string
+)
+
+// blendshapeNames returns the ARKit names of MPResults.blendshapes, in order.
+func blendshapeNames() []string {
+	blendshapeNamesOnce.Do(func() {
+		blendshapeNameList = make([]string, C.MP_NUM_BLENDSHAPES)
+		for i := range blendshapeNameList {
+			blendshapeNameList[i] = C.GoString(C.MP_GetBlendshapeName(C.int(i)))
+		}
+	})
+	return blendshapeNameList
+}
+
+// convertLandmarks copies one landmark set out of C memory, from the
+// MPLandmark array or, when it is nil (SoALandmarks), from the planes.
+func convertLandmarks(aos *C.MPLandmark, planes *C.MPLandmarkPlanes, count int) []Landmark {
+	out := make([]Landmark, count)
 
-		landmarks := (*[33]C.MPLandmark)(unsafe.Pointer(result.pose_landmarks))[:result.pose_count:result.pose_count]
-		for i, lm := range landmarks {
-			data.Pose.Landmarks[i] = Landmark{
+	if aos != nil {
+		for i, lm := range unsafe.Slice(aos, count) {
+			out[i] = Landmark{
 				Point: Point3D{
 					X: float64(lm.x),
 					Y: float64(lm.y),
@@ -225,9 +1083,134 @@ func (p *MediaPipeProcessor) convertResult(result *C.MPResults) *TrackingData {
 				Presence:   float32(lm.presence),
 			}
 		}
+		return out
 	}
 
-	return data
+	x := unsafe.Slice((*float32)(unsafe.Pointer(planes.x)), count)
+	y := unsafe.Slice((*float32)(unsafe.Pointer(planes.y)), count)
+	z := unsafe.Slice((*float32)(unsafe.Pointer(planes.z)), count)
+	visibility := unsafe.Slice((*float32)(unsafe.Pointer(planes.visibility)), count)
+	presence := unsafe.Slice((*float32)(unsafe.Pointer(planes.presence)), count)
+	for i := range out {
+		out[i] = Landmark{
+			Point:      Point3D{X: float64(x[i]), Y: float64(y[i]), Z: float64(z[i])},
+			Visibility: visibility[i],
+			Presence:   presence[i],
+		}
+	}
+	return out
+}
+
+// Stats is a snapshot of processor counters and timing.
+type Stats struct {
+	FramesSubmitted  uint64 // frames that entered the graph
+	FramesCompleted  uint64 // frames whose outputs have all settled
+	FramesDropped    uint64 // frames discarded by the flow limiter
+	FramesSuperseded uint64 // Realtime: replaced by a newer frame before processing
+	InputPoolMisses  uint64 // input frames allocated outside the pool
+	FramesCropped    uint64 // InputScaling: frames sent as a region-of-interest crop
+	TierSwitches     uint64 // Adaptive: pipeline changes
+	FramesInFlight   int    // submitted but not yet completed
+	ResultsQueued    int    // completed Submit frames awaiting Poll
+
+	// Pipeline new frames are sent to (see Config.Adaptive)
+	ModelComplexity     int
+	RefineFaceLandmarks bool
+
+	// Model files mapped in this process, one copy shared by every processor
+	MappedModels     int
+	MappedModelBytes uint64
+
+	// Models loaded for Config.Precision: as variants, or as float because
+	// the variant was missing
+	Precision      Precision
+	VariantModels  int
+	FallbackModels int
+
+	// RecordStart: frames written to the current recording, and dropped
+	// because the disk fell behind
+	FramesRecorded      uint64
+	FramesRecordDropped uint64
+
+	// MotionGating: frames answered without the graph
+	FramesPredicted uint64
+
+	// End-to-end latency over the most recent frames
+	LatencyP50 time.Duration
+	LatencyP95 time.Duration
+	LatencyP99 time.Duration
+
+	// Per-node timing, most total time first (requires EnableProfiling)
+	Calculators []CalculatorStats
+}
+
+// CalculatorStats is the timing of one graph node.
+type CalculatorStats struct {
+	Name        string
+	Invocations uint64
+	Mean        time.Duration
+	P50         time.Duration
+	P95         time.Duration
+	P99         time.Duration
+}
+
+// Stats returns the processor's current counters and timing.
+func (p *MediaPipeProcessor) Stats() (*Stats, error) {
+	p.mu.RLock()
+	defer p.mu.RUnlock()
+
+	if p.closed {
+		return nil, fmt.Errorf("processor is closed")
+	}
+
+	var cStats C.MPStats
+	if err := callLocked(func() bool { return bool(C.MP_GetStats(p.handle, &cStats)) }); err != nil {
+		return nil, fmt.Errorf("mediapipe stats failed: %s", C.GoString(&err.message[0]))
+	}
+
+	stats := &Stats{
+		FramesSubmitted:  uint64(cStats.frames_submitted),
+		FramesCompleted:  uint64(cStats.frames_completed),
+		FramesDropped:    uint64(cStats.frames_dropped),
+		FramesSuperseded: uint64(cStats.frames_superseded),
+		InputPoolMisses:  uint64(cStats.input_pool_misses),
+		FramesCropped:    uint64(cStats.frames_cropped),
+		TierSwitches:     uint64(cStats.tier_switches),
+		FramesInFlight:   int(cStats.frames_in_flight),
+		ResultsQueued:    int(cStats.results_queued),
+		LatencyP50:       msToDuration(cStats.latency_p50_ms),
+		LatencyP95:       msToDuration(cStats.latency_p95_ms),
+		LatencyP99:       msToDuration(cStats.latency_p99_ms),
+	}
+	stats.ModelComplexity = int(cStats.model_complexity)
+	stats.RefineFaceLandmarks = bool(cStats.refine_face_landmarks)
+	stats.MappedModels = int(cStats.mapped_models)
+	stats.MappedModelBytes = uint64(cStats.mapped_model_bytes)
+	stats.Precision = Precision(cStats.precision)
+	stats.VariantModels = int(cStats.variant_models)
+	stats.FallbackModels = int(cStats.fallback_models)
+	stats.FramesRecorded = uint64(cStats.frames_recorded)
+	stats.FramesRecordDropped = uint64(cStats.frames_record_dropped)
+	stats.FramesPredicted = uint64(cStats.frames_predicted)
+
+	for i := 0; i < int(cStats.calculator_count); i++ {
+		c := &cStats.calculators[i]
+		stats.Calculators = append(stats.Calculators, CalculatorStats{
+			Name:        C.GoString(&c.name[0]),
+			Invocations: uint64(c.invocations),
+			Mean:        msToDuration(c.mean_ms),
+			P50:         msToDuration(c.p50_ms),
+			P95:         msToDuration(c.p95_ms),
+			P99:         msToDuration(c.p99_ms),
+		})
+	}
+
+	return stats, nil
+}
+
+// msToDuration converts a bridge millisecond value to a time.Duration.
+func msToDuration(ms C.float) time.Duration {
+	return time.Duration(float64(ms) * float64(time.Millisecond))
 }
 
 // Close releases MediaPipe resources.
@@ -239,31 +1222,52 @@ func (p *MediaPipeProcessor) Close() error {
 		return nil
 	}
 
+	p.destroy()
+	p.closed = true
+	return nil
+}
+
+// destroy frees the C++ processor and result buffers.
+func (p *MediaPipeProcessor) destroy() {
 	if p.handle != nil {
 		C.MP_Destroy(p.handle)
 		p.handle = nil
 	}
 
-	p.closed = true
-	return nil
+	for idle := true; idle; {
+		select {
+		case buffer := <-p.buffers:
+			C.MP_DestroyResultsBuffer(buffer)
+		default:
+			idle = false
+		}
+	}
+
+	p.freeBatch()
 }
 
 // TrackingData represents the complete tracking output from MediaPipe.
 // This is defined here to avoid circular imports with the main miface package.
 type TrackingData struct {
-	Timestamp int64     // Frame timestamp in milliseconds
-	Face      *FaceData // Facial landmarks and expressions
-	LeftHand  *HandData // Left hand landmarks
-	RightHand *HandData // Right hand landmarks
-	Pose      *PoseData // Body pose landmarks
+	Timestamp   int64     // Frame timestamp in milliseconds
+	TimestampUs int64     // Frame timestamp in microseconds (capture time for ProcessRawAt)
+	Face        *FaceData // Facial landmarks and expressions
+	LeftHand    *HandData // Left hand landmarks
+	RightHand   *HandData // Right hand landmarks
+	Pose        *PoseData // Body pose landmarks
+	// Pipeline that produced this frame (see Config.Adaptive)
+	ModelComplexity     int
+	RefineFaceLandmarks bool
+	// Landmarks extrapolated without running the graph (see Config.MotionGating)
+	Predicted bool
 }
 
 // FaceData contains facial tracking information.
 type FaceData struct {
 	Landmarks    []Landmark         // 468 face mesh landmarks
-	BlendShapes  map[string]float32 // ARKit-style blend shapes (to be computed)
-	HeadRotation Quaternion         // Head orientation
-	HeadPosition Point3D            // Head position in world space
+	BlendShapes  map[string]float32 // ARKit blend shapes [0, 1], solved from the landmarks
+	HeadRotation Quaternion         // Head orientation in camera space
+	HeadPosition Point3D            // Head position in meters, camera space (z toward the viewer)
 }
 
 // HandData contains hand tracking information.
@@ -0,0 +1,104 @@
+package mediapipe
+
+/*
+#include "../../cpp_core/mediapipe_bridge.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"fmt"
+	"time"
+	"unsafe"
+)
+
+// Recording replays a file written by MediaPipeProcessor.RecordStart. The
+// file is memory-mapped and decoded frame by frame, so replay runs as fast
+// as the caller consumes it. A Recording is not safe for concurrent use.
+type Recording struct {
+	handle *C.MPRecording
+	buffer *C.MPResultsBuffer // Result storage reused by Next
+}
+
+// RecordingInfo summarizes a recording.
+type RecordingInfo struct {
+	Frames int64
+	Chunks int // seek granularity
+	First  time.Duration
+	Last   time.Duration
+	// Complete is false if the recorder never finished, e.g. because the
+	// process died; every whole chunk is still readable.
+	Complete bool
+}
+
+// OpenRecording maps the recording at path for replay.
+func OpenRecording(path string) (*Recording, error) {
+	cPath := C.CString(path)
+	defer C.free(unsafe.Pointer(cPath))
+
+	r := &Recording{}
+	if err := callLocked(func() bool {
+		r.handle = C.MP_RecordingOpen(cPath)
+		return r.handle != nil
+	}); err != nil {
+		return nil, fmt.Errorf("mediapipe recording open failed: %s", C.GoString(&err.message[0]))
+	}
+
+	r.buffer = C.MP_CreateResultsBuffer()
+	if r.buffer == nil {
+		C.MP_RecordingClose(r.handle)
+		return nil, fmt.Errorf("mediapipe recording open failed: cannot allocate results buffer")
+	}
+
+	return r, nil
+}
+
+// Info returns the recording's frame count, chunks and time span.
+func (r *Recording) Info() RecordingInfo {
+	var cInfo C.MPRecordingInfo
+	C.MP_RecordingGetInfo(r.handle, &cInfo)
+	return RecordingInfo{
+		Frames:   int64(cInfo.frame_count),
+		Chunks:   int(cInfo.chunk_count),
+		First:    time.Duration(cInfo.first_timestamp_us) * time.Microsecond,
+		Last:     time.Duration(cInfo.last_timestamp_us) * time.Microsecond,
+		Complete: bool(cInfo.complete),
+	}
+}
+
+// Next returns the next recorded frame, or ok=false at the end.
+func (r *Recording) Next() (data *TrackingData, ok bool, err error) {
+	var n C.int
+	if cErr := callLocked(func() bool {
+		n = C.MP_RecordingNext(r.handle, r.buffer)
+		return n >= 0
+	}); cErr != nil {
+		return nil, false, fmt.Errorf("mediapipe recording read failed: %s", C.GoString(&cErr.message[0]))
+	}
+	if n == 0 {
+		return nil, false, nil
+	}
+	return convertResult(&r.buffer.results), true, nil
+}
+
+// Seek makes Next continue from the first frame recorded at or after the
+// given graph timestamp (TrackingData.TimestampUs).
+func (r *Recording) Seek(timestampUs int64) error {
+	if err := callLocked(func() bool {
+		return bool(C.MP_RecordingSeek(r.handle, C.int64_t(timestampUs)))
+	}); err != nil {
+		return fmt.Errorf("mediapipe recording seek failed: %s", C.GoString(&err.message[0]))
+	}
+	return nil
+}
+
+// Close unmaps the recording.
+func (r *Recording) Close() error {
+	if r.handle == nil {
+		return nil
+	}
+	C.MP_RecordingClose(r.handle)
+	r.handle = nil
+	C.MP_DestroyResultsBuffer(r.buffer)
+	r.buffer = nil
+	return nil
+}